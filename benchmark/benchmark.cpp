@@ -183,6 +183,18 @@ void run_benchmark() {
         benchmark_container(pvec).print("PackedFixedWidthIntVector", bits);
     }
 
+    if constexpr(64 % bits != 0)
+    {
+        word_packing::PackedIntVector<uint64_t, word_packing::bit_order::Padded> pvec(N, bits);
+        benchmark_container(pvec).print("PackedIntVector<Padded>", bits);
+    }
+
+    if constexpr(64 % bits != 0)
+    {
+        word_packing::PackedFixedWidthIntVector<bits, uint64_t, word_packing::bit_order::Padded> pvec(N);
+        benchmark_container(pvec).print("PackedFixedWidthIntVector<Padded>", bits);
+    }
+
     if constexpr(bits == 1)
     {
         std::vector<bool> bv(N);
@@ -28,7 +28,9 @@
 #ifndef _WORD_PACKING_HPP
 #define _WORD_PACKING_HPP
 
+#include "word_packing/bit_order.hpp"
 #include "word_packing/internal/impl.hpp"
+#include "word_packing/stats.hpp"
 
 #include "word_packing/internal/packed_int_accessor.hpp"
 #include "word_packing/internal/packed_fixed_width_int_accessor.hpp"
@@ -43,52 +45,60 @@ namespace word_packing {
  * 
  * Use this if the width is only known at runtime.
  * 
+ * \tparam BitOrder the order in which words are packed (\see word_packing::bit_order)
+ * \tparam Stats the instrumentation policy (\see word_packing::stats)
  * \tparam Pack the word pack type
  * \param data the word pack buffer to access
  * \param width the bit width per packed word
  * \return the accessor
  */
-template<WordPackEligible Pack>
-inline auto accessor(Pack const* data, size_t const width) { return internal::PackedIntConstAccessor<Pack>(data, width); }
+template<typename BitOrder = bit_order::LsbFirst, typename Stats = stats::None, WordPackEligible Pack>
+inline auto accessor(Pack const* data, size_t const width) { return internal::PackedIntConstAccessor<Pack, BitOrder, Stats>(data, width); }
 
 /**
  * \brief Provides an accessor to packed words of the given bit width contained in the given pack buffer
  * 
  * Use this if the width is only known at runtime.
  * 
+ * \tparam BitOrder the order in which words are packed (\see word_packing::bit_order)
+ * \tparam Stats the instrumentation policy (\see word_packing::stats)
  * \tparam Pack the word pack type
  * \param data the word pack buffer to access
  * \param width the bit width per packed word
  * \return the accessor
  */
-template<WordPackEligible Pack>
-inline auto accessor(Pack* data, size_t const width) { return internal::PackedIntAccessor<Pack>(data, width); }
+template<typename BitOrder = bit_order::LsbFirst, typename Stats = stats::None, WordPackEligible Pack>
+inline auto accessor(Pack* data, size_t const width) { return internal::PackedIntAccessor<Pack, BitOrder, Stats>(data, width); }
 
 /**
  * \brief Provides a read-only accessor to packed words of the given bit width contained in the given pack buffer
  * 
  * Use this if the width is already known at compile time.
  * 
- * \tparam Pack the word pack type
  * \tparam width the bit width per packed word
+ * \tparam BitOrder the order in which words are packed (\see word_packing::bit_order)
+ * \tparam Stats the instrumentation policy (\see word_packing::stats)
+ * \tparam Pack the word pack type
  * \param data the word pack buffer to access
  * \return the accessor
  */
-template<size_t width, WordPackEligible Pack>
-inline auto accessor(Pack const* data) { return internal::PackedFixedWidthIntConstAccessor<width, Pack>(data); }
+template<size_t width, typename BitOrder = bit_order::LsbFirst, typename Stats = stats::None, WordPackEligible Pack>
+inline auto accessor(Pack const* data) { return internal::PackedFixedWidthIntConstAccessor<width, Pack, BitOrder, Stats>(data); }
 
 /**
  * \brief Provides an accessor to packed words of the given bit width contained in the given pack buffer
  * 
  * Use this if the width is already known at compile time.
  * 
- * \tparam Pack the word pack type
  * \tparam width the bit width per packed word
+ * \tparam BitOrder the order in which words are packed (\see word_packing::bit_order)
+ * \tparam Stats the instrumentation policy (\see word_packing::stats)
+ * \tparam Pack the word pack type
  * \param data the word pack buffer to access
  * \return the accessor
  */
-template<size_t width, WordPackEligible Pack>
-inline auto accessor(Pack* data) { return internal::PackedFixedWidthIntAccessor<width, Pack>(data); }
+template<size_t width, typename BitOrder = bit_order::LsbFirst, typename Stats = stats::None, WordPackEligible Pack>
+inline auto accessor(Pack* data) { return internal::PackedFixedWidthIntAccessor<width, Pack, BitOrder, Stats>(data); }
 
 /**
  * \brief Allocates the required memory for an array of packed words of the given bit width and returns an accessor to it
@@ -0,0 +1,479 @@
+/**
+ * word_packing/adaptive_packed_vector.hpp
+ * part of pdinklag/word-packing
+ * 
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _WORD_PACKING_ADAPTIVE_PACKED_VECTOR_HPP
+#define _WORD_PACKING_ADAPTIVE_PACKED_VECTOR_HPP
+
+#include "encoding_advisor.hpp"
+#include "internal/alloc.hpp"
+#include "internal/int_ref.hpp"
+#include "internal/parallel.hpp"
+#include "packed_int_vector.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace word_packing {
+
+/**
+ * \brief Vector of integers that picks the most compact encoding for each chunk
+ *
+ * The integers are divided into chunks of a fixed number of integers, which are encoded independently of each other.
+ * Each chunk is analyzed using \ref analyze and encoded using whichever of the following encodings the estimates of the \ref DataAnalysis
+ * deem to take the fewest bits:
+ * - \ref Encoding::PLAIN : the integers are packed at the width of the largest integer,
+ * - \ref Encoding::FOR : each block of \ref DataAnalysis::BLOCK_SIZE integers is packed relative to its smallest integer at the width of its range,
+ * - \ref Encoding::DICTIONARY : the distinct integers are stored in a sorted dictionary, the integers are replaced by their rank in it,
+ * - \ref Encoding::RLE : the value and the end position of each run of equal integers are packed.
+ *
+ * A chunk that consists of a single run is always run-length encoded.
+ * A directory holds the encoding and packed arrays of each chunk.
+ * Random access costs a directory lookup and one or two packed reads, or a binary search over the runs of a run-length encoded chunk.
+ * Chunks are decoded as a whole word pack by word pack.
+ *
+ * Writes are performed in place if the encoding of the chunk allows it, e.g., if the written integer fits into the frame of reference of its block.
+ * Otherwise, the chunk is decoded into plain packing and marked as dirty.
+ * Dirty chunks are re-encoded only when \ref optimize is called, so that a series of writes to the same chunk costs a single re-encoding.
+ *
+ * \tparam Pack the unsigned integer type to pack words into, which must fit all contained integers
+ * \tparam chunk_size_ the number of integers per chunk, which must be a power of two
+ */
+template<WordPackEligible Pack = uintmax_t, size_t chunk_size_ = 65536>
+class AdaptivePackedVector {
+private:
+    static_assert(std::has_single_bit(chunk_size_), "the chunk size must be a power of two");
+
+    static constexpr size_t PACK_BITS = std::numeric_limits<Pack>::digits;
+    static constexpr size_t BLOCK_SIZE = DataAnalysis::BLOCK_SIZE;
+
+    static size_t min_width(uintmax_t const x) { return std::max(size_t(std::bit_width(x)), size_t(1)); }
+
+    struct Chunk {
+        Encoding encoding = Encoding::PLAIN;
+        bool dirty = false;
+        size_t size = 0;
+        PackedIntVector<Pack> data;         // the integers, the FOR payload bits, the dictionary ranks or the run values
+        PackedIntVector<uintmax_t> aux;     // the FOR frames of reference, the dictionary or the run end positions
+        PackedIntVector<uintmax_t> offsets; // the positions of the first payload bit of each FOR block
+
+        // nb: the directory arrays aux and offsets hold positions that may be wider than the word packs, so they use full words
+
+        // the width of the payload of a FOR block
+        size_t block_width(size_t const b) const {
+            size_t const len = std::min(BLOCK_SIZE, size - b * BLOCK_SIZE);
+            return (offsets.get(b + 1) - offsets.get(b)) / len;
+        }
+
+        // the run that contains the given position
+        size_t find_run(size_t const j) const {
+            // binary search for the first run ending after j
+            size_t lo = 0, hi = aux.size() - 1;
+            while(lo < hi) {
+                size_t const m = (lo + hi) / 2;
+                if(aux.get(m) > j) hi = m; else lo = m + 1;
+            }
+            return lo;
+        }
+
+        uintmax_t get(size_t const j) const {
+            switch(encoding) {
+                case Encoding::PLAIN: return data.get(j);
+                case Encoding::FOR: {
+                    size_t const b = j / BLOCK_SIZE;
+                    size_t const w = block_width(b);
+                    return aux.get(b) + (w ? internal::get_bits(data.data(), offsets.get(b) + (j % BLOCK_SIZE) * w, w) : 0);
+                }
+                case Encoding::DICTIONARY: return aux.get(data.get(j));
+                case Encoding::RLE: return data.get(find_run(j));
+                default: return 0;
+            }
+        }
+
+        // writes an integer in place if the encoding allows it and reports whether it did
+        bool try_set(size_t const j, uintmax_t const x) {
+            switch(encoding) {
+                case Encoding::PLAIN:
+                    if(x > internal::low_mask(data.width())) return false;
+                    data.set(j, x);
+                    return true;
+                case Encoding::FOR: {
+                    size_t const b = j / BLOCK_SIZE;
+                    size_t const w = block_width(b);
+                    uintmax_t const base = aux.get(b);
+                    if(x < base || (w == 0 ? x != base : x - base > internal::low_mask(w))) return false;
+                    if(w) internal::set_bits(data.data(), offsets.get(b) + (j % BLOCK_SIZE) * w, w, x - base);
+                    return true;
+                }
+                case Encoding::DICTIONARY: {
+                    size_t lo = 0, hi = aux.size();
+                    while(lo < hi) {
+                        size_t const m = (lo + hi) / 2;
+                        if(aux.get(m) < x) lo = m + 1; else hi = m;
+                    }
+                    if(lo == aux.size() || aux.get(lo) != x) return false;
+                    data.set(j, lo);
+                    return true;
+                }
+                case Encoding::RLE:
+                    return data.get(find_run(j)) == x;
+                default:
+                    return false;
+            }
+        }
+
+        // decodes all integers, unpacking the packed arrays word pack by word pack
+        void decode(uintmax_t* out) const {
+            switch(encoding) {
+                case Encoding::PLAIN:
+                    data.unpack(0, size, out);
+                    break;
+                case Encoding::FOR:
+                    for(size_t b = 0; b < aux.size(); b++) {
+                        size_t const len = std::min(BLOCK_SIZE, size - b * BLOCK_SIZE);
+                        size_t const w = block_width(b);
+                        uintmax_t const base = aux.get(b);
+                        uintmax_t* const block = out + b * BLOCK_SIZE;
+                        if(w) {
+                            internal::unpack_bits(data.data(), offsets.get(b), len, w, block);
+                            for(size_t k = 0; k < len; k++) block[k] += base;
+                        } else {
+                            std::fill(block, block + len, base);
+                        }
+                    }
+                    break;
+                case Encoding::DICTIONARY: {
+                    std::vector<uintmax_t> dict(aux.size());
+                    aux.unpack(0, aux.size(), dict.data());
+                    data.unpack(0, size, out);
+                    for(size_t j = 0; j < size; j++) out[j] = dict[out[j]];
+                    break;
+                }
+                case Encoding::RLE: {
+                    std::vector<uintmax_t> values(data.size()), ends(aux.size());
+                    data.unpack(0, data.size(), values.data());
+                    aux.unpack(0, aux.size(), ends.data());
+                    size_t j = 0;
+                    for(size_t r = 0; r < ends.size(); r++) {
+                        std::fill(out + j, out + ends[r], values[r]);
+                        j = ends[r];
+                    }
+                    break;
+                }
+                default:
+                    break;
+            }
+        }
+
+        size_t memory_usage() const { return data.memory_usage() + aux.memory_usage() + offsets.memory_usage(); }
+    };
+
+    // encodes the given integers using the encoding estimated to take the fewest bits
+    static Chunk encode(uintmax_t const* values, size_t const n) {
+        Chunk c;
+        c.size = n;
+        if(n == 0) return c;
+
+        DataAnalysis const a = analyze(std::span<uintmax_t const>(values, n));
+        c.encoding = (a.runs == 1) ? Encoding::RLE : a.best_of({ Encoding::FOR, Encoding::DICTIONARY, Encoding::RLE }).encoding;
+
+        size_t const w = min_width(a.max);
+        switch(c.encoding) {
+            case Encoding::PLAIN:
+                c.data = PackedIntVector<Pack>(n, w);
+                for(size_t j = 0; j < n; j++) c.data.set(j, values[j]);
+                break;
+            case Encoding::FOR: {
+                size_t const num_blocks = internal::idiv_ceil(n, BLOCK_SIZE);
+                std::vector<uintmax_t> bases(num_blocks), bits(num_blocks + 1, 0);
+                for(size_t b = 0; b < num_blocks; b++) {
+                    size_t const begin = b * BLOCK_SIZE, end = std::min(n, begin + BLOCK_SIZE);
+                    auto const [lo, hi] = std::minmax_element(values + begin, values + end);
+                    bases[b] = *lo;
+                    bits[b + 1] = bits[b] + std::bit_width(*hi - *lo) * (end - begin);
+                }
+
+                c.aux = PackedIntVector<uintmax_t>(num_blocks, w);
+                c.offsets = PackedIntVector<uintmax_t>(num_blocks + 1, min_width(bits[num_blocks]));
+                c.data = PackedIntVector<Pack>(bits[num_blocks], 1);
+                std::fill(c.data.data(), c.data.data() + num_packs_required<Pack>(bits[num_blocks], 1), Pack(0));
+                for(size_t b = 0; b <= num_blocks; b++) c.offsets.set(b, bits[b]);
+                for(size_t b = 0; b < num_blocks; b++) {
+                    c.aux.set(b, bases[b]);
+                    size_t const bw = c.block_width(b);
+                    if(bw == 0) continue;
+                    for(size_t j = b * BLOCK_SIZE; j < std::min(n, (b + 1) * BLOCK_SIZE); j++) {
+                        internal::set_bits(c.data.data(), bits[b] + (j % BLOCK_SIZE) * bw, bw, values[j] - bases[b]);
+                    }
+                }
+                break;
+            }
+            case Encoding::DICTIONARY: {
+                std::vector<uintmax_t> dict(values, values + n);
+                std::sort(dict.begin(), dict.end());
+                dict.erase(std::unique(dict.begin(), dict.end()), dict.end());
+
+                c.aux = PackedIntVector<uintmax_t>(dict.size(), w);
+                for(size_t k = 0; k < dict.size(); k++) c.aux.set(k, dict[k]);
+                c.data = PackedIntVector<Pack>(n, min_width(dict.size() - 1));
+                for(size_t j = 0; j < n; j++) c.data.set(j, std::lower_bound(dict.begin(), dict.end(), values[j]) - dict.begin());
+                break;
+            }
+            case Encoding::RLE: {
+                c.data = PackedIntVector<Pack>(a.runs, w);
+                c.aux = PackedIntVector<uintmax_t>(a.runs, min_width(n));
+                size_t r = 0;
+                for(size_t j = 1; j <= n; j++) {
+                    if(j == n || values[j] != values[j - 1]) {
+                        c.data.set(r, values[j - 1]);
+                        c.aux.set(r, j);
+                        ++r;
+                    }
+                }
+                break;
+            }
+            default:
+                break;
+        }
+        return c;
+    }
+
+    // decodes a chunk into plain packing that fits at least the given width and marks it dirty
+    static void make_plain(Chunk& c, size_t const width) {
+        std::vector<uintmax_t> values(c.size);
+        c.decode(values.data());
+
+        uintmax_t const max = c.size ? *std::max_element(values.begin(), values.end()) : 0;
+        c.data = PackedIntVector<Pack>(c.size, std::max(min_width(max), width));
+        for(size_t j = 0; j < c.size; j++) c.data.set(j, values[j]);
+        c.aux = PackedIntVector<uintmax_t>();
+        c.offsets = PackedIntVector<uintmax_t>();
+        c.encoding = Encoding::PLAIN;
+        c.dirty = true;
+    }
+
+    size_t size_;
+    std::vector<Chunk> chunks_;
+
+public:
+    /**
+     * \brief The number of integers per chunk
+     */
+    static constexpr size_t CHUNK_SIZE = chunk_size_;
+
+    /**
+     * \brief Constructs an empty vector
+     *
+     */
+    AdaptivePackedVector() : size_(0) {
+    }
+
+    /**
+     * \brief Constructs a vector containing the integers of the given sequence
+     *
+     * \tparam Sequence the sequence type, which must provide random access to integers via \c operator[] and report its \c size()
+     * \param seq the sequence of integers
+     * \param num_threads the number of threads to use for encoding chunks
+     */
+    template<typename Sequence>
+    AdaptivePackedVector(Sequence const& seq, size_t const num_threads = 1) : size_(seq.size()) {
+        chunks_.resize(internal::idiv_ceil(size_, CHUNK_SIZE));
+        internal::parallel_for(num_threads, chunks_.size(), [&](size_t const c){
+            size_t const begin = c * CHUNK_SIZE;
+            size_t const n = std::min(CHUNK_SIZE, size_ - begin);
+            std::vector<uintmax_t> values(n);
+            for(size_t j = 0; j < n; j++) {
+                values[j] = seq[begin + j];
+                assert(values[j] <= internal::low_mask(PACK_BITS));
+            }
+            chunks_[c] = encode(values.data(), n);
+        });
+    }
+
+    /**
+     * \brief Retrieves a specific integer
+     *
+     * \param i the index of the integer
+     * \return the integer at the given index
+     */
+    uintmax_t get(size_t const i) const {
+        assert(i < size_);
+        return chunks_[i / CHUNK_SIZE].get(i % CHUNK_SIZE);
+    }
+
+    /**
+     * \brief Writes a specific integer
+     *
+     * If the encoding of the affected chunk cannot represent the integer in place, the chunk is decoded into plain packing
+     * and marked as dirty until the next call to \ref optimize .
+     *
+     * \param i the index of the integer
+     * \param x the value to write
+     */
+    void set(size_t const i, uintmax_t const x) {
+        assert(i < size_);
+        assert(x <= internal::low_mask(PACK_BITS));
+
+        auto& c = chunks_[i / CHUNK_SIZE];
+        size_t const j = i % CHUNK_SIZE;
+        if(!c.try_set(j, x)) {
+            make_plain(c, min_width(x));
+            c.data.set(j, x);
+        }
+    }
+
+    /**
+     * \brief Retrieves a specific integer
+     *
+     * This function simply forwards to \ref get .
+     *
+     * \param i the index of the integer
+     * \return the integer at the given index
+     */
+    uintmax_t operator[](size_t const i) const { return get(i); }
+
+    /**
+     * \brief Provides read/write access to a specific integer
+     *
+     * \param i the index of the integer
+     * \return a proxy allowing reading and writing
+     */
+    auto operator[](size_t const i) { return internal::IntRef<AdaptivePackedVector>(*this, i); }
+
+    /**
+     * \brief Appends an integer
+     *
+     * The last chunk is decoded into plain packing and marked as dirty, unless a new chunk is started.
+     *
+     * \param x the integer to append
+     */
+    void push_back(uintmax_t const x) {
+        assert(x <= internal::low_mask(PACK_BITS));
+        if(size_ % CHUNK_SIZE == 0) chunks_.emplace_back();
+
+        auto& c = chunks_.back();
+        if(c.encoding != Encoding::PLAIN || c.data.width() == 0 || x > internal::low_mask(c.data.width())) {
+            make_plain(c, min_width(x));
+        }
+        c.data.push_back(x);
+        c.dirty = true;
+        ++c.size;
+        ++size_;
+    }
+
+    /**
+     * \brief Decodes all integers of a chunk at once
+     *
+     * The packed arrays of the chunk are unpacked word pack by word pack.
+     *
+     * \param c the number of the chunk
+     * \param out the output array, which must have room for the integers of the chunk (\see chunk_size)
+     * \return the number of integers decoded
+     */
+    size_t decode_chunk(size_t const c, uintmax_t* out) const {
+        chunks_[c].decode(out);
+        return chunks_[c].size;
+    }
+
+    /**
+     * \brief Re-encodes all dirty chunks using the encoding estimated to take the fewest bits
+     *
+     * \param num_threads the number of threads to use for encoding chunks
+     */
+    void optimize(size_t const num_threads = 1) {
+        internal::parallel_for(num_threads, chunks_.size(), [&](size_t const c){
+            if(!chunks_[c].dirty) return;
+
+            std::vector<uintmax_t> values(chunks_[c].size);
+            chunks_[c].decode(values.data());
+            chunks_[c] = encode(values.data(), values.size());
+        });
+    }
+
+    /**
+     * \brief Reports the number of integers in the vector
+     *
+     * \return the number of integers in the vector
+     */
+    size_t size() const { return size_; }
+
+    /**
+     * \brief Tests whether the vector is empty
+     *
+     * \return true if the size equals zero
+     * \return false otherwise
+     */
+    bool empty() const { return size_ == 0; }
+
+    /**
+     * \brief Reports the number of chunks
+     *
+     * \return the number of chunks
+     */
+    size_t num_chunks() const { return chunks_.size(); }
+
+    /**
+     * \brief Reports the number of integers in a chunk
+     *
+     * \param c the number of the chunk
+     * \return the number of integers in the chunk, which equals \ref CHUNK_SIZE for all but the last chunk
+     */
+    size_t chunk_size(size_t const c) const { return chunks_[c].size; }
+
+    /**
+     * \brief Reports the encoding of a chunk
+     *
+     * \param c the number of the chunk
+     * \return the encoding of the chunk
+     */
+    Encoding chunk_encoding(size_t const c) const { return chunks_[c].encoding; }
+
+    /**
+     * \brief Tests whether a chunk was decoded into plain packing by writes since the last call to \ref optimize
+     *
+     * \param c the number of the chunk
+     * \return true if the chunk is dirty
+     * \return false otherwise
+     */
+    bool chunk_dirty(size_t const c) const { return chunks_[c].dirty; }
+
+    /**
+     * \brief Reports the number of heap bytes used by the vector
+     *
+     * \return the number of heap bytes used, including the chunk directory
+     */
+    size_t memory_usage() const { return internal::memory_usage(chunks_); }
+};
+
+}
+
+#endif
@@ -0,0 +1,469 @@
+/**
+ * word_packing/bit_expressions.hpp
+ * part of pdinklag/word-packing
+ * 
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _WORD_PACKING_BIT_EXPRESSIONS_HPP
+#define _WORD_PACKING_BIT_EXPRESSIONS_HPP
+
+#include "internal/cpu.hpp"
+#include "packed_fixed_width_int_vector.hpp"
+
+#include <bit>
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+namespace word_packing {
+
+namespace internal {
+    // base of all bit expression types
+    struct BitExpressionBase {};
+
+    template<typename T>
+    struct is_bit_vector : std::false_type {};
+
+    template<WordPackEligible Pack, typename BitOrder, typename Stats>
+    struct is_bit_vector<PackedFixedWidthIntVector<1, Pack, BitOrder, Stats>> : std::true_type {};
+
+    // types that may appear in bit expressions
+    template<typename T>
+    concept BitExpressionOperand = std::derived_from<T, BitExpressionBase> || is_bit_vector<T>::value;
+
+    struct BitAnd { template<typename Pack> static Pack apply(Pack const a, Pack const b) { return a & b; } };
+    struct BitOr  { template<typename Pack> static Pack apply(Pack const a, Pack const b) { return a | b; } };
+    struct BitXor { template<typename Pack> static Pack apply(Pack const a, Pack const b) { return a ^ b; } };
+}
+
+/**
+ * \brief A bit vector or buffer of packed bits as a leaf of a bit expression
+ *
+ * The bits are referenced, not copied.
+ *
+ * \tparam Pack the word pack type
+ * \tparam BitOrder the bit order (\see word_packing::bit_order)
+ */
+template<WordPackEligible Pack, typename BitOrder = bit_order::LsbFirst>
+class BitOperand : public internal::BitExpressionBase {
+private:
+    Pack const* data_;
+    size_t size_;
+
+public:
+    using PackType = Pack;
+    using BitOrderType = BitOrder;
+
+    /**
+     * \brief References the given buffer of packed bits
+     *
+     * \param data the buffer of packed bits
+     * \param size the number of bits
+     */
+    BitOperand(Pack const* data, size_t const size) : data_(data), size_(size) {
+    }
+
+    /**
+     * \brief References the bits of the given bit vector
+     *
+     * \param bv the bit vector
+     */
+    template<typename Stats>
+    BitOperand(PackedFixedWidthIntVector<1, Pack, BitOrder, Stats> const& bv) : BitOperand(bv.data(), bv.size()) {
+    }
+
+    [[gnu::always_inline]] Pack word(size_t const p) const { return data_[p]; }
+    size_t size() const { return size_; }
+};
+
+/**
+ * \brief A lazily evaluated binary operation on two bit expressions
+ *
+ * \tparam Op the operation
+ * \tparam L the left operand expression
+ * \tparam R the right operand expression
+ */
+template<typename Op, typename L, typename R>
+class BitBinaryExpression : public internal::BitExpressionBase {
+private:
+    static_assert(std::is_same_v<typename L::PackType, typename R::PackType>, "the operands must use the same word pack type");
+    static_assert(std::is_same_v<typename L::BitOrderType, typename R::BitOrderType>, "the operands must use the same bit order");
+
+    L l_;
+    R r_;
+
+public:
+    using PackType = typename L::PackType;
+    using BitOrderType = typename L::BitOrderType;
+
+    BitBinaryExpression(L const& l, R const& r) : l_(l), r_(r) {
+        assert(l_.size() == r_.size());
+    }
+
+    [[gnu::always_inline]] PackType word(size_t const p) const { return Op::apply(l_.word(p), r_.word(p)); }
+    size_t size() const { return l_.size(); }
+};
+
+/**
+ * \brief A lazily evaluated negation of a bit expression
+ *
+ * \tparam E the negated expression
+ */
+template<typename E>
+class BitNotExpression : public internal::BitExpressionBase {
+private:
+    E e_;
+
+public:
+    using PackType = typename E::PackType;
+    using BitOrderType = typename E::BitOrderType;
+
+    BitNotExpression(E const& e) : e_(e) {
+    }
+
+    [[gnu::always_inline]] PackType word(size_t const p) const { return PackType(~e_.word(p)); }
+    size_t size() const { return e_.size(); }
+};
+
+namespace internal {
+    template<typename T>
+    auto as_bit_expression(T const& x) {
+        if constexpr(is_bit_vector<T>::value) return BitOperand<pack_of<T>, typename T::BitOrderType>(x.data(), x.size());
+        else return x;
+    }
+
+    template<typename T>
+    using bit_expression_of = decltype(as_bit_expression(std::declval<T const&>()));
+
+    // the mask selecting the valid bits of the last word pack of an expression
+    template<typename E>
+    typename E::PackType tail_mask(E const& e) {
+        using Pack = typename E::PackType;
+        size_t const tail = e.size() % std::numeric_limits<Pack>::digits;
+        return tail ? E::BitOrderType::template range_mask<Pack>(0, tail) : Pack(~Pack(0));
+    }
+}
+
+/**
+ * \brief Builds the lazily evaluated bitwise AND of two bit vectors or expressions
+ */
+template<internal::BitExpressionOperand L, internal::BitExpressionOperand R>
+auto operator&(L const& l, R const& r) {
+    return BitBinaryExpression<internal::BitAnd, internal::bit_expression_of<L>, internal::bit_expression_of<R>>(internal::as_bit_expression(l), internal::as_bit_expression(r));
+}
+
+/**
+ * \brief Builds the lazily evaluated bitwise OR of two bit vectors or expressions
+ */
+template<internal::BitExpressionOperand L, internal::BitExpressionOperand R>
+auto operator|(L const& l, R const& r) {
+    return BitBinaryExpression<internal::BitOr, internal::bit_expression_of<L>, internal::bit_expression_of<R>>(internal::as_bit_expression(l), internal::as_bit_expression(r));
+}
+
+/**
+ * \brief Builds the lazily evaluated bitwise XOR of two bit vectors or expressions
+ */
+template<internal::BitExpressionOperand L, internal::BitExpressionOperand R>
+auto operator^(L const& l, R const& r) {
+    return BitBinaryExpression<internal::BitXor, internal::bit_expression_of<L>, internal::bit_expression_of<R>>(internal::as_bit_expression(l), internal::as_bit_expression(r));
+}
+
+/**
+ * \brief Builds the lazily evaluated negation of a bit vector or expression
+ */
+template<internal::BitExpressionOperand E>
+auto operator~(E const& e) {
+    return BitNotExpression<internal::bit_expression_of<E>>(internal::as_bit_expression(e));
+}
+
+namespace internal {
+    // the number of bytes of an expression's result that are buffered and examined at once
+    constexpr size_t BIT_EXPRESSION_BLOCK = 256;
+
+    // examination of buffered blocks without instruction set extensions
+    struct BitBlockPortable {
+        // counts the set bits in the block starting at the given position
+        static size_t count_ones(uint8_t const* block) {
+            size_t ones = 0;
+            for(size_t k = 0; k < BIT_EXPRESSION_BLOCK; k += 8) {
+                uint64_t x;
+                std::memcpy(&x, block + k, 8);
+                ones += std::popcount(x);
+            }
+            return ones;
+        }
+
+        // tests whether all bits in the block starting at the given position are unset
+        static bool none(uint8_t const* block) {
+            uint64_t any = 0;
+            for(size_t k = 0; k < BIT_EXPRESSION_BLOCK; k += 8) {
+                uint64_t x;
+                std::memcpy(&x, block + k, 8);
+                any |= x;
+            }
+            return any == 0;
+        }
+    };
+
+#ifdef WORD_PACKING_X86_DISPATCH
+    // counts the set bits of each nibble using a shuffle as a lookup table (as described by Mula et al.)
+    struct BitBlockAvx2 {
+        [[gnu::target("avx2")]] static size_t count_ones(uint8_t const* block) {
+            __m256i const lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+            __m256i const low = _mm256_set1_epi8(0x0F);
+            __m256i sum = _mm256_setzero_si256();
+            for(size_t k = 0; k < BIT_EXPRESSION_BLOCK; k += 32) {
+                __m256i const v = _mm256_loadu_si256((__m256i const*)(block + k));
+                __m256i const c = _mm256_add_epi8(
+                    _mm256_shuffle_epi8(lookup, _mm256_and_si256(v, low)),
+                    _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(v, 4), low)));
+                sum = _mm256_add_epi64(sum, _mm256_sad_epu8(c, _mm256_setzero_si256()));
+            }
+            return _mm256_extract_epi64(sum, 0) + _mm256_extract_epi64(sum, 1) + _mm256_extract_epi64(sum, 2) + _mm256_extract_epi64(sum, 3);
+        }
+
+        [[gnu::target("avx2")]] static bool none(uint8_t const* block) {
+            __m256i any = _mm256_setzero_si256();
+            for(size_t k = 0; k < BIT_EXPRESSION_BLOCK; k += 32) any = _mm256_or_si256(any, _mm256_loadu_si256((__m256i const*)(block + k)));
+            return _mm256_testz_si256(any, any);
+        }
+    };
+
+    // as above, using 512-bit vectors
+    struct BitBlockAvx512 {
+        [[gnu::target("avx512bw")]] static size_t count_ones(uint8_t const* block) {
+            __m512i const lookup = _mm512_set4_epi64(0x0403030203020201LL, 0x0302020102010100LL, 0x0403030203020201LL, 0x0302020102010100LL);
+            __m512i const low = _mm512_set1_epi8(0x0F);
+            __m512i sum = _mm512_setzero_si512();
+            for(size_t k = 0; k < BIT_EXPRESSION_BLOCK; k += 64) {
+                __m512i const v = _mm512_loadu_si512(block + k);
+                __m512i const c = _mm512_add_epi8(
+                    _mm512_shuffle_epi8(lookup, _mm512_and_si512(v, low)),
+                    _mm512_shuffle_epi8(lookup, _mm512_and_si512(_mm512_srli_epi16(v, 4), low)));
+                sum = _mm512_add_epi64(sum, _mm512_sad_epu8(c, _mm512_setzero_si512()));
+            }
+            uint64_t lanes[8];
+            _mm512_storeu_si512(lanes, sum);
+            return lanes[0] + lanes[1] + lanes[2] + lanes[3] + lanes[4] + lanes[5] + lanes[6] + lanes[7];
+        }
+
+        [[gnu::target("avx512bw")]] static bool none(uint8_t const* block) {
+            __m512i any = _mm512_setzero_si512();
+            for(size_t k = 0; k < BIT_EXPRESSION_BLOCK; k += 64) any = _mm512_or_si512(any, _mm512_loadu_si512(block + k));
+            return _mm512_test_epi64_mask(any, any) == 0;
+        }
+    };
+#endif
+
+    // stores the word packs of an expression's result
+    // nb: the expression is inlined into each variant, so the compiler vectorizes its operations for the respective instruction set
+    template<typename X>
+    [[gnu::always_inline]] inline void evaluate_packs(X const& x, size_t const num_packs, typename X::PackType* out) {
+        for(size_t p = 0; p < num_packs; p++) out[p] = x.word(p);
+        out[num_packs - 1] &= tail_mask(x); // keep the bits beyond the end unset
+    }
+
+    // counts the set bits in an expression's result, buffering full blocks of word packs
+    template<typename Isa, typename X>
+    [[gnu::always_inline]] inline size_t count_ones_packs(X const& x, size_t const num_packs) {
+        using Pack = typename X::PackType;
+        constexpr size_t BLOCK_PACKS = BIT_EXPRESSION_BLOCK / sizeof(Pack);
+
+        // the last word pack is never part of a block, because it needs to be masked
+        Pack block[BLOCK_PACKS];
+        size_t ones = 0;
+        size_t p = 0;
+        for(; p + BLOCK_PACKS < num_packs; p += BLOCK_PACKS) {
+            for(size_t k = 0; k < BLOCK_PACKS; k++) block[k] = x.word(p + k);
+            ones += Isa::count_ones(reinterpret_cast<uint8_t const*>(block));
+        }
+        for(; p + 1 < num_packs; p++) ones += std::popcount(x.word(p));
+        return ones + std::popcount(Pack(x.word(num_packs - 1) & tail_mask(x)));
+    }
+
+    // reports the positions of the set bits in a word pack of an expression's result
+    template<typename BitOrder, WordPackEligible Pack, typename F>
+    [[gnu::always_inline]] inline void for_each_set_in_pack(Pack w, size_t const p, F& f) {
+        constexpr size_t PACK_BITS = std::numeric_limits<Pack>::digits;
+        if constexpr(std::is_same_v<BitOrder, bit_order::MsbFirst>) {
+            w = big_endian(w); // the first bit is now the most significant
+            while(w) {
+                size_t const j = std::countl_zero(w);
+                f(p * PACK_BITS + j);
+                w &= Pack(~(Pack(1) << (PACK_BITS - 1 - j)));
+            }
+        } else {
+            while(w) {
+                f(p * PACK_BITS + std::countr_zero(w));
+                w &= w - 1;
+            }
+        }
+    }
+
+    // enumerates the set bits in an expression's result, buffering full blocks of word packs and skipping empty ones
+    template<typename Isa, typename X, typename F>
+    [[gnu::always_inline]] inline void for_each_set_packs(X const& x, size_t const num_packs, F& f) {
+        using Pack = typename X::PackType;
+        using BitOrder = typename X::BitOrderType;
+        constexpr size_t BLOCK_PACKS = BIT_EXPRESSION_BLOCK / sizeof(Pack);
+
+        Pack block[BLOCK_PACKS];
+        size_t p = 0;
+        for(; p + BLOCK_PACKS < num_packs; p += BLOCK_PACKS) {
+            for(size_t k = 0; k < BLOCK_PACKS; k++) block[k] = x.word(p + k);
+            if(Isa::none(reinterpret_cast<uint8_t const*>(block))) continue;
+            for(size_t k = 0; k < BLOCK_PACKS; k++) for_each_set_in_pack<BitOrder>(block[k], p + k, f);
+        }
+        for(; p + 1 < num_packs; p++) for_each_set_in_pack<BitOrder>(x.word(p), p, f);
+        for_each_set_in_pack<BitOrder>(Pack(x.word(num_packs - 1) & tail_mask(x)), num_packs - 1, f);
+    }
+
+#ifdef WORD_PACKING_X86_DISPATCH
+    template<typename X>
+    [[gnu::target("avx2")]] void evaluate_packs_avx2(X const& x, size_t const num_packs, typename X::PackType* out) {
+        evaluate_packs(x, num_packs, out);
+    }
+
+    template<typename X>
+    [[gnu::target("avx512bw")]] void evaluate_packs_avx512(X const& x, size_t const num_packs, typename X::PackType* out) {
+        evaluate_packs(x, num_packs, out);
+    }
+
+    template<typename X>
+    [[gnu::target("avx2,popcnt")]] size_t count_ones_packs_avx2(X const& x, size_t const num_packs) {
+        return count_ones_packs<BitBlockAvx2>(x, num_packs);
+    }
+
+    template<typename X>
+    [[gnu::target("avx512bw,popcnt")]] size_t count_ones_packs_avx512(X const& x, size_t const num_packs) {
+        return count_ones_packs<BitBlockAvx512>(x, num_packs);
+    }
+
+    template<typename X, typename F>
+    [[gnu::target("avx2")]] void for_each_set_packs_avx2(X const& x, size_t const num_packs, F& f) {
+        for_each_set_packs<BitBlockAvx2>(x, num_packs, f);
+    }
+
+    template<typename X, typename F>
+    [[gnu::target("avx512bw")]] void for_each_set_packs_avx512(X const& x, size_t const num_packs, F& f) {
+        for_each_set_packs<BitBlockAvx512>(x, num_packs, f);
+    }
+#endif
+}
+
+/**
+ * \brief Evaluates a bit expression into an existing bit vector
+ *
+ * The expression is evaluated word pack by word pack in a single pass without any intermediate vectors.
+ * The output may be one of the operands.
+ * Depending on the CPU, which is detected at runtime, the loop is compiled for AVX-512 or AVX2.
+ *
+ * \param e the expression
+ * \param out the output bit vector, which must have the same size as the expression
+ */
+template<internal::BitExpressionOperand E, typename Stats>
+void evaluate(E const& e, PackedFixedWidthIntVector<1, typename internal::bit_expression_of<E>::PackType, typename internal::bit_expression_of<E>::BitOrderType, Stats>& out) {
+    auto const x = internal::as_bit_expression(e);
+    using Pack = typename decltype(x)::PackType;
+    assert(out.size() == x.size());
+
+    size_t const num_packs = num_packs_required<Pack>(x.size(), 1);
+    if(num_packs == 0) return;
+
+#ifdef WORD_PACKING_X86_DISPATCH
+    if(internal::cpu::has_avx512bw()) return internal::evaluate_packs_avx512(x, num_packs, out.data());
+    if(internal::cpu::has_avx2()) return internal::evaluate_packs_avx2(x, num_packs, out.data());
+#endif
+    internal::evaluate_packs(x, num_packs, out.data());
+}
+
+/**
+ * \brief Evaluates a bit expression into a new bit vector
+ *
+ * \param e the expression
+ * \return a bit vector containing the result
+ */
+template<internal::BitExpressionOperand E>
+auto evaluate(E const& e) {
+    using X = internal::bit_expression_of<E>;
+    PackedFixedWidthIntVector<1, typename X::PackType, typename X::BitOrderType> out(e.size());
+    evaluate(e, out);
+    return out;
+}
+
+/**
+ * \brief Counts the set bits in the result of a bit expression without materializing it
+ *
+ * The result is computed in blocks of 256 bytes.
+ * Depending on the CPU, which is detected at runtime, the set bits in a block are counted using AVX-512BW or AVX2 shuffles as nibble lookup tables,
+ * or using `popcount` on each 64-bit word.
+ *
+ * \param e the expression
+ * \return the number of set bits in the result
+ */
+template<internal::BitExpressionOperand E>
+size_t count_ones(E const& e) {
+    auto const x = internal::as_bit_expression(e);
+    using Pack = typename decltype(x)::PackType;
+
+    size_t const num_packs = num_packs_required<Pack>(x.size(), 1);
+    if(num_packs == 0) return 0;
+
+#ifdef WORD_PACKING_X86_DISPATCH
+    if(internal::cpu::has_avx512bw() && internal::cpu::has_popcnt()) return internal::count_ones_packs_avx512(x, num_packs);
+    if(internal::cpu::has_avx2() && internal::cpu::has_popcnt()) return internal::count_ones_packs_avx2(x, num_packs);
+#endif
+    return internal::count_ones_packs<internal::BitBlockPortable>(x, num_packs);
+}
+
+/**
+ * \brief Enumerates the positions of the set bits in the result of a bit expression without materializing it
+ *
+ * The result is computed in blocks of 256 bytes, and blocks without set bits are skipped.
+ * Depending on the CPU, which is detected at runtime, empty blocks are recognized using AVX-512 or AVX2.
+ *
+ * \tparam F the callback type
+ * \param e the expression
+ * \param f the callback, called with the position of each set bit in ascending order
+ */
+template<internal::BitExpressionOperand E, typename F>
+void for_each_set(E const& e, F f) {
+    auto const x = internal::as_bit_expression(e);
+    using Pack = typename decltype(x)::PackType;
+
+    size_t const num_packs = num_packs_required<Pack>(x.size(), 1);
+    if(num_packs == 0) return;
+
+#ifdef WORD_PACKING_X86_DISPATCH
+    if(internal::cpu::has_avx512bw()) return internal::for_each_set_packs_avx512(x, num_packs, f);
+    if(internal::cpu::has_avx2()) return internal::for_each_set_packs_avx2(x, num_packs, f);
+#endif
+    internal::for_each_set_packs<internal::BitBlockPortable>(x, num_packs, f);
+}
+
+}
+
+#endif
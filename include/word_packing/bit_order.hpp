@@ -0,0 +1,204 @@
+/**
+ * word_packing/bit_order.hpp
+ * part of pdinklag/word-packing
+ * 
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _WORD_PACKING_BIT_ORDER_HPP
+#define _WORD_PACKING_BIT_ORDER_HPP
+
+#include "internal/impl.hpp"
+#include "internal/impl_msb.hpp"
+#include "internal/impl_padded.hpp"
+
+namespace word_packing::internal {
+
+// layout functions shared by the bit orders that pack integers densely
+struct DenseLayout {
+    template<WordPackEligible Pack>
+    static size_t num_packs(size_t num, size_t width) { return num_packs_required<Pack>(num, width); }
+
+    template<WordPackEligible Pack>
+    static size_t num_full_packs(size_t num, size_t width) { return (num * width) / std::numeric_limits<Pack>::digits; }
+
+    template<WordPackEligible Pack>
+    static size_t first_in_pack(size_t p, size_t width) { return (p * std::numeric_limits<Pack>::digits) / width; }
+
+    template<WordPackEligible Pack>
+    static bool straddles(size_t i, size_t width) { return (i * width) % std::numeric_limits<Pack>::digits + width > std::numeric_limits<Pack>::digits; }
+
+    template<WordPackEligible Pack>
+    static size_t pack_index(size_t i, size_t width) { return (i * width) / std::numeric_limits<Pack>::digits; }
+};
+
+}
+
+/**
+ * \brief Bit order policies for packed integers
+ *
+ * The policies are passed as template parameters to containers and accessors and determine how integers are laid out in the word packs.
+ * Besides accessing integers and bit ranges, a policy reports how many word packs a number of integers occupies (`num_packs`),
+ * how many word packs are entirely covered by them (`num_full_packs`), which integer is the first to have bits in a given word pack (`first_in_pack`)
+ * whether an integer straddles two word packs (`straddles`), which word pack holds the first bit of an integer (`pack_index`)
+ * and which bits of a word pack hold a range of bit positions (`range_mask`).
+ * Consecutive integers are read in bulk using `unpack`, which loads each word pack only once.
+ */
+namespace word_packing::bit_order {
+
+/**
+ * \brief Bit order that packs integers starting from the least significant bit of each word pack
+ *
+ * This is the default layout and is also used by, e.g., Apache Parquet.
+ */
+struct LsbFirst : internal::DenseLayout {
+    template<WordPackEligible Pack>
+    static uintmax_t get(Pack const* data, size_t i, size_t width, uintmax_t mask) { return internal::get(data, i, width, mask); }
+
+    template<size_t width, WordPackEligible Pack>
+    static uintmax_t get(Pack const* data, size_t i) { return internal::get<width>(data, i); }
+
+    template<WordPackEligible Pack>
+    static void set(Pack* data, size_t i, uintmax_t x, size_t width, uintmax_t mask) { internal::set(data, i, x, width, mask); }
+
+    template<size_t width, WordPackEligible Pack>
+    static void set(Pack* data, size_t i, uintmax_t x) { internal::set<width>(data, i, x); }
+
+    template<typename Overflow, WordPackEligible Pack>
+    static uintmax_t add(Pack* data, size_t i, uintmax_t d, size_t width, uintmax_t mask) { return internal::add<Overflow>(data, i, d, width, mask); }
+
+    template<size_t width, typename Overflow, WordPackEligible Pack>
+    static uintmax_t add(Pack* data, size_t i, uintmax_t d) { return internal::add<width, Overflow>(data, i, d); }
+
+    template<WordPackEligible Pack>
+    static uintmax_t get_bits(Pack const* data, size_t bit_off, size_t nbits) { return internal::get_bits(data, bit_off, nbits); }
+
+    template<WordPackEligible Pack>
+    static void set_bits(Pack* data, size_t bit_off, size_t nbits, uintmax_t x) { internal::set_bits(data, bit_off, nbits, x); }
+
+    template<WordPackEligible Pack>
+    static Pack range_mask(size_t lo, size_t hi) { return internal::range_mask<Pack>(lo, hi); }
+
+    template<WordPackEligible Pack>
+    static void unpack(Pack const* data, size_t i, size_t num, size_t width, uintmax_t* out) { internal::unpack(data, i, num, width, out); }
+};
+
+/**
+ * \brief Bit order that packs integers starting from the most significant bit, treating the word packs as a big-endian bit stream
+ *
+ * Bit k is the (k mod 8)-th most significant bit of the (k / 8)-th byte regardless of the word pack type, and integers are stored starting with their most significant bit.
+ * This is the layout used by many network protocols and file formats (e.g., Apache ORC), which can thus be accessed directly.
+ * Bit ranges read and written using `get_bits` and `set_bits` also start with their most significant bit.
+ */
+struct MsbFirst : internal::DenseLayout {
+    template<WordPackEligible Pack>
+    static uintmax_t get(Pack const* data, size_t i, size_t width, uintmax_t) { return internal::msb::get(data, i, width); }
+
+    template<size_t width, WordPackEligible Pack>
+    static uintmax_t get(Pack const* data, size_t i) { return internal::msb::get<width>(data, i); }
+
+    template<WordPackEligible Pack>
+    static void set(Pack* data, size_t i, uintmax_t x, size_t width, uintmax_t mask) { internal::msb::set(data, i, x, width, mask); }
+
+    template<size_t width, WordPackEligible Pack>
+    static void set(Pack* data, size_t i, uintmax_t x) { internal::msb::set<width>(data, i, x); }
+
+    template<typename Overflow, WordPackEligible Pack>
+    static uintmax_t add(Pack* data, size_t i, uintmax_t d, size_t width, uintmax_t mask) { return internal::msb::add<Overflow>(data, i, d, width, mask); }
+
+    template<size_t width, typename Overflow, WordPackEligible Pack>
+    static uintmax_t add(Pack* data, size_t i, uintmax_t d) { return internal::msb::add<width, Overflow>(data, i, d); }
+
+    template<WordPackEligible Pack>
+    static uintmax_t get_bits(Pack const* data, size_t bit_off, size_t nbits) { return internal::msb::get_bits(data, bit_off, nbits); }
+
+    template<WordPackEligible Pack>
+    static void set_bits(Pack* data, size_t bit_off, size_t nbits, uintmax_t x) { internal::msb::set_bits(data, bit_off, nbits, x); }
+
+    template<WordPackEligible Pack>
+    static Pack range_mask(size_t lo, size_t hi) { return internal::msb::range_mask<Pack>(lo, hi); }
+
+    template<WordPackEligible Pack>
+    static void unpack(Pack const* data, size_t i, size_t num, size_t width, uintmax_t* out) { internal::msb::unpack(data, i, num, width, out); }
+};
+
+/**
+ * \brief Bit order that packs integers starting from the least significant bit, but never lets an integer straddle two word packs
+ *
+ * Each word pack holds `floor(PACK_BITS / width)` integers and the remaining most significant bits are padding,
+ * so every access reads and writes a single word pack, trading space for latency.
+ * For widths that divide the pack width, this is the same as \ref LsbFirst .
+ * Containers keep the padding bits zero, so it is not accessed when containers are compared or hashed.
+ * 
+ * Bit ranges read and written using `get_bits` and `set_bits` address the raw bits of the word packs, including the padding.
+ */
+struct Padded {
+    template<WordPackEligible Pack>
+    static uintmax_t get(Pack const* data, size_t i, size_t width, uintmax_t mask) { return internal::padded::get(data, i, width, mask); }
+
+    template<size_t width, WordPackEligible Pack>
+    static uintmax_t get(Pack const* data, size_t i) { return internal::padded::get<width>(data, i); }
+
+    template<WordPackEligible Pack>
+    static void set(Pack* data, size_t i, uintmax_t x, size_t width, uintmax_t mask) { internal::padded::set(data, i, x, width, mask); }
+
+    template<size_t width, WordPackEligible Pack>
+    static void set(Pack* data, size_t i, uintmax_t x) { internal::padded::set<width>(data, i, x); }
+
+    template<typename Overflow, WordPackEligible Pack>
+    static uintmax_t add(Pack* data, size_t i, uintmax_t d, size_t width, uintmax_t mask) { return internal::padded::add<Overflow>(data, i, d, width, mask); }
+
+    template<size_t width, typename Overflow, WordPackEligible Pack>
+    static uintmax_t add(Pack* data, size_t i, uintmax_t d) { return internal::padded::add<width, Overflow>(data, i, d); }
+
+    template<WordPackEligible Pack>
+    static uintmax_t get_bits(Pack const* data, size_t bit_off, size_t nbits) { return internal::get_bits(data, bit_off, nbits); }
+
+    template<WordPackEligible Pack>
+    static void set_bits(Pack* data, size_t bit_off, size_t nbits, uintmax_t x) { internal::set_bits(data, bit_off, nbits, x); }
+
+    template<WordPackEligible Pack>
+    static Pack range_mask(size_t lo, size_t hi) { return internal::range_mask<Pack>(lo, hi); }
+
+    template<WordPackEligible Pack>
+    static size_t num_packs(size_t num, size_t width) { return internal::padded::num_packs<Pack>(num, width); }
+
+    template<WordPackEligible Pack>
+    static size_t num_full_packs(size_t num, size_t width) { return num / internal::padded::num_per_pack<Pack>(width); }
+
+    template<WordPackEligible Pack>
+    static size_t first_in_pack(size_t p, size_t width) { return p * internal::padded::num_per_pack<Pack>(width); }
+
+    template<WordPackEligible Pack>
+    static bool straddles(size_t, size_t) { return false; }
+
+    template<WordPackEligible Pack>
+    static size_t pack_index(size_t i, size_t width) { return i / internal::padded::num_per_pack<Pack>(width); }
+
+    template<WordPackEligible Pack>
+    static void unpack(Pack const* data, size_t i, size_t num, size_t width, uintmax_t* out) { internal::padded::unpack(data, i, num, width, out); }
+};
+
+}
+
+#endif
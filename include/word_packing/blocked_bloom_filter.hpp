@@ -0,0 +1,326 @@
+/**
+ * word_packing/blocked_bloom_filter.hpp
+ * part of pdinklag/word-packing
+ * 
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _WORD_PACKING_BLOCKED_BLOOM_FILTER_HPP
+#define _WORD_PACKING_BLOCKED_BLOOM_FILTER_HPP
+
+#include "internal/bitwise.hpp"
+#include "internal/cpu.hpp"
+#include "packed_fixed_width_int_vector.hpp"
+
+#include <algorithm>
+
+namespace word_packing {
+
+namespace internal {
+    // computes the masks of the 64-bit words of a 512-bit block for the bit positions (lo * salt[j]) >> 23, j < k
+    struct BloomMasksPortable {
+        static void compute(uint32_t const lo, uint32_t const* salt, size_t const k, uint64_t* masks) {
+            for(size_t w = 0; w < 8; w++) masks[w] = 0;
+            for(size_t j = 0; j < k; j++) {
+                uint32_t const pos = (lo * salt[j]) >> 23; // nb: the 9 highest bits address a bit within the block
+                masks[pos / 64] |= uint64_t(1) << (pos % 64);
+            }
+        }
+    };
+
+#ifdef WORD_PACKING_X86_DISPATCH
+    // computes the bit positions using vector multiplications and sets them in each word using variable shifts,
+    // which yield zero for positions outside of the word
+    struct BloomMasksAvx2 {
+        [[gnu::target("avx2")]] static void compute(uint32_t const lo, uint32_t const* salt, size_t const k, uint64_t* masks) {
+            __m256i const x = _mm256_set1_epi32(lo);
+            alignas(32) uint32_t pos[16];
+            _mm256_store_si256(reinterpret_cast<__m256i*>(pos), _mm256_srli_epi32(_mm256_mullo_epi32(x, _mm256_loadu_si256(reinterpret_cast<__m256i const*>(salt))), 23));
+            _mm256_store_si256(reinterpret_cast<__m256i*>(pos + 8), _mm256_srli_epi32(_mm256_mullo_epi32(x, _mm256_loadu_si256(reinterpret_cast<__m256i const*>(salt + 8))), 23));
+
+            __m256i const one = _mm256_set1_epi64x(1);
+            __m256i const base_lo = _mm256_setr_epi64x(0, 64, 128, 192);
+            __m256i const base_hi = _mm256_setr_epi64x(256, 320, 384, 448);
+            __m256i m_lo = _mm256_setzero_si256();
+            __m256i m_hi = _mm256_setzero_si256();
+            for(size_t j = 0; j < k; j++) {
+                __m256i const p = _mm256_set1_epi64x(pos[j]);
+                m_lo = _mm256_or_si256(m_lo, _mm256_sllv_epi64(one, _mm256_sub_epi64(p, base_lo)));
+                m_hi = _mm256_or_si256(m_hi, _mm256_sllv_epi64(one, _mm256_sub_epi64(p, base_hi)));
+            }
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(masks), m_lo);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(masks + 4), m_hi);
+        }
+    };
+
+    // like the AVX2 variant, but the whole block fits into a single register
+    struct BloomMasksAvx512 {
+        [[gnu::target("avx512f")]] static void compute(uint32_t const lo, uint32_t const* salt, size_t const k, uint64_t* masks) {
+            alignas(64) uint32_t pos[16];
+            _mm512_store_si512(pos, _mm512_srli_epi32(_mm512_mullo_epi32(_mm512_set1_epi32(lo), _mm512_loadu_si512(salt)), 23));
+
+            __m512i const one = _mm512_set1_epi64(1);
+            __m512i const base = _mm512_setr_epi64(0, 64, 128, 192, 256, 320, 384, 448);
+            __m512i m = _mm512_setzero_si512();
+            for(size_t j = 0; j < k; j++) {
+                m = _mm512_or_si512(m, _mm512_sllv_epi64(one, _mm512_sub_epi64(_mm512_set1_epi64(pos[j]), base)));
+            }
+            _mm512_storeu_si512(masks, m);
+        }
+    };
+#endif
+
+    // a kernel computing the masks of a block
+    using BloomMasksFunction = void(*)(uint32_t, uint32_t const*, size_t, uint64_t*);
+
+    // selects the kernel computing the masks of a block according to the features of the CPU
+    inline BloomMasksFunction select_bloom_masks() {
+    #ifdef WORD_PACKING_X86_DISPATCH
+        if(cpu::has_avx512bw()) return &BloomMasksAvx512::compute;
+        if(cpu::has_avx2()) return &BloomMasksAvx2::compute;
+    #endif
+        return &BloomMasksPortable::compute;
+    }
+}
+
+/**
+ * \brief Cache-line-blocked Bloom filter
+ *
+ * The filter consists of blocks of 512 bits, each aligned to a cache line.
+ * The hash value of a key selects one block and k bit positions within it,
+ * so that a lookup touches only a single cache line.
+ *
+ * The k bit positions are computed by multiplying the low half of the hash value with k different odd constants.
+ * Depending on the CPU, which is detected at runtime when the filter is constructed, the positions are computed using AVX-512 or AVX2 vector multiplications
+ * and set in all words of the block at once using variable shifts; otherwise, they are computed one by one.
+ * The subsequent update or test is written as a loop over a fixed-size array of 64-bit words, which compilers vectorize.
+ *
+ * The bits are stored in a bit vector, which is over-allocated by one block to allow for alignment.
+ */
+class BlockedBloomFilter {
+private:
+    using Bits = PackedFixedWidthIntVector<1>;
+
+    static constexpr size_t PACK_BITS = std::numeric_limits<uintmax_t>::digits;
+    static_assert(PACK_BITS == 64, "blocks are processed as 64-bit words");
+    static constexpr size_t BLOCK_BITS = 512;
+    static constexpr size_t BLOCK_PACKS = BLOCK_BITS / PACK_BITS;
+    static constexpr size_t BLOCK_BYTES = BLOCK_BITS / 8;
+
+    static constexpr uint32_t SALT[] = {
+        0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU, 0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U,
+        0x6b43a9b5U, 0x1d8e4e27U, 0xc2b2ae35U, 0x27d4eb2fU, 0x165667b1U, 0x85ebca6bU, 0x9e3779b1U, 0xd3a2646dU
+    };
+
+public:
+    /**
+     * \brief The maximum number of hash functions
+     */
+    static constexpr size_t MAX_HASHES = sizeof(SALT) / sizeof(SALT[0]);
+
+private:
+    size_t num_blocks_;
+    size_t num_hashes_;
+    size_t offset_; // the number of packs preceding the first aligned block
+    internal::BloomMasksFunction compute_masks_;
+    Bits bits_;
+
+    void allocate() {
+        bits_ = Bits((num_blocks_ + 1) * BLOCK_BITS);
+        std::fill(bits_.data(), bits_.data() + (num_blocks_ + 1) * BLOCK_PACKS, uintmax_t(0));
+
+        uintptr_t const addr = reinterpret_cast<uintptr_t>(bits_.data());
+        offset_ = ((BLOCK_BYTES - addr % BLOCK_BYTES) % BLOCK_BYTES) / sizeof(uintmax_t);
+    }
+
+    uintmax_t* block(size_t const b) { return bits_.data() + offset_ + b * BLOCK_PACKS; }
+    uintmax_t const* block(size_t const b) const { return bits_.data() + offset_ + b * BLOCK_PACKS; }
+
+    size_t block_index(uint64_t const h) const {
+        // map the high half of the hash value to a block without division
+        return ((h >> 32) * num_blocks_) >> 32;
+    }
+
+    void compute_masks(uint64_t const h, uint64_t* masks) const {
+        compute_masks_(uint32_t(h), SALT, num_hashes_, masks);
+    }
+
+    void insert_hashed(uint64_t const h) {
+        uint64_t masks[BLOCK_PACKS];
+        compute_masks(h, masks);
+
+        uintmax_t* blk = block(block_index(h));
+        for(size_t w = 0; w < BLOCK_PACKS; w++) blk[w] |= masks[w];
+    }
+
+    bool contains_hashed(uint64_t const h) const {
+        uint64_t masks[BLOCK_PACKS];
+        compute_masks(h, masks);
+
+        uintmax_t const* blk = block(block_index(h));
+        uintmax_t missing = 0;
+        for(size_t w = 0; w < BLOCK_PACKS; w++) missing |= masks[w] & ~blk[w];
+        return missing == 0;
+    }
+
+public:
+    /**
+     * \brief Constructs an empty filter without any blocks
+     *
+     */
+    BlockedBloomFilter() : num_blocks_(0), num_hashes_(0), offset_(0), compute_masks_(internal::select_bloom_masks()) {
+    }
+
+    /**
+     * \brief Constructs an empty filter
+     *
+     * \param num_bits the number of bits in the filter, rounded up to the next multiple of 512
+     * \param num_hashes the number of bits set per key, at most \ref MAX_HASHES
+     */
+    BlockedBloomFilter(size_t const num_bits, size_t const num_hashes = 8)
+        : num_blocks_(std::max(size_t(1), internal::idiv_ceil(num_bits, BLOCK_BITS))),
+          num_hashes_(num_hashes),
+          compute_masks_(internal::select_bloom_masks()) {
+
+        assert(num_hashes_ > 0);
+        assert(num_hashes_ <= MAX_HASHES);
+        allocate();
+    }
+
+    BlockedBloomFilter(BlockedBloomFilter&&) = default;
+    BlockedBloomFilter& operator=(BlockedBloomFilter&&) = default;
+
+    BlockedBloomFilter(BlockedBloomFilter const& other) { *this = other; }
+    BlockedBloomFilter& operator=(BlockedBloomFilter const& other) {
+        num_blocks_ = other.num_blocks_;
+        num_hashes_ = other.num_hashes_;
+        compute_masks_ = other.compute_masks_;
+        allocate(); // nb: the alignment offset may differ from the other filter's
+        std::copy(other.block(0), other.block(num_blocks_), block(0));
+        return *this;
+    }
+
+    /**
+     * \brief Inserts a key into the filter
+     *
+     * \param key the key to insert
+     */
+    void insert(uint64_t const key) {
+        insert_hashed(internal::hash64(key));
+    }
+
+    /**
+     * \brief Tests whether a key may be contained in the filter
+     *
+     * \param key the key in question
+     * \return true if the key may have been inserted
+     * \return false if the key has definitely not been inserted
+     */
+    bool contains(uint64_t const key) const {
+        return contains_hashed(internal::hash64(key));
+    }
+
+    /**
+     * \brief Tests whether the given keys may be contained in the filter
+     *
+     * The blocks of upcoming keys are prefetched while the current key is being tested.
+     * Each key is hashed only once, the hash values of the upcoming keys are buffered.
+     *
+     * \param keys the keys in question
+     * \param num the number of keys
+     * \param out the output array, receiving for each key whether it may be contained in the filter
+     */
+    void contains_many(uint64_t const* keys, size_t const num, bool* out) const {
+        constexpr size_t LOOKAHEAD = 16;
+
+        uint64_t hashes[LOOKAHEAD];
+        auto prefetch = [&](size_t const i){
+            uint64_t const h = internal::hash64(keys[i]);
+            hashes[i % LOOKAHEAD] = h;
+            __builtin_prefetch(block(block_index(h)));
+        };
+
+        for(size_t i = 0; i < std::min(num, LOOKAHEAD); i++) prefetch(i);
+        for(size_t i = 0; i < num; i++) {
+            uint64_t const h = hashes[i % LOOKAHEAD];
+            if(i + LOOKAHEAD < num) prefetch(i + LOOKAHEAD);
+            out[i] = contains_hashed(h);
+        }
+    }
+
+    /**
+     * \brief Merges another filter into this filter
+     *
+     * After merging, this filter reports all keys that were inserted into either filter.
+     * Both filters must have the same number of blocks and hash functions.
+     *
+     * \param other the filter to merge
+     */
+    void merge(BlockedBloomFilter const& other) {
+        assert(num_blocks_ == other.num_blocks_);
+        assert(num_hashes_ == other.num_hashes_);
+        internal::pack_or(block(0), other.block(0), num_blocks_ * BLOCK_PACKS);
+    }
+
+    /**
+     * \brief Removes all keys from the filter
+     *
+     */
+    void clear() {
+        std::fill(block(0), block(num_blocks_), uintmax_t(0));
+    }
+
+    /**
+     * \brief Reports the number of bits in the filter
+     *
+     * \return the number of bits in the filter
+     */
+    size_t num_bits() const { return num_blocks_ * BLOCK_BITS; }
+
+    /**
+     * \brief Reports the number of blocks in the filter
+     *
+     * \return the number of 512-bit blocks in the filter
+     */
+    size_t num_blocks() const { return num_blocks_; }
+
+    /**
+     * \brief Reports the number of bits set per key
+     *
+     * \return the number of bits set per key
+     */
+    size_t num_hashes() const { return num_hashes_; }
+
+    /**
+     * \brief Reports the number of heap bytes used by the filter
+     *
+     * This includes the padding used to align the blocks.
+     *
+     * \return the number of heap bytes used
+     */
+    size_t memory_usage() const { return bits_.memory_usage(); }
+};
+
+}
+
+#endif
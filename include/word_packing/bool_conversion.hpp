@@ -0,0 +1,352 @@
+/**
+ * word_packing/bool_conversion.hpp
+ * part of pdinklag/word-packing
+ * 
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _WORD_PACKING_BOOL_CONVERSION_HPP
+#define _WORD_PACKING_BOOL_CONVERSION_HPP
+
+#include "internal/cpu.hpp"
+#include "packed_fixed_width_int_vector.hpp"
+
+#include <array>
+#include <cstring>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace word_packing {
+
+namespace internal {
+    static_assert(sizeof(bool) == 1, "bool arrays are assumed to be byte arrays");
+
+    // table that maps each byte to eight bytes that contain its bits
+    constexpr std::array<uint64_t, 256> BYTE_SPREAD = [](){
+        std::array<uint64_t, 256> table;
+        for(size_t b = 0; b < 256; b++) {
+            uint64_t x = 0;
+            for(size_t j = 0; j < 8; j++) x |= uint64_t((b >> j) & 1) << (8 * j);
+            table[b] = x;
+        }
+        return table;
+    }();
+
+    // conversion between 64 bytes and 64 bits without instruction set extensions
+    struct BoolsPortable {
+        // gathers the 64 bytes starting at the given position into 64 bits, setting a bit iff the corresponding byte is nonzero
+        static uint64_t gather(uint8_t const* in) {
+        #ifdef __SSE2__
+            __m128i const zero = _mm_setzero_si128();
+            uint64_t zeros = 0;
+            for(size_t k = 0; k < 4; k++) {
+                __m128i const x = _mm_loadu_si128(reinterpret_cast<__m128i const*>(in + 16 * k));
+                zeros |= uint64_t(uint16_t(_mm_movemask_epi8(_mm_cmpeq_epi8(x, zero)))) << (16 * k);
+            }
+            return ~zeros;
+        #else
+            uint64_t bits = 0;
+            for(size_t k = 0; k < 8; k++) {
+                uint64_t x;
+                std::memcpy(&x, in + 8 * k, 8);
+                if constexpr(std::endian::native == std::endian::big) x = __builtin_bswap64(x);
+
+                // move the information whether a byte is nonzero to its lowest bit, then gather the lowest bits using a multiplication
+                x = (((x & 0x7F7F7F7F7F7F7F7FULL) + 0x7F7F7F7F7F7F7F7FULL) | x) & 0x8080808080808080ULL;
+                bits |= (((x >> 7) * 0x0102040810204080ULL) >> 56) << (8 * k);
+            }
+            return bits;
+        #endif
+        }
+
+        // spreads the 64 bits of a word to 64 bytes, each being either zero or one
+        static void scatter(uint64_t const bits, uint8_t* out) {
+            for(size_t k = 0; k < 8; k++) {
+                uint64_t x = BYTE_SPREAD[uint8_t(bits >> (8 * k))];
+                if constexpr(std::endian::native == std::endian::big) x = __builtin_bswap64(x);
+                std::memcpy(out + 8 * k, &x, 8);
+            }
+        }
+    };
+
+#ifdef WORD_PACKING_X86_DISPATCH
+    // gathers bytes using two 32-byte comparisons
+    struct BoolsAvx2 {
+        [[gnu::target("avx2")]] static uint64_t gather(uint8_t const* in) {
+            __m256i const zero = _mm256_setzero_si256();
+            uint64_t zeros = 0;
+            for(size_t k = 0; k < 2; k++) {
+                __m256i const x = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(in + 32 * k));
+                zeros |= uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, zero)))) << (32 * k);
+            }
+            return ~zeros;
+        }
+    };
+
+    // spreads bits to bytes using parallel bit deposits
+    struct BoolsBmi2 {
+        [[gnu::target("bmi2")]] static void scatter(uint64_t const bits, uint8_t* out) {
+            for(size_t k = 0; k < 8; k++) {
+                uint64_t const x = _pdep_u64(uint8_t(bits >> (8 * k)), 0x0101010101010101ULL);
+                std::memcpy(out + 8 * k, &x, 8);
+            }
+        }
+    };
+
+    // converts 64 bytes at once using mask registers
+    struct BoolsAvx512 {
+        [[gnu::target("avx512bw")]] static uint64_t gather(uint8_t const* in) {
+            __m512i const x = _mm512_loadu_si512(in);
+            return _mm512_test_epi8_mask(x, x);
+        }
+
+        [[gnu::target("avx512bw")]] static void scatter(uint64_t const bits, uint8_t* out) {
+            _mm512_storeu_si512(out, _mm512_maskz_mov_epi8(bits, _mm512_set1_epi8(1)));
+        }
+    };
+#endif
+
+    // stores a 64-bit word into an array of word packs
+    template<WordPackEligible Pack>
+    inline void store64(Pack* out, size_t const w, uint64_t const x) {
+        constexpr size_t PACK_BITS = std::numeric_limits<Pack>::digits;
+        constexpr size_t PACKS_PER_WORD = 64 / PACK_BITS;
+        for(size_t j = 0; j < PACKS_PER_WORD; j++) out[w * PACKS_PER_WORD + j] = Pack(x >> (j * PACK_BITS));
+    }
+
+    // loads a 64-bit word from an array of word packs
+    template<WordPackEligible Pack>
+    inline uint64_t load64(Pack const* in, size_t const w) {
+        constexpr size_t PACK_BITS = std::numeric_limits<Pack>::digits;
+        constexpr size_t PACKS_PER_WORD = 64 / PACK_BITS;
+        uint64_t x = 0;
+        for(size_t j = 0; j < PACKS_PER_WORD; j++) x |= uint64_t(in[w * PACKS_PER_WORD + j]) << (j * PACK_BITS);
+        return x;
+    }
+
+    // packs the given number of 64-byte blocks
+    template<typename Isa, WordPackEligible Pack>
+    [[gnu::always_inline]] inline void pack_bool_blocks(uint8_t const* in, size_t const num_blocks, Pack* out) {
+        for(size_t w = 0; w < num_blocks; w++) store64(out, w, Isa::gather(in + 64 * w));
+    }
+
+    // unpacks the given number of 64-bit blocks
+    template<typename Isa, WordPackEligible Pack>
+    [[gnu::always_inline]] inline void unpack_bool_blocks(Pack const* in, size_t const num_blocks, uint8_t* out) {
+        for(size_t w = 0; w < num_blocks; w++) Isa::scatter(load64(in, w), out + 64 * w);
+    }
+
+#ifdef WORD_PACKING_X86_DISPATCH
+    template<WordPackEligible Pack>
+    [[gnu::target("avx2")]] void pack_bool_blocks_avx2(uint8_t const* in, size_t const num_blocks, Pack* out) {
+        pack_bool_blocks<BoolsAvx2>(in, num_blocks, out);
+    }
+
+    template<WordPackEligible Pack>
+    [[gnu::target("avx512bw")]] void pack_bool_blocks_avx512(uint8_t const* in, size_t const num_blocks, Pack* out) {
+        pack_bool_blocks<BoolsAvx512>(in, num_blocks, out);
+    }
+
+    template<WordPackEligible Pack>
+    [[gnu::target("bmi2")]] void unpack_bool_blocks_bmi2(Pack const* in, size_t const num_blocks, uint8_t* out) {
+        unpack_bool_blocks<BoolsBmi2>(in, num_blocks, out);
+    }
+
+    template<WordPackEligible Pack>
+    [[gnu::target("avx512bw")]] void unpack_bool_blocks_avx512(Pack const* in, size_t const num_blocks, uint8_t* out) {
+        unpack_bool_blocks<BoolsAvx512>(in, num_blocks, out);
+    }
+#endif
+}
+
+/**
+ * \brief Packs an array of bytes into bits, setting a bit iff the corresponding byte is nonzero
+ *
+ * Blocks of 64 bytes are processed at once.
+ * Depending on the CPU, which is detected at runtime, nonzero bytes are found using AVX-512BW mask comparisons, AVX2 or SSE2 comparisons and `movemask`,
+ * or a multiplication trick.
+ * Unused bits in the final word pack are set to zero.
+ *
+ * \tparam Pack the word pack type
+ * \param in the array of bytes
+ * \param n the number of bytes
+ * \param out the array of word packs, which must have room for `n` bits
+ */
+template<WordPackEligible Pack>
+void pack_bools(uint8_t const* in, size_t const n, Pack* out) {
+    constexpr size_t PACK_BITS = std::numeric_limits<Pack>::digits;
+
+    size_t const full = n / 64;
+#ifdef WORD_PACKING_X86_DISPATCH
+    if(internal::cpu::has_avx512bw()) internal::pack_bool_blocks_avx512(in, full, out);
+    else if(internal::cpu::has_avx2()) internal::pack_bool_blocks_avx2(in, full, out);
+    else
+#endif
+    internal::pack_bool_blocks<internal::BoolsPortable>(in, full, out);
+
+    // pack the remaining bytes one by one
+    for(size_t p = 64 * full / PACK_BITS; p < num_packs_required<Pack>(n, 1); p++) out[p] = 0;
+    for(size_t i = 64 * full; i < n; i++) out[i / PACK_BITS] |= Pack(Pack(in[i] != 0) << (i % PACK_BITS));
+}
+
+/**
+ * \brief Packs an array of bools into bits
+ *
+ * \tparam Pack the word pack type
+ * \param in the array of bools
+ * \param n the number of bools
+ * \param out the array of word packs, which must have room for `n` bits
+ */
+template<WordPackEligible Pack>
+void pack_bools(bool const* in, size_t const n, Pack* out) {
+    pack_bools(reinterpret_cast<uint8_t const*>(in), n, out);
+}
+
+/**
+ * \brief Unpacks bits into an array of bytes, each being either zero or one
+ *
+ * Blocks of 64 bits are processed at once.
+ * Depending on the CPU, which is detected at runtime, bits are spread to bytes using AVX-512BW masked moves, BMI2 `pdep` or a lookup table.
+ *
+ * \tparam Pack the word pack type
+ * \param in the array of word packs
+ * \param n the number of bits
+ * \param out the array of bytes, which must have room for `n` bytes
+ */
+template<WordPackEligible Pack>
+void unpack_bools(Pack const* in, size_t const n, uint8_t* out) {
+    constexpr size_t PACK_BITS = std::numeric_limits<Pack>::digits;
+
+    size_t const full = n / 64;
+#ifdef WORD_PACKING_X86_DISPATCH
+    if(internal::cpu::has_avx512bw()) internal::unpack_bool_blocks_avx512(in, full, out);
+    else if(internal::cpu::has_bmi2()) internal::unpack_bool_blocks_bmi2(in, full, out);
+    else
+#endif
+    internal::unpack_bool_blocks<internal::BoolsPortable>(in, full, out);
+    for(size_t i = 64 * full; i < n; i++) out[i] = (in[i / PACK_BITS] >> (i % PACK_BITS)) & 1;
+}
+
+/**
+ * \brief Unpacks bits into an array of bools
+ *
+ * \tparam Pack the word pack type
+ * \param in the array of word packs
+ * \param n the number of bits
+ * \param out the array of bools, which must have room for `n` bools
+ */
+template<WordPackEligible Pack>
+void unpack_bools(Pack const* in, size_t const n, bool* out) {
+    unpack_bools(in, n, reinterpret_cast<uint8_t*>(out));
+}
+
+/**
+ * \brief Creates a bit vector from an array of bools
+ *
+ * \param in the array of bools
+ * \param n the number of bools
+ * \return the bit vector
+ */
+inline PackedFixedWidthIntVector<1> to_bit_vector(bool const* in, size_t const n) {
+    PackedFixedWidthIntVector<1> bv(n);
+    pack_bools(in, n, bv.data());
+    return bv;
+}
+
+/**
+ * \brief Creates a bit vector from an array of bytes, setting a bit iff the corresponding byte is nonzero
+ *
+ * \param in the array of bytes
+ * \param n the number of bytes
+ * \return the bit vector
+ */
+inline PackedFixedWidthIntVector<1> to_bit_vector(uint8_t const* in, size_t const n) {
+    PackedFixedWidthIntVector<1> bv(n);
+    pack_bools(in, n, bv.data());
+    return bv;
+}
+
+/**
+ * \brief Creates a bit vector from a `std::vector<bool>`
+ *
+ * With libstdc++, whose `std::vector<bool>` stores bits in the same order in words of type `unsigned long`,
+ * the words are copied directly. Otherwise, the bits are copied one by one.
+ *
+ * \param v the vector of bools
+ * \return the bit vector
+ */
+inline PackedFixedWidthIntVector<1> to_bit_vector(std::vector<bool> const& v) {
+    constexpr size_t WORD_BITS = std::numeric_limits<uintmax_t>::digits;
+    size_t const n = v.size();
+    PackedFixedWidthIntVector<1> bv(n);
+    if(n == 0) return bv;
+
+#ifdef __GLIBCXX__
+    if constexpr(sizeof(std::_Bit_type) == sizeof(uintmax_t)) {
+        std::_Bit_type const* words = v.begin()._M_p;
+        size_t const num_words = num_packs_required<uintmax_t>(n, 1);
+        std::memcpy(bv.data(), words, num_words * sizeof(uintmax_t));
+        if(n % WORD_BITS) bv.data()[num_words - 1] &= internal::low_mask0(n % WORD_BITS); // nb: libstdc++ does not guarantee the unused bits to be zero
+        return bv;
+    }
+#endif
+
+    for(size_t p = 0; p < num_packs_required<uintmax_t>(n, 1); p++) bv.data()[p] = 0;
+    for(size_t i = 0; i < n; i++) bv.data()[i / WORD_BITS] |= uintmax_t(v[i]) << (i % WORD_BITS);
+    return bv;
+}
+
+/**
+ * \brief Creates a `std::vector<bool>` from a bit vector
+ *
+ * With libstdc++, the words are copied directly. Otherwise, the bits are copied one by one.
+ *
+ * \param bv the bit vector
+ * \return the vector of bools
+ */
+inline std::vector<bool> to_vector_bool(PackedFixedWidthIntVector<1> const& bv) {
+    [[maybe_unused]] constexpr size_t WORD_BITS = std::numeric_limits<uintmax_t>::digits;
+    size_t const n = bv.size();
+    std::vector<bool> v(n);
+    if(n == 0) return v;
+
+#ifdef __GLIBCXX__
+    if constexpr(sizeof(std::_Bit_type) == sizeof(uintmax_t)) {
+        std::_Bit_type* words = v.begin()._M_p;
+        size_t const num_words = num_packs_required<uintmax_t>(n, 1);
+        std::memcpy(words, bv.data(), num_words * sizeof(uintmax_t));
+        if(n % WORD_BITS) words[num_words - 1] &= internal::low_mask0(n % WORD_BITS);
+        return v;
+    }
+#endif
+
+    for(size_t i = 0; i < n; i++) v[i] = bv[i];
+    return v;
+}
+
+}
+
+#endif
@@ -0,0 +1,352 @@
+/**
+ * word_packing/compact_hash_set.hpp
+ * part of pdinklag/word-packing
+ * 
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _WORD_PACKING_COMPACT_HASH_SET_HPP
+#define _WORD_PACKING_COMPACT_HASH_SET_HPP
+
+#include "packed_int_vector.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <deque>
+
+namespace word_packing {
+
+/**
+ * \brief Compact hash set of integers of a fixed universe
+ *
+ * Following Cleary's compact hashing, each key of width u is first transformed by a bijective hash function.
+ * The low bits of the hash value select the home slot in a table of 2^a slots,
+ * and only the remaining u-a bits (the quotient) are stored in the table,
+ * packed into a \ref PackedIntVector along with three metadata bits per slot.
+ *
+ * Collisions are resolved by linear probing, keeping the quotients of keys with the same home slot in consecutive runs
+ * in the order of their home slots (as in quotient filters).
+ * The metadata bits mark whether a slot is the home slot of any key, whether an entry continues the run of the previous slot
+ * and whether an entry has been shifted away from its home slot.
+ *
+ * The table is doubled when its load exceeds 90%; this reduces the quotient width by one bit.
+ * So that a slot fits into a single word pack, the table has at least 2^(u+3-w) slots for word packs of width w.
+ *
+ * \tparam Pack the word pack type of the table
+ */
+template<WordPackEligible Pack = uintmax_t>
+class CompactHashSet {
+private:
+    static constexpr size_t PACK_BITS = std::numeric_limits<Pack>::digits;
+
+    static constexpr uintmax_t OCCUPIED = 1;
+    static constexpr uintmax_t CONTINUATION = 2;
+    static constexpr uintmax_t SHIFTED = 4;
+    static constexpr size_t META_BITS = 3;
+    static constexpr uintmax_t META_MASK = internal::low_mask(META_BITS);
+
+    static constexpr uintmax_t MUL1 = 0x9E3779B97F4A7C15ULL;
+    static constexpr uintmax_t MUL2 = 0xBF58476D1CE4E5B9ULL;
+
+    static constexpr uintmax_t mul_inverse(uintmax_t const x) {
+        // Newton's method, each iteration doubles the number of correct low bits
+        uintmax_t inv = x;
+        for(size_t i = 0; i < 6; i++) inv *= 2 - x * inv;
+        return inv;
+    }
+
+    static constexpr uintmax_t MUL1_INV = mul_inverse(MUL1);
+    static constexpr uintmax_t MUL2_INV = mul_inverse(MUL2);
+    static_assert(MUL1 * MUL1_INV == 1 && MUL2 * MUL2_INV == 1);
+
+    size_t key_width_;
+    size_t address_bits_;
+    uintmax_t key_mask_;
+    size_t address_mask_;
+    size_t size_;
+    PackedIntVector<Pack> slots_;
+
+    size_t shift() const { return (key_width_ + 1) / 2; }
+
+    uintmax_t hash(uintmax_t x) const {
+        // multiplication by an odd constant and xorshift by at least half the key width are both invertible modulo 2^u
+        x = (x * MUL1) & key_mask_;
+        x ^= x >> shift();
+        x = (x * MUL2) & key_mask_;
+        x ^= x >> shift();
+        return x;
+    }
+
+    uintmax_t unhash(uintmax_t x) const {
+        x ^= x >> shift();
+        x = (x * MUL2_INV) & key_mask_;
+        x ^= x >> shift();
+        x = (x * MUL1_INV) & key_mask_;
+        return x;
+    }
+
+    size_t next(size_t const i) const { return (i + 1) & address_mask_; }
+    size_t prev(size_t const i) const { return (i - 1) & address_mask_; }
+
+    uintmax_t meta(size_t const i) const { return slots_.get(i) & META_MASK; }
+
+    // finds the slot where the run of keys with the given (occupied) home slot starts
+    size_t find_run_start(size_t const a) const {
+        // walk back to the beginning of the cluster
+        size_t b = a;
+        while(meta(b) & SHIFTED) b = prev(b);
+
+        // walk forward, skipping one run for each occupied home slot before a
+        size_t s = b;
+        while(b != a) {
+            do { s = next(s); } while(meta(s) & CONTINUATION);
+            do { b = next(b); } while(!(meta(b) & OCCUPIED));
+        }
+        return s;
+    }
+
+    bool contains_hashed(uintmax_t const h) const {
+        size_t const a = h & address_mask_;
+        uintmax_t const q = h >> address_bits_;
+        if(!(meta(a) & OCCUPIED)) return false;
+
+        size_t s = find_run_start(a);
+        do {
+            uintmax_t const x = slots_.get(s);
+            if((x >> META_BITS) == q) return true;
+            s = next(s);
+        } while(meta(s) & CONTINUATION);
+        return false;
+    }
+
+    void insert_hashed(uintmax_t const h) {
+        size_t const a = h & address_mask_;
+        uintmax_t const q = h >> address_bits_;
+
+        uintmax_t const xa = slots_.get(a);
+        if((xa & META_MASK) == 0) {
+            // the home slot is empty
+            slots_.set(a, (q << META_BITS) | OCCUPIED);
+            return;
+        }
+
+        bool const was_occupied = xa & OCCUPIED;
+        slots_.set(a, xa | OCCUPIED);
+
+        size_t s = find_run_start(a);
+        uintmax_t entry = (q << META_BITS);
+        if(was_occupied) {
+            // append to the existing run
+            do { s = next(s); } while(meta(s) & CONTINUATION);
+            entry |= CONTINUATION;
+        }
+        if(s != a) entry |= SHIFTED;
+
+        // shift the following entries to the right until an empty slot is found
+        while(true) {
+            uintmax_t const x = slots_.get(s);
+            slots_.set(s, entry | (x & OCCUPIED)); // nb: the occupied bit belongs to the slot, not the entry
+            if((x & META_MASK) == 0) break;
+
+            entry = (x & ~OCCUPIED) | SHIFTED;
+            s = next(s);
+        }
+    }
+
+    void allocate(size_t const address_bits) {
+        address_bits_ = address_bits;
+        address_mask_ = internal::low_mask0(address_bits_);
+
+        size_t const capacity = size_t(1) << address_bits_;
+        slots_ = PackedIntVector<Pack>(capacity, META_BITS + key_width_ - address_bits_);
+        std::fill(slots_.data(), slots_.data() + num_packs_required<Pack>(capacity, slots_.width()), Pack(0));
+    }
+
+    void grow() {
+        CompactHashSet larger(key_width_, capacity() * 2);
+        for_each([&](uintmax_t const key){ larger.insert_hashed(larger.hash(key)); });
+        larger.size_ = size_;
+        *this = std::move(larger);
+    }
+
+public:
+    /**
+     * \brief Constructs an empty hash set
+     *
+     * \param key_width the width, in bits, of the keys
+     * \param capacity the initial number of slots, rounded up to the next power of two
+     */
+    CompactHashSet(size_t const key_width, size_t const capacity = 1024) : key_width_(key_width), key_mask_(internal::low_mask(key_width)), size_(0) {
+        assert(key_width_ > 0);
+        assert(key_width_ <= std::numeric_limits<uintmax_t>::digits);
+        size_t const min_address_bits = (META_BITS + key_width_ > PACK_BITS) ? META_BITS + key_width_ - PACK_BITS : 0;
+        allocate(std::min(key_width_, std::max(min_address_bits, (size_t)std::bit_width(std::max(capacity, size_t(2)) - 1))));
+        assert(slots_.width() <= PACK_BITS);
+    }
+
+    /**
+     * \brief Inserts a key into the set
+     *
+     * \param key the key to insert, which must fit into the key width
+     * \return true if the key has been inserted
+     * \return false if the key was already contained in the set
+     */
+    bool insert(uintmax_t const key) {
+        assert(key <= key_mask_);
+
+        uintmax_t const h = hash(key);
+        if(contains_hashed(h)) return false;
+
+        if(address_bits_ < key_width_ && (size_ + 1) * 10 > capacity() * 9) {
+            grow();
+            insert_hashed(hash(key));
+        } else {
+            insert_hashed(h);
+        }
+        ++size_;
+        return true;
+    }
+
+    /**
+     * \brief Tests whether a key is contained in the set
+     *
+     * \param key the key in question
+     * \return true if the key is contained in the set
+     * \return false otherwise
+     */
+    bool contains(uintmax_t const key) const {
+        return key <= key_mask_ && contains_hashed(hash(key));
+    }
+
+    /**
+     * \brief Tests whether the given keys are contained in the set
+     *
+     * The home slots of upcoming keys are prefetched while the current key is being looked up.
+     * Each key is hashed only once, the hash values of the upcoming keys are buffered.
+     *
+     * \param keys the keys in question
+     * \param num the number of keys
+     * \param out the output array, receiving for each key whether it is contained in the set
+     */
+    void contains_many(uintmax_t const* keys, size_t const num, bool* out) const {
+        constexpr size_t LOOKAHEAD = 16;
+        size_t const width = slots_.width();
+
+        uintmax_t hashes[LOOKAHEAD];
+        auto prefetch = [&](size_t const i){
+            uintmax_t const h = hash(keys[i]);
+            hashes[i % LOOKAHEAD] = h;
+            __builtin_prefetch(slots_.data() + ((h & address_mask_) * width) / PACK_BITS);
+        };
+
+        for(size_t i = 0; i < std::min(num, LOOKAHEAD); i++) prefetch(i);
+        for(size_t i = 0; i < num; i++) {
+            uintmax_t const h = hashes[i % LOOKAHEAD];
+            if(i + LOOKAHEAD < num) prefetch(i + LOOKAHEAD);
+            out[i] = keys[i] <= key_mask_ && contains_hashed(h);
+        }
+    }
+
+    /**
+     * \brief Calls the given function for each key in the set
+     *
+     * The keys are reported in no particular order.
+     *
+     * \tparam F the function type
+     * \param f the function to call for each key
+     */
+    template<typename F>
+    void for_each(F f) const {
+        if(size_ == 0) return;
+
+        // start at an entry that is located in its home slot, which begins a cluster
+        size_t start = 0;
+        while((meta(start) & (OCCUPIED | SHIFTED)) != OCCUPIED) ++start;
+
+        // walk through the table, keeping a queue of home slots whose runs have not been reached yet
+        std::deque<size_t> homes;
+        size_t home = 0;
+        size_t s = start;
+        do {
+            uintmax_t const x = slots_.get(s);
+            if(x & OCCUPIED) homes.push_back(s);
+            if(x & META_MASK) {
+                if(!(x & CONTINUATION)) {
+                    home = homes.front();
+                    homes.pop_front();
+                }
+                f(unhash(((x >> META_BITS) << address_bits_) | home));
+            }
+            s = next(s);
+        } while(s != start);
+    }
+
+    /**
+     * \brief Reports the width of the keys
+     *
+     * \return the width, in bits, of the keys
+     */
+    size_t key_width() const { return key_width_; }
+
+    /**
+     * \brief Reports the number of bits stored per slot
+     *
+     * \return the number of bits stored per slot
+     */
+    size_t slot_width() const { return slots_.width(); }
+
+    /**
+     * \brief Reports the number of slots in the table
+     *
+     * \return the number of slots in the table
+     */
+    size_t capacity() const { return slots_.size(); }
+
+    /**
+     * \brief Reports the number of keys in the set
+     *
+     * \return the number of keys in the set
+     */
+    size_t size() const { return size_; }
+
+    /**
+     * \brief Tests whether the set is empty
+     *
+     * \return true if the set contains no keys
+     * \return false otherwise
+     */
+    bool empty() const { return size_ == 0; }
+
+    /**
+     * \brief Reports the number of heap bytes used by the set
+     *
+     * This includes the empty slots.
+     *
+     * \return the number of heap bytes used
+     */
+    size_t memory_usage() const { return slots_.memory_usage(); }
+};
+
+}
+
+#endif
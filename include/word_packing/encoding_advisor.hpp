@@ -0,0 +1,407 @@
+/**
+ * word_packing/encoding_advisor.hpp
+ * part of pdinklag/word-packing
+ * 
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _WORD_PACKING_ENCODING_ADVISOR_HPP
+#define _WORD_PACKING_ENCODING_ADVISOR_HPP
+
+#include "internal/parallel.hpp"
+#include "packed_fixed_width_int_vector.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+namespace word_packing {
+
+/**
+ * \brief Encodings considered by the encoding advisor
+ */
+enum class Encoding {
+    PLAIN,      ///< all integers packed at the maximum width (\see PackedIntVector)
+    FOR,        ///< frame of reference: blocks packed at the width of their range, relative to their minimum
+    PFOR,       ///< patched frame of reference: integers packed at a reduced width, with exceptions stored separately
+    DICTIONARY, ///< distinct integers stored once, integers replaced by their rank in the dictionary
+    RLE,        ///< run-length encoding: runs of equal integers stored as value and length
+    ELIAS_FANO, ///< Elias-Fano coding of a non-decreasing sequence
+    DELTA,      ///< blocks of differences between neighbouring integers, packed at the width of their largest difference
+    NUM_ENCODINGS
+};
+
+/**
+ * \brief Reports the name of an encoding
+ *
+ * \param e the encoding
+ * \return the name of the encoding
+ */
+constexpr std::string_view encoding_name(Encoding const e) {
+    constexpr std::string_view NAMES[] = { "plain", "for", "pfor", "dictionary", "rle", "elias_fano", "delta" };
+    return NAMES[size_t(e)];
+}
+
+/**
+ * \brief The estimated space and decoding cost of an encoding
+ */
+struct EncodingEstimate {
+    Encoding encoding;        ///< the encoding
+    bool applicable;          ///< whether the encoding can represent the analyzed integers
+    double bits_per_element;  ///< the estimated number of bits per integer
+    double decode_cost;       ///< the estimated cost of decoding an integer sequentially, relative to plain packing
+};
+
+/**
+ * \brief Statistics of a sequence of integers gathered by \ref analyze
+ */
+struct DataAnalysis {
+    /**
+     * \brief The number of integers per block for the block-based encodings (FOR and delta)
+     */
+    static constexpr size_t BLOCK_SIZE = 128;
+
+    /**
+     * \brief The number of bits stored in the header of a block, i.e., a reference integer and a width
+     */
+    static constexpr size_t BLOCK_HEADER_BITS = 64 + 8;
+
+    size_t size = 0;                 ///< the number of integers
+    uintmax_t min = 0;               ///< the smallest integer
+    uintmax_t max = 0;               ///< the largest integer
+    size_t max_width = 0;            ///< the number of bits required to represent the largest integer
+    size_t distinct = 0;             ///< the estimated number of distinct integers
+    size_t runs = 0;                 ///< the number of maximal runs of equal integers
+    size_t non_decreasing_pairs = 0; ///< the number of neighbouring pairs that are in non-decreasing order
+    size_t max_delta_width = 0;      ///< the number of bits required to represent the largest zigzag-encoded difference between neighbours
+    size_t for_block_bits = 0;       ///< the number of payload bits of all FOR blocks
+    size_t delta_block_bits = 0;     ///< the number of payload bits of all delta blocks
+    std::array<size_t, 65> width_histogram = {}; ///< the number of integers per bit width
+    std::array<size_t, 65> delta_histogram = {}; ///< the number of zigzag-encoded differences between neighbours per bit width
+
+    /**
+     * \brief Reports the fraction of neighbouring pairs that are in non-decreasing order
+     *
+     * \return the sortedness, one for sorted sequences
+     */
+    double sortedness() const { return size > 1 ? double(non_decreasing_pairs) / double(size - 1) : 1.0; }
+
+    /**
+     * \brief Tests whether the integers are in non-decreasing order
+     *
+     * \return true if the integers are sorted
+     * \return false otherwise
+     */
+    bool sorted() const { return size <= 1 || non_decreasing_pairs == size - 1; }
+
+    /**
+     * \brief Finds the width for patched frame of reference that minimizes the total number of bits
+     *
+     * Each exception is stored separately with its position and its full value.
+     *
+     * \return the width for the integers that are not exceptions
+     */
+    size_t pfor_width() const {
+        size_t const exception_bits = std::bit_width(size) + max_width;
+        size_t best = max_width, best_bits = size * max_width;
+        size_t exceptions = 0;
+        for(size_t b = max_width; b-- > 0;) {
+            exceptions += width_histogram[b + 1];
+            size_t const bits = size * b + exceptions * exception_bits;
+            if(bits < best_bits) {
+                best = b;
+                best_bits = bits;
+            }
+        }
+        return best;
+    }
+
+    /**
+     * \brief Estimates the space and decoding cost of an encoding
+     *
+     * The decoding costs are rough relative figures: plain packing costs one, patching, dictionary lookups,
+     * prefix sums and the upper-bit scans of Elias-Fano add to that, whereas long runs are cheaper to decode.
+     *
+     * \param e the encoding
+     * \return the estimate
+     */
+    EncodingEstimate estimate(Encoding const e) const {
+        double const n = double(std::max(size, size_t(1)));
+        size_t const num_blocks = internal::idiv_ceil(size, BLOCK_SIZE);
+        size_t const w = std::max(max_width, size_t(1));
+
+        switch(e) {
+            case Encoding::PLAIN:
+                return { e, true, double(w), 1.0 };
+
+            case Encoding::FOR:
+                return { e, true, double(for_block_bits + num_blocks * BLOCK_HEADER_BITS) / n, 1.25 };
+
+            case Encoding::PFOR: {
+                size_t const b = pfor_width();
+                size_t exceptions = 0;
+                for(size_t k = b + 1; k <= 64; k++) exceptions += width_histogram[k];
+                double const bits = double(size * b + exceptions * (std::bit_width(size) + max_width) + 8) / n;
+                return { e, true, bits, 1.5 + 4.0 * double(exceptions) / n };
+            }
+
+            case Encoding::DICTIONARY: {
+                size_t const d = std::max(distinct, size_t(1));
+                return { e, true, double(std::bit_width(d - 1)) + double(d * w) / n, 2.0 };
+            }
+
+            case Encoding::RLE: {
+                size_t const length_width = std::max(size_t(std::bit_width(size)), size_t(1));
+                return { e, true, double(runs * (w + length_width)) / n, 0.5 + 2.0 * double(runs) / n };
+            }
+
+            case Encoding::ELIAS_FANO: {
+                // the universe is shifted by the minimum
+                uintmax_t const u = max - min + 1;
+                size_t const low = (size && u > size) ? std::bit_width(u / size) - 1 : 0;
+                return { e, sorted(), double(low) + 2.0, 2.0 };
+            }
+
+            case Encoding::DELTA:
+                return { e, true, double(delta_block_bits + num_blocks * BLOCK_HEADER_BITS) / n, 1.5 };
+
+            default:
+                return { e, false, 0.0, 0.0 };
+        }
+    }
+
+    /**
+     * \brief Estimates the space and decoding cost of all encodings
+     *
+     * \return the estimates, indexed by encoding
+     */
+    std::array<EncodingEstimate, size_t(Encoding::NUM_ENCODINGS)> estimates() const {
+        std::array<EncodingEstimate, size_t(Encoding::NUM_ENCODINGS)> r;
+        for(size_t k = 0; k < r.size(); k++) r[k] = estimate(Encoding(k));
+        return r;
+    }
+
+    /**
+     * \brief Picks the applicable encoding with the fewest bits per integer
+     *
+     * Ties are broken by the decoding cost.
+     *
+     * \param max_decode_cost only encodings with at most this decoding cost are considered
+     * \return the estimate of the best encoding, plain packing if no encoding qualifies or the sequence is empty
+     */
+    EncodingEstimate best(double const max_decode_cost = std::numeric_limits<double>::infinity()) const {
+        EncodingEstimate b = estimate(Encoding::PLAIN);
+        if(size == 0) return b;
+
+        for(auto const& x : estimates()) {
+            if(!x.applicable || x.decode_cost > max_decode_cost) continue;
+            if(x.bits_per_element < b.bits_per_element || (x.bits_per_element == b.bits_per_element && x.decode_cost < b.decode_cost)) b = x;
+        }
+        return b;
+    }
+
+    /**
+     * \brief Picks the encoding with the fewest bits per integer among the given candidates
+     *
+     * Ties are broken by the decoding cost. Encodings that are not applicable are skipped.
+     *
+     * \param candidates the encodings to consider
+     * \return the estimate of the best candidate, plain packing if no candidate qualifies or the sequence is empty
+     */
+    EncodingEstimate best_of(std::initializer_list<Encoding> const candidates) const {
+        EncodingEstimate b = estimate(Encoding::PLAIN);
+        if(size == 0) return b;
+
+        for(auto const e : candidates) {
+            auto const x = estimate(e);
+            if(!x.applicable) continue;
+            if(x.bits_per_element < b.bits_per_element || (x.bits_per_element == b.bits_per_element && x.decode_cost < b.decode_cost)) b = x;
+        }
+        return b;
+    }
+
+    /**
+     * \brief Prints the statistics and the estimates as key-value pairs in a single line
+     *
+     * \param out the output stream
+     * \param name the name to print along with the statistics
+     */
+    void print(std::ostream& out, std::string_view const name) const {
+        out << "ANALYSIS name=" << name <<
+            " size=" << size <<
+            " max_width=" << max_width <<
+            " distinct=" << distinct <<
+            " runs=" << runs <<
+            " sortedness=" << sortedness() <<
+            " max_delta_width=" << max_delta_width;
+        for(auto const& x : estimates()) {
+            if(x.applicable) out << " " << encoding_name(x.encoding) << "_bits=" << x.bits_per_element;
+        }
+        out << " best=" << encoding_name(best().encoding) << std::endl;
+    }
+};
+
+namespace internal {
+    // HyperLogLog sketch with 2^12 registers of 6 bits
+    class HyperLogLog {
+    private:
+        static constexpr size_t P = 12;
+        static constexpr size_t M = 1ULL << P;
+
+        PackedFixedWidthIntVector<6> registers_;
+
+    public:
+        HyperLogLog() : registers_(M) {
+            for(size_t j = 0; j < M; j++) registers_.set(j, 0);
+        }
+
+        void insert(uintmax_t const x) {
+            uint64_t const h = hash64(x);
+            size_t const j = h >> (64 - P);
+            size_t const rank = std::min(size_t(std::countl_zero(h << P)), 64 - P) + 1;
+            if(rank > registers_.get(j)) registers_.set(j, rank);
+        }
+
+        void merge(HyperLogLog const& other) {
+            for(size_t j = 0; j < M; j++) registers_.set(j, std::max(registers_.get(j), other.registers_.get(j)));
+        }
+
+        double estimate() const {
+            double sum = 0.0;
+            size_t zeros = 0;
+            for(size_t j = 0; j < M; j++) {
+                size_t const r = registers_.get(j);
+                sum += std::ldexp(1.0, -int(r));
+                zeros += (r == 0);
+            }
+
+            double const m = double(M);
+            double const e = (0.7213 / (1.0 + 1.079 / m)) * m * m / sum;
+            return (e <= 2.5 * m && zeros) ? m * std::log(m / double(zeros)) : e; // linear counting for small cardinalities
+        }
+    };
+
+    // the number of bits required to represent the zigzag-encoded difference between two integers, at most 64
+    inline size_t delta_width(uintmax_t const prev, uintmax_t const x) {
+        if(x == prev) return 0;
+        size_t const w = std::bit_width(x > prev ? x - prev : prev - x) + 1;
+        return std::min(w, size_t(64));
+    }
+}
+
+/**
+ * \brief Analyzes a sequence of integers to estimate the space and decoding cost of different encodings
+ *
+ * The sequence is scanned once, gathering the maximum width, an estimate of the number of distinct integers (using HyperLogLog),
+ * the number of runs, the sortedness and the widths of differences between neighbours, as well as the widths of FOR and delta blocks.
+ * The scan can be distributed over multiple threads, each analyzing a range of blocks.
+ *
+ * \tparam Sequence the sequence type, which must provide random access to integers via \c operator[] and report its \c size()
+ * \param seq the sequence to analyze
+ * \param num_threads the number of threads to use
+ * \return the analysis (\see DataAnalysis::estimate)
+ */
+template<typename Sequence>
+DataAnalysis analyze(Sequence const& seq, size_t const num_threads = 1) {
+    constexpr size_t BLOCK_SIZE = DataAnalysis::BLOCK_SIZE;
+
+    size_t const n = seq.size();
+    size_t const num_blocks = internal::idiv_ceil(n, BLOCK_SIZE);
+    size_t const num_tasks = std::max(std::min(num_threads, num_blocks), size_t(1));
+    size_t const blocks_per_task = internal::idiv_ceil(num_blocks, num_tasks);
+
+    std::vector<DataAnalysis> partial(num_tasks);
+    std::vector<internal::HyperLogLog> sketches(num_tasks);
+    internal::parallel_for(num_threads, num_tasks, [&](size_t const t){
+        auto& a = partial[t];
+        auto& hll = sketches[t];
+        a.min = UINTMAX_MAX;
+
+        size_t const begin = std::min(t * blocks_per_task * BLOCK_SIZE, n);
+        size_t const end = std::min(begin + blocks_per_task * BLOCK_SIZE, n);
+        uintmax_t prev = begin > 0 ? uintmax_t(seq[begin - 1]) : 0;
+        for(size_t b = begin; b < end; b += BLOCK_SIZE) {
+            uintmax_t block_min = UINTMAX_MAX, block_max = 0;
+            size_t block_delta_width = 0;
+            size_t const block_end = std::min(b + BLOCK_SIZE, end);
+            for(size_t i = b; i < block_end; i++) {
+                uintmax_t const x = seq[i];
+                a.min = std::min(a.min, x);
+                a.max = std::max(a.max, x);
+                block_min = std::min(block_min, x);
+                block_max = std::max(block_max, x);
+                ++a.width_histogram[std::bit_width(x)];
+                hll.insert(x);
+
+                if(i == 0 || x != prev) ++a.runs;
+                if(i > 0) {
+                    a.non_decreasing_pairs += (x >= prev);
+                    size_t const dw = internal::delta_width(prev, x);
+                    ++a.delta_histogram[dw];
+                    block_delta_width = std::max(block_delta_width, dw);
+                }
+                prev = x;
+            }
+            size_t const block_size = block_end - b;
+            a.for_block_bits += std::bit_width(block_max - block_min) * block_size;
+            a.delta_block_bits += block_delta_width * block_size;
+        }
+    });
+
+    DataAnalysis r;
+    r.size = n;
+    r.min = n ? UINTMAX_MAX : 0;
+    for(size_t t = 0; t < num_tasks; t++) {
+        auto const& a = partial[t];
+        r.min = std::min(r.min, a.min);
+        r.max = std::max(r.max, a.max);
+        r.runs += a.runs;
+        r.non_decreasing_pairs += a.non_decreasing_pairs;
+        r.for_block_bits += a.for_block_bits;
+        r.delta_block_bits += a.delta_block_bits;
+        for(size_t k = 0; k <= 64; k++) {
+            r.width_histogram[k] += a.width_histogram[k];
+            r.delta_histogram[k] += a.delta_histogram[k];
+        }
+        if(t > 0) sketches[0].merge(sketches[t]);
+    }
+    r.max_width = std::bit_width(r.max);
+    for(size_t k = 0; k <= 64; k++) {
+        if(r.delta_histogram[k]) r.max_delta_width = k;
+    }
+    r.distinct = std::min(size_t(std::llround(sketches[0].estimate())), n);
+    if(n) r.distinct = std::max(r.distinct, size_t(1));
+    return r;
+}
+
+}
+
+#endif
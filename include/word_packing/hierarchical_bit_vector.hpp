@@ -0,0 +1,280 @@
+/**
+ * word_packing/hierarchical_bit_vector.hpp
+ * part of pdinklag/word-packing
+ * 
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _WORD_PACKING_HIERARCHICAL_BIT_VECTOR_HPP
+#define _WORD_PACKING_HIERARCHICAL_BIT_VECTOR_HPP
+
+#include "internal/alloc.hpp"
+#include "packed_fixed_width_int_vector.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace word_packing {
+
+/**
+ * \brief Bit vector with fast successor and predecessor queries
+ *
+ * On top of the bits, this structure maintains a 64-ary tree of summary bit vectors:
+ * a bit in a summary level is set if and only if the corresponding word pack in the level below contains a set bit.
+ * Levels are added until a level fits into a single word pack.
+ * The successor or predecessor of a position is thus found by at most two word operations per level, i.e., in O(log_64 n) time,
+ * instead of scanning all word packs in between.
+ *
+ * The summaries are maintained incrementally by \ref set and \ref reset , which touch higher levels only if a word pack becomes empty or non-empty.
+ * They take 1/63 of the space of the bits.
+ */
+class HierarchicalBitVector {
+private:
+    using Bits = PackedFixedWidthIntVector<1>;
+    static constexpr size_t PACK_BITS = std::numeric_limits<uintmax_t>::digits;
+
+    size_t size_;
+    std::vector<Bits> levels_; // levels_[0] are the bits, the others are summaries
+
+    static Bits zero_bits(size_t const size) {
+        Bits bits(size);
+        std::fill(bits.data(), bits.data() + num_packs_required<uintmax_t>(size, 1), uintmax_t(0));
+        return bits;
+    }
+
+    uintmax_t& word(size_t const level, size_t const w) { return levels_[level].data()[w]; }
+    uintmax_t word(size_t const level, size_t const w) const { return levels_[level].data()[w]; }
+
+    // allocates the summary levels for the bits in level zero and computes them
+    void build_summaries() {
+        levels_.resize(1);
+        while(levels_.back().size() > PACK_BITS) {
+            size_t const num_packs = num_packs_required<uintmax_t>(levels_.back().size(), 1);
+            levels_.push_back(zero_bits(num_packs));
+
+            size_t const level = levels_.size() - 1;
+            for(size_t w = 0; w < num_packs; w++) {
+                if(word(level - 1, w)) word(level, w / PACK_BITS) |= uintmax_t(1) << (w % PACK_BITS);
+            }
+        }
+    }
+
+public:
+    /**
+     * \brief Constructs an empty bit vector
+     *
+     */
+    HierarchicalBitVector() : HierarchicalBitVector(0) {
+    }
+
+    /**
+     * \brief Constructs a bit vector of the given size with all bits unset
+     *
+     * \param size the number of bits
+     */
+    HierarchicalBitVector(size_t const size) : size_(size) {
+        levels_.push_back(zero_bits(size));
+        build_summaries();
+    }
+
+    /**
+     * \brief Constructs a bit vector containing a copy of the given bits
+     *
+     * \param bv the bits
+     */
+    HierarchicalBitVector(PackedFixedWidthIntVector<1> const& bv) : size_(bv.size()) {
+        levels_.push_back(zero_bits(size_));
+        size_t const num_packs = num_packs_required<uintmax_t>(size_, 1);
+        std::copy(bv.data(), bv.data() + num_packs, levels_[0].data());
+        if(size_ % PACK_BITS) word(0, num_packs - 1) &= internal::low_mask0(size_ % PACK_BITS); // ignore bits beyond the end
+        build_summaries();
+    }
+
+    /**
+     * \brief Retrieves a specific bit
+     *
+     * \param i the position of the bit
+     * \return the bit at the given position
+     */
+    bool get(size_t const i) const {
+        assert(i < size_);
+        return (word(0, i / PACK_BITS) >> (i % PACK_BITS)) & 1;
+    }
+
+    /**
+     * \brief Retrieves a specific bit
+     *
+     * This function simply forwards to \ref get .
+     *
+     * \param i the position of the bit
+     * \return the bit at the given position
+     */
+    bool operator[](size_t const i) const { return get(i); }
+
+    /**
+     * \brief Sets a specific bit
+     *
+     * The summaries are updated only if the word pack containing the bit was empty.
+     *
+     * \param i the position of the bit
+     */
+    void set(size_t i) {
+        assert(i < size_);
+        for(size_t level = 0; level < levels_.size(); level++) {
+            auto& x = word(level, i / PACK_BITS);
+            bool const was_empty = (x == 0);
+            x |= uintmax_t(1) << (i % PACK_BITS);
+            if(!was_empty) break;
+            i /= PACK_BITS;
+        }
+    }
+
+    /**
+     * \brief Unsets a specific bit
+     *
+     * The summaries are updated only if the word pack containing the bit becomes empty.
+     *
+     * \param i the position of the bit
+     */
+    void reset(size_t i) {
+        assert(i < size_);
+        for(size_t level = 0; level < levels_.size(); level++) {
+            auto& x = word(level, i / PACK_BITS);
+            x &= ~(uintmax_t(1) << (i % PACK_BITS));
+            if(x != 0) break;
+            i /= PACK_BITS;
+        }
+    }
+
+    /**
+     * \brief Finds the first set bit at or after the given position
+     *
+     * \param i the position to start from
+     * \return the position of the first set bit at or after the given position, or \ref size if there is none
+     */
+    size_t next_set(size_t i) const {
+        if(i >= size_) return size_;
+
+        // ascend until a word pack contains a set bit at or after the current position
+        size_t level = 0;
+        uintmax_t x;
+        while(true) {
+            x = word(level, i / PACK_BITS) & (UINTMAX_MAX << (i % PACK_BITS));
+            if(x) break;
+
+            i = i / PACK_BITS + 1;
+            if(++level == levels_.size() || i >= levels_[level].size()) return size_;
+        }
+
+        // descend to the first set bit
+        i = (i / PACK_BITS) * PACK_BITS + std::countr_zero(x);
+        while(level-- > 0) i = i * PACK_BITS + std::countr_zero(word(level, i));
+        return i;
+    }
+
+    /**
+     * \brief Finds the last set bit at or before the given position
+     *
+     * \param i the position to start from
+     * \return the position of the last set bit at or before the given position, or \ref size if there is none
+     */
+    size_t prev_set(size_t i) const {
+        if(size_ == 0) return size_;
+        i = std::min(i, size_ - 1);
+
+        // ascend until a word pack contains a set bit at or before the current position
+        size_t level = 0;
+        uintmax_t x;
+        while(true) {
+            x = word(level, i / PACK_BITS) & (UINTMAX_MAX >> (PACK_BITS - 1 - i % PACK_BITS));
+            if(x) break;
+
+            if(i < PACK_BITS) return size_;
+            i = i / PACK_BITS - 1;
+            if(++level == levels_.size()) return size_;
+        }
+
+        // descend to the last set bit
+        i = (i / PACK_BITS) * PACK_BITS + (PACK_BITS - 1 - std::countl_zero(x));
+        while(level-- > 0) i = i * PACK_BITS + (PACK_BITS - 1 - std::countl_zero(word(level, i)));
+        return i;
+    }
+
+    /**
+     * \brief Finds the first set bit
+     *
+     * \return the position of the first set bit, or \ref size if there is none
+     */
+    size_t first_set() const { return next_set(0); }
+
+    /**
+     * \brief Finds the last set bit
+     *
+     * \return the position of the last set bit, or \ref size if there is none
+     */
+    size_t last_set() const { return prev_set(size_); }
+
+    /**
+     * \brief Tests whether any bit is set
+     *
+     * \return true if at least one bit is set
+     * \return false otherwise
+     */
+    bool any() const { return size_ > 0 && word(levels_.size() - 1, 0) != 0; }
+
+    /**
+     * \brief Provides read access to the bits
+     *
+     * \return the bits
+     */
+    PackedFixedWidthIntVector<1> const& bits() const { return levels_[0]; }
+
+    /**
+     * \brief Reports the number of bits
+     *
+     * \return the number of bits
+     */
+    size_t size() const { return size_; }
+
+    /**
+     * \brief Reports the number of summary levels
+     *
+     * \return the number of summary levels above the bits
+     */
+    size_t num_summary_levels() const { return levels_.size() - 1; }
+
+    /**
+     * \brief Reports the number of heap bytes used by the structure
+     *
+     * \return the number of heap bytes used, including the bits
+     */
+    size_t memory_usage() const { return internal::memory_usage(levels_); }
+};
+
+}
+
+#endif
@@ -0,0 +1,91 @@
+/**
+ * word_packing/internal/alloc.hpp
+ * part of pdinklag/word-packing
+ * 
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _WORD_PACKING_INTERNAL_ALLOC_HPP
+#define _WORD_PACKING_INTERNAL_ALLOC_HPP
+
+#include "../memory.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace word_packing::internal {
+
+/**
+ * \brief Array deleter that reports the freed memory to the counter that observed the allocation, if any
+ *
+ * \tparam T the array element type
+ */
+template<typename T>
+struct CountedDelete {
+    AllocationCounter* counter = nullptr;
+    size_t bytes = 0;
+
+    void operator()(T* const p) const {
+        if(counter) counter->freed(bytes);
+        delete[] p;
+    }
+};
+
+template<typename T>
+using CountedArray = std::unique_ptr<T[], CountedDelete<T>>;
+
+/**
+ * \brief Allocates a value-initialized array and reports it to the global allocation counter, if any
+ *
+ * \tparam T the array element type
+ * \param num the number of array elements
+ * \return the allocated array
+ */
+template<typename T>
+CountedArray<T> make_counted_array(size_t const num) {
+    AllocationCounter* const counter = allocation_counter();
+    size_t const bytes = num * sizeof(T);
+    CountedArray<T> p(new T[num](), CountedDelete<T> { counter, bytes });
+    if(counter) counter->allocated(bytes);
+    return p;
+}
+
+/**
+ * \brief Computes the heap bytes used by a vector, including those used by its elements if they report their memory usage
+ *
+ * \tparam T the element type
+ * \param v the vector
+ * \return the number of heap bytes used
+ */
+template<typename T>
+size_t memory_usage(std::vector<T> const& v) {
+    size_t bytes = v.capacity() * sizeof(T);
+    if constexpr(requires(T const& x) { x.memory_usage(); }) {
+        for(auto const& x : v) bytes += x.memory_usage();
+    }
+    return bytes;
+}
+
+}
+
+#endif
@@ -0,0 +1,133 @@
+/**
+ * word_packing/internal/bit_ranges.hpp
+ * part of pdinklag/word-packing
+ * 
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _WORD_PACKING_INTERNAL_BIT_RANGES_HPP
+#define _WORD_PACKING_INTERNAL_BIT_RANGES_HPP
+
+#include "../util.hpp"
+
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+
+/**
+ * \brief Operations on ranges of packed bits at word pack granularity
+ *
+ * The partial word packs at the borders of a range are handled using masks obtained from the bit order,
+ * the word packs in between are processed as a whole.
+ */
+namespace word_packing::internal {
+
+/**
+ * \brief Sets or unsets all bits in a range
+ *
+ * \tparam BitOrder the bit order (\see word_packing::bit_order)
+ * \tparam Pack the word pack type
+ * \param data the array of word packs
+ * \param l the first bit position of the range
+ * \param r the bit position right beyond the range
+ * \param value true to set the bits, false to unset them
+ */
+template<typename BitOrder, WordPackEligible Pack>
+void fill_bit_range(Pack* data, size_t const l, size_t const r, bool const value) {
+    constexpr size_t PACK_BITS = std::numeric_limits<Pack>::digits;
+    if(l >= r) return;
+
+    size_t const a = l / PACK_BITS;
+    size_t const b = (r - 1) / PACK_BITS;
+    size_t const lo = l % PACK_BITS;
+    size_t const hi = (r - 1) % PACK_BITS + 1;
+
+    auto apply = [&](Pack& x, Pack const m){ x = value ? Pack(x | m) : Pack(x & ~m); };
+    if(a == b) {
+        apply(data[a], BitOrder::template range_mask<Pack>(lo, hi));
+    } else {
+        apply(data[a], BitOrder::template range_mask<Pack>(lo, PACK_BITS));
+        std::memset(data + a + 1, value ? 0xFF : 0x00, (b - a - 1) * sizeof(Pack));
+        apply(data[b], BitOrder::template range_mask<Pack>(0, hi));
+    }
+}
+
+/**
+ * \brief Flips all bits in a range
+ *
+ * \tparam BitOrder the bit order (\see word_packing::bit_order)
+ * \tparam Pack the word pack type
+ * \param data the array of word packs
+ * \param l the first bit position of the range
+ * \param r the bit position right beyond the range
+ */
+template<typename BitOrder, WordPackEligible Pack>
+void flip_bit_range(Pack* data, size_t const l, size_t const r) {
+    constexpr size_t PACK_BITS = std::numeric_limits<Pack>::digits;
+    if(l >= r) return;
+
+    size_t const a = l / PACK_BITS;
+    size_t const b = (r - 1) / PACK_BITS;
+    size_t const lo = l % PACK_BITS;
+    size_t const hi = (r - 1) % PACK_BITS + 1;
+
+    if(a == b) {
+        data[a] ^= BitOrder::template range_mask<Pack>(lo, hi);
+    } else {
+        data[a] ^= BitOrder::template range_mask<Pack>(lo, PACK_BITS);
+        for(size_t p = a + 1; p < b; p++) data[p] = Pack(~data[p]);
+        data[b] ^= BitOrder::template range_mask<Pack>(0, hi);
+    }
+}
+
+/**
+ * \brief Counts the set bits in a range
+ *
+ * \tparam BitOrder the bit order (\see word_packing::bit_order)
+ * \tparam Pack the word pack type
+ * \param data the array of word packs
+ * \param l the first bit position of the range
+ * \param r the bit position right beyond the range
+ * \return the number of set bits in the range
+ */
+template<typename BitOrder, WordPackEligible Pack>
+size_t count_bit_range(Pack const* data, size_t const l, size_t const r) {
+    constexpr size_t PACK_BITS = std::numeric_limits<Pack>::digits;
+    if(l >= r) return 0;
+
+    size_t const a = l / PACK_BITS;
+    size_t const b = (r - 1) / PACK_BITS;
+    size_t const lo = l % PACK_BITS;
+    size_t const hi = (r - 1) % PACK_BITS + 1;
+
+    if(a == b) return std::popcount(Pack(data[a] & BitOrder::template range_mask<Pack>(lo, hi)));
+
+    size_t ones = std::popcount(Pack(data[a] & BitOrder::template range_mask<Pack>(lo, PACK_BITS)));
+    for(size_t p = a + 1; p < b; p++) ones += std::popcount(data[p]);
+    return ones + std::popcount(Pack(data[b] & BitOrder::template range_mask<Pack>(0, hi)));
+}
+
+}
+
+#endif
@@ -0,0 +1,221 @@
+/**
+ * word_packing/internal/bit_stream.hpp
+ * part of pdinklag/word-packing
+ * 
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _WORD_PACKING_INTERNAL_BIT_STREAM_HPP
+#define _WORD_PACKING_INTERNAL_BIT_STREAM_HPP
+
+#include "impl.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <vector>
+
+namespace word_packing::internal {
+
+/**
+ * \brief Reads an unsigned LEB128 encoded integer from a byte stream
+ * 
+ * \param p the current position in the stream, advanced past the integer
+ * \param end the end of the stream
+ * \param x receives the decoded integer
+ * \return true if an integer was read
+ * \return false if the stream ended prematurely or the encoding exceeds 64 bits
+ */
+inline bool read_uleb128(uint8_t const*& p, uint8_t const* end, uint64_t& x) {
+    x = 0;
+    for(size_t shift = 0; shift < 64; shift += 7) {
+        if(p == end) return false;
+        uint8_t const b = *p++;
+        x |= uint64_t(b & 0x7F) << shift;
+        if(!(b & 0x80)) return true;
+    }
+    return false;
+}
+
+/**
+ * \brief Appends an unsigned LEB128 encoded integer to a byte stream
+ * 
+ * \param out the byte stream
+ * \param x the integer to encode
+ */
+inline void write_uleb128(std::vector<uint8_t>& out, uint64_t x) {
+    while(x >= 0x80) {
+        out.push_back(uint8_t(x) | 0x80);
+        x >>= 7;
+    }
+    out.push_back(uint8_t(x));
+}
+
+/**
+ * \brief Reads bits from a byte stream in which bits are ordered starting from the least significant bit of each byte
+ * 
+ * \param bytes the byte stream
+ * \param num_bytes the number of bytes in the stream, which must not be exceeded
+ * \param pos the position of the first bit to read
+ * \param n the number of bits to read, at most 64
+ * \return the read bits, the first of which is the least significant
+ */
+inline uint64_t load_bits_lsb(uint8_t const* bytes, size_t const num_bytes, size_t const pos, size_t const n) {
+    if(n == 0) return 0;
+
+    size_t const b = pos / 8;
+    size_t const s = pos % 8;
+    size_t const nb = (pos + n - 1) / 8 - b + 1; // number of bytes touched, at most 9
+    assert(b + nb <= num_bytes);
+
+    uint64_t x = 0;
+    if(std::endian::native == std::endian::little && b + 8 <= num_bytes) {
+        std::memcpy(&x, bytes + b, 8);
+    } else {
+        for(size_t j = 0; j < std::min(nb, size_t(8)); j++) x |= uint64_t(bytes[b + j]) << (8 * j);
+    }
+    x >>= s;
+    if(nb > 8) x |= uint64_t(bytes[b + 8]) << (64 - s); // nb: s > 0 holds here
+    return x & low_mask(n);
+}
+
+/**
+ * \brief Reads bits from a byte stream in which bits are ordered starting from the most significant bit of each byte
+ * 
+ * \param bytes the byte stream
+ * \param num_bytes the number of bytes in the stream, which must not be exceeded
+ * \param pos the position of the first bit to read
+ * \param n the number of bits to read, at most 64
+ * \return the read bits, the first of which is the most significant
+ */
+inline uint64_t load_bits_msb(uint8_t const* bytes, [[maybe_unused]] size_t const num_bytes, size_t const pos, size_t const n) {
+    if(n == 0) return 0;
+
+    size_t const b = pos / 8;
+    size_t const s = pos % 8;
+    size_t const nb = (pos + n - 1) / 8 - b + 1; // number of bytes touched, at most 9
+    assert(b + nb <= num_bytes);
+
+    uint64_t x = 0;
+    for(size_t j = 0; j < std::min(nb, size_t(8)); j++) x = (x << 8) | bytes[b + j];
+    if(nb <= 8) {
+        return (x >> (8 * nb - s - n)) & low_mask(n);
+    } else {
+        x = (x << s) | (bytes[b + 8] >> (8 - s)); // nb: s > 0 holds here
+        return x >> (64 - n);
+    }
+}
+
+/**
+ * \brief Writes bits into a zero-initialized byte stream in which bits are ordered starting from the least significant bit of each byte
+ * 
+ * \param bytes the byte stream
+ * \param pos the position of the first bit to write
+ * \param n the number of bits to write, at most 64
+ * \param x the bits to write, the first of which is the least significant
+ */
+inline void store_bits_lsb(uint8_t* bytes, size_t const pos, size_t const n, uint64_t const x) {
+    for(size_t k = 0; k < n;) {
+        size_t const s = (pos + k) % 8;
+        size_t const take = std::min(8 - s, n - k);
+        bytes[(pos + k) / 8] |= uint8_t(((x >> k) & low_mask(take)) << s);
+        k += take;
+    }
+}
+
+/**
+ * \brief Writes bits into a zero-initialized byte stream in which bits are ordered starting from the most significant bit of each byte
+ * 
+ * \param bytes the byte stream
+ * \param pos the position of the first bit to write
+ * \param n the number of bits to write, at most 64
+ * \param x the bits to write, the first of which is the most significant
+ */
+inline void store_bits_msb(uint8_t* bytes, size_t const pos, size_t const n, uint64_t const x) {
+    for(size_t k = 0; k < n;) {
+        size_t const s = (pos + k) % 8;
+        size_t const take = std::min(8 - s, n - k);
+        uint64_t const bits = (x >> (n - k - take)) & low_mask(take);
+        bytes[(pos + k) / 8] |= uint8_t(bits << (8 - s - take));
+        k += take;
+    }
+}
+
+/**
+ * \brief Copies bits from a byte stream into an array of word packs
+ * 
+ * The bits in the byte stream are ordered starting from the least significant bit of each byte, which is the same order as in word packs.
+ * On little-endian machines, if the target position is byte-aligned, the bytes are copied directly.
+ * 
+ * \tparam Pack the word pack type
+ * \param dst the array of word packs
+ * \param dst_off the position of the first bit to write in the word packs
+ * \param src the byte stream
+ * \param nbits the number of bits to copy
+ */
+template<WordPackEligible Pack>
+inline void copy_bits_from_bytes(Pack* dst, size_t const dst_off, uint8_t const* src, size_t const nbits) {
+    constexpr size_t PACK_BITS = std::numeric_limits<Pack>::digits;
+    size_t const num_bytes = idiv_ceil(nbits, 8);
+
+    if(std::endian::native == std::endian::little && dst_off % 8 == 0) {
+        size_t const full = nbits / 8;
+        std::memcpy(reinterpret_cast<uint8_t*>(dst) + dst_off / 8, src, full);
+        if(nbits % 8) set_bits(dst, dst_off + 8 * full, nbits % 8, src[full]);
+    } else {
+        for(size_t k = 0; k < nbits; k += PACK_BITS) {
+            size_t const n = std::min(PACK_BITS, nbits - k);
+            set_bits(dst, dst_off + k, n, load_bits_lsb(src, num_bytes, k, n));
+        }
+    }
+}
+
+/**
+ * \brief Copies bits from an array of word packs into a byte stream
+ * 
+ * The bits in the byte stream are ordered starting from the least significant bit of each byte, which is the same order as in word packs.
+ * Any unused bits in the final byte are set to zero.
+ * On little-endian machines, if the source position is byte-aligned, the bytes are copied directly.
+ * 
+ * \tparam Pack the word pack type
+ * \param dst the byte stream, which must have room for the required number of bytes
+ * \param src the array of word packs
+ * \param src_off the position of the first bit to read in the word packs
+ * \param nbits the number of bits to copy
+ */
+template<WordPackEligible Pack>
+inline void copy_bits_to_bytes(uint8_t* dst, Pack const* src, size_t const src_off, size_t const nbits) {
+    if(std::endian::native == std::endian::little && src_off % 8 == 0) {
+        size_t const full = nbits / 8;
+        std::memcpy(dst, reinterpret_cast<uint8_t const*>(src) + src_off / 8, full);
+        if(nbits % 8) dst[full] = get_bits(src, src_off + 8 * full, nbits % 8);
+    } else {
+        for(size_t k = 0; k < nbits; k += 8) {
+            dst[k / 8] = get_bits(src, src_off + k, std::min(size_t(8), nbits - k));
+        }
+    }
+}
+
+}
+
+#endif
@@ -0,0 +1,50 @@
+/**
+ * word_packing/internal/bitwise.hpp
+ * part of pdinklag/word-packing
+ * 
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _WORD_PACKING_INTERNAL_BITWISE_HPP
+#define _WORD_PACKING_INTERNAL_BITWISE_HPP
+
+#include "../util.hpp"
+
+namespace word_packing::internal {
+
+/**
+ * \brief Computes the bitwise OR of two arrays of packs, storing the result in the first
+ *
+ * \tparam Pack the word pack type
+ * \param dst the destination array
+ * \param src the source array
+ * \param num the number of packs
+ */
+template<WordPackEligible Pack>
+inline void pack_or(Pack* dst, Pack const* src, size_t const num) {
+    for(size_t i = 0; i < num; i++) dst[i] |= src[i];
+}
+
+}
+
+#endif
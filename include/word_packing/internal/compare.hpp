@@ -0,0 +1,138 @@
+/**
+ * word_packing/internal/compare.hpp
+ * part of pdinklag/word-packing
+ * 
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _WORD_PACKING_INTERNAL_COMPARE_HPP
+#define _WORD_PACKING_INTERNAL_COMPARE_HPP
+
+#include "util.hpp"
+
+#include <algorithm>
+#include <compare>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+namespace word_packing::internal {
+
+// the multiply-mix function and constants of wyhash
+constexpr uint64_t WYP0 = 0xa0761d6478bd642fULL;
+constexpr uint64_t WYP1 = 0xe7037ed1a0b428dbULL;
+constexpr uint64_t WYP2 = 0x8ebc6af09c88c6e3ULL;
+
+inline uint64_t wymix(uint64_t const a, uint64_t const b) {
+    __uint128_t const r = __uint128_t(a) * b;
+    return uint64_t(r) ^ uint64_t(r >> 64);
+}
+
+// the word pack type of a container
+template<typename C>
+using pack_of = std::remove_cv_t<std::remove_pointer_t<decltype(std::declval<C const&>().data())>>;
+
+// the number of word packs that are entirely covered by the first n integers of a container
+template<typename C>
+size_t num_full_packs(C const& c, size_t const n) {
+    return C::BitOrderType::template num_full_packs<pack_of<C>>(n, c.width());
+}
+
+// the index of the first integer that has bits in the given word pack
+template<typename C>
+size_t first_in_pack(C const& c, size_t const p) {
+    return C::BitOrderType::template first_in_pack<pack_of<C>>(p, c.width());
+}
+
+/**
+ * \brief Tests whether two containers contain the same integers with the same width
+ *
+ * The word packs that are entirely covered by integers are compared at once, the remaining integers are compared individually.
+ */
+template<typename C>
+bool content_equal(C const& a, C const& b) {
+    if(a.size() != b.size() || a.width() != b.width()) return false;
+    if(a.size() == 0) return true;
+
+    size_t const full = num_full_packs(a, a.size());
+    if(!std::equal(a.data(), a.data() + full, b.data())) return false;
+
+    for(size_t i = first_in_pack(a, full); i < a.size(); i++) {
+        if(a.get(i) != b.get(i)) return false;
+    }
+    return true;
+}
+
+/**
+ * \brief Compares the integers of two containers lexicographically
+ *
+ * If one sequence is a prefix of the other, the shorter sequence is less.
+ * Equal sequences of integers are ordered by their width.
+ * If the widths are equal, the first differing word pack is found at once and only the integers with bits in it are compared individually.
+ */
+template<typename C>
+std::strong_ordering content_compare(C const& a, C const& b) {
+    size_t const n = std::min(a.size(), b.size());
+
+    size_t start = 0;
+    if(n > 0 && a.width() == b.width()) {
+        size_t const full = num_full_packs(a, n);
+        size_t const p = std::mismatch(a.data(), a.data() + full, b.data()).first - a.data();
+        start = first_in_pack(a, p);
+    }
+
+    for(size_t i = start; i < n; i++) {
+        uintmax_t const x = a.get(i);
+        uintmax_t const y = b.get(i);
+        if(x != y) return x <=> y;
+    }
+
+    if(a.size() != b.size()) return a.size() <=> b.size();
+    return a.width() <=> b.width();
+}
+
+/**
+ * \brief Computes a 64-bit hash of the integers in a container and their width
+ *
+ * The word packs that are entirely covered by integers are hashed pairwise using the mixing function of wyhash,
+ * the remaining integers are hashed individually.
+ * Containers that are equal according to \ref content_equal have equal hashes.
+ */
+template<typename C>
+uint64_t content_hash(C const& c, uint64_t const seed) {
+    size_t const full = num_full_packs(c, c.size());
+    auto const* data = c.data();
+
+    uint64_t h = wymix(seed ^ WYP0, (uint64_t(c.size()) << 8) ^ c.width() ^ WYP1);
+
+    size_t p = 0;
+    for(; p + 1 < full; p += 2) h = wymix(uint64_t(data[p]) ^ WYP1, uint64_t(data[p + 1]) ^ h);
+    if(p < full) h = wymix(uint64_t(data[p]) ^ WYP1, h ^ WYP2);
+
+    for(size_t i = (full ? first_in_pack(c, full) : 0); i < c.size(); i++) h = wymix(c.get(i) ^ WYP2, h ^ WYP1);
+    return wymix(h ^ WYP0, full ^ WYP2);
+}
+
+}
+
+#endif
@@ -28,9 +28,14 @@
 #ifndef _WORD_PACKING_INTERNAL_CONTAINER_HPP
 #define _WORD_PACKING_INTERNAL_CONTAINER_HPP
 
+#include "../overflow.hpp"
+#include "compare.hpp"
 #include "impl.hpp"
 #include "int_ref.hpp"
 
+#include <compare>
+#include <type_traits>
+
 namespace word_packing::internal {
 
 template<typename IntRef>
@@ -70,6 +75,20 @@ protected:
     IntContainer& operator=(IntContainer&&) { return *this; }
     IntContainer& operator=(IntContainer const&) { return *this; }
 
+    template<typename F>
+    void increment_many_impl(size_t const* indices, size_t const num, F f) {
+        constexpr size_t LOOKAHEAD = 8;
+        using Pack = std::remove_pointer_t<decltype(impl->data())>;
+
+        if constexpr(Impl::StatsType::enabled) Impl::StatsType::bulk(num);
+
+        size_t const width = impl->width();
+        for(size_t k = 0; k < num; k++) {
+            if(k + LOOKAHEAD < num) __builtin_prefetch(impl->data() + Impl::BitOrderType::template pack_index<Pack>(indices[k + LOOKAHEAD], width));
+            f(indices[k]);
+        }
+    }
+
 public:
     /**
      * \brief Retrieves a specific integer from the vector
@@ -89,6 +108,21 @@ public:
      */
     auto operator[](size_t i) { return ImplIntRef(*impl, i); }
 
+    /**
+     * \brief Reads consecutive integers at once
+     * 
+     * Each word pack is loaded only once, which is cheaper than reading the integers one by one.
+     * 
+     * \param i the index of the first integer to read
+     * \param num the number of integers to read
+     * \param out the output array, receiving the integers
+     */
+    void unpack(size_t i, size_t num, uintmax_t* out) const {
+        assert(i + num <= impl->size());
+        if constexpr(Impl::StatsType::enabled) Impl::StatsType::bulk(num);
+        Impl::BitOrderType::unpack(impl->data(), i, num, impl->width(), out);
+    }
+
     /**
      * \brief Returns an iterator to the first integer
      * 
@@ -161,6 +195,135 @@ public:
      */
     uintmax_t back() const { return impl->get(impl->size() - 1); }
 
+    /**
+     * \brief Adds a value to a specific integer, recording any excess
+     * 
+     * The integer saturates and the part of the sum that did not fit is recorded in the given escape map.
+     * 
+     * \param i the index of the integer
+     * \param d the value to add
+     * \param escape the escape map
+     */
+    void add(size_t i, uintmax_t d, overflow::Escape& escape) {
+        escape.record(i, impl->template add<overflow::Escape>(i, d));
+    }
+
+    /**
+     * \brief Increments a specific integer
+     * 
+     * \tparam Overflow the overflow policy (\see word_packing::overflow)
+     * \param i the index of the integer
+     * \return one if the integer could not be incremented due to saturation, zero otherwise
+     */
+    template<typename Overflow = overflow::Wrap>
+    uintmax_t increment(size_t i) { return impl->template add<Overflow>(i, 1); }
+
+    /**
+     * \brief Increments a specific integer, recording any excess
+     * 
+     * \param i the index of the integer
+     * \param escape the escape map
+     */
+    void increment(size_t i, overflow::Escape& escape) { add(i, 1, escape); }
+
+    /**
+     * \brief Increments the integers at the given indices
+     * 
+     * Indices may occur multiple times, in which case the corresponding integer is incremented multiple times.
+     * The word packs of upcoming indices are prefetched.
+     * 
+     * \tparam Overflow the overflow policy (\see word_packing::overflow)
+     * \param indices the indices of the integers to increment
+     * \param num the number of indices
+     */
+    template<typename Overflow = overflow::Wrap>
+    void increment_many(size_t const* indices, size_t num) {
+        increment_many_impl(indices, num, [&](size_t i){ impl->template add<Overflow>(i, 1); });
+    }
+
+    /**
+     * \brief Increments the integers at the given indices, recording any excess
+     * 
+     * \param indices the indices of the integers to increment
+     * \param num the number of indices
+     * \param escape the escape map
+     */
+    void increment_many(size_t const* indices, size_t num, overflow::Escape& escape) {
+        increment_many_impl(indices, num, [&](size_t i){ add(i, 1, escape); });
+    }
+
+    /**
+     * \brief Tests whether two vectors are equal
+     * 
+     * Vectors are equal if they have the same size and width and contain the same integers.
+     * The word packs that are entirely covered by integers are compared at once, only the remaining integers are compared individually.
+     * 
+     * \param other the vector to compare to
+     * \return true if the vectors are equal
+     * \return false otherwise
+     */
+    bool operator==(IntContainer const& other) const { return content_equal(*impl, *other.impl); }
+
+    /**
+     * \brief Compares two vectors lexicographically
+     * 
+     * If one vector is a prefix of the other, the shorter vector is less.
+     * Vectors containing the same integers are ordered by their width.
+     * For vectors of equal width, the first differing word pack is found at once.
+     * 
+     * \param other the vector to compare to
+     * \return the ordering of the vectors
+     */
+    std::strong_ordering operator<=>(IntContainer const& other) const { return content_compare(*impl, *other.impl); }
+
+    /**
+     * \brief Computes a 64-bit hash of the vector's content
+     * 
+     * The hash covers the contained integers, the size and the width and is computed at word pack granularity.
+     * Vectors that are equal have equal hashes for equal seeds.
+     * 
+     * \param seed the seed
+     * \return the hash
+     */
+    uint64_t hash(uint64_t seed = 0) const { return content_hash(*impl, seed); }
+
+    /**
+     * \brief Reports the number of bits occupied by the contained integers
+     *
+     * \return the size times the width
+     */
+    size_t payload_bits() const { return impl->size() * impl->width(); }
+
+    /**
+     * \brief Reports the number of bytes allocated for the vector's capacity
+     *
+     * This includes the padding in the last word pack.
+     *
+     * \return the number of bytes of the allocated word packs
+     */
+    size_t capacity_bytes() const {
+        using Pack = pack_of<Impl>;
+        return Impl::BitOrderType::template num_packs<Pack>(impl->capacity(), impl->width()) * sizeof(Pack);
+    }
+
+    /**
+     * \brief Reports the number of heap bytes used by the vector
+     *
+     * Vectors allocate nothing but their word packs, so this equals \ref capacity_bytes .
+     *
+     * \return the number of heap bytes used
+     */
+    size_t memory_usage() const { return capacity_bytes(); }
+
+    /**
+     * \brief Reports the number of allocated bits not occupied by any contained integer
+     *
+     * This covers both the unused capacity and the padding in the last word pack.
+     *
+     * \return the number of wasted bits
+     */
+    size_t wasted_bits() const { return 8 * capacity_bytes() - payload_bits(); }
+
     /**
      * \brief Tests whether the vector is empty
      * 
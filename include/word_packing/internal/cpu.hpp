@@ -0,0 +1,125 @@
+/**
+ * word_packing/internal/cpu.hpp
+ * part of pdinklag/word-packing
+ * 
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _WORD_PACKING_INTERNAL_CPU_HPP
+#define _WORD_PACKING_INTERNAL_CPU_HPP
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define WORD_PACKING_X86_DISPATCH
+#include <immintrin.h>
+#endif
+
+/**
+ * \brief Runtime detection of instruction set extensions used by bulk kernels
+ *
+ * Kernels that benefit from instruction set extensions are compiled in multiple variants using function target attributes,
+ * so they are available regardless of the compiler flags, and one variant is picked at runtime according to the detected features.
+ * Features that are enabled at compile time (e.g., using `-march=native`) are assumed to be present by the detection.
+ * The queries always consult \ref features so that restricting the features takes effect in any build.
+ */
+namespace word_packing::internal::cpu {
+
+/**
+ * \brief The instruction set extensions relevant to the kernels
+ */
+struct Features {
+    bool popcnt = false;
+    bool ssse3 = false;
+    bool bmi2 = false;
+    bool avx2 = false;
+    bool avx512bw = false;
+};
+
+/**
+ * \brief Detects the instruction set extensions supported by the executing CPU
+ * 
+ * \return the supported features
+ */
+inline Features detect() {
+    Features f;
+#ifdef WORD_PACKING_X86_DISPATCH
+    __builtin_cpu_init();
+    f.popcnt = __builtin_cpu_supports("popcnt");
+    f.ssse3 = __builtin_cpu_supports("ssse3");
+    f.bmi2 = __builtin_cpu_supports("bmi2");
+    f.avx2 = __builtin_cpu_supports("avx2");
+    f.avx512bw = __builtin_cpu_supports("avx512bw");
+#endif
+#ifdef __POPCNT__
+    f.popcnt = true;
+#endif
+#ifdef __SSSE3__
+    f.ssse3 = true;
+#endif
+#ifdef __BMI2__
+    f.bmi2 = true;
+#endif
+#ifdef __AVX2__
+    f.avx2 = true;
+#endif
+#ifdef __AVX512BW__
+    f.avx512bw = true;
+#endif
+    return f;
+}
+
+/**
+ * \brief Provides the features used to select kernels
+ * 
+ * The features are detected once on first use.
+ * They may be modified to restrict the kernels to certain variants, e.g., for testing.
+ * 
+ * \return the features
+ */
+inline Features& features() {
+    static Features f = detect();
+    return f;
+}
+
+inline bool has_popcnt() {
+    return features().popcnt;
+}
+
+inline bool has_ssse3() {
+    return features().ssse3;
+}
+
+inline bool has_bmi2() {
+    return features().bmi2;
+}
+
+inline bool has_avx2() {
+    return features().avx2;
+}
+
+inline bool has_avx512bw() {
+    return features().avx512bw;
+}
+
+}
+
+#endif
@@ -35,25 +35,43 @@
 namespace word_packing::internal {
 
 /**
- * \brief Reads an integer from a packed container
+ * \brief Computes the mask selecting a range of bit positions within a single word pack
+ * 
+ * \tparam Pack the word pack type
+ * \param lo the first bit position within the word pack
+ * \param hi the bit position right beyond the last one, greater than `lo` and at most the number of bits per word pack
+ * \return the mask selecting the bit positions [lo, hi)
+ */
+template<WordPackEligible Pack>
+constexpr Pack range_mask(size_t const lo, size_t const hi) {
+    assert(lo < hi);
+    assert(hi <= std::numeric_limits<Pack>::digits);
+    return Pack(low_mask(hi - lo) << lo);
+}
+
+/**
+ * \brief Reads a range of bits from an array of word packs
+ * 
+ * The range may start at any bit position and may span two word packs.
  * 
  * \tparam Pack the word pack type
  * \param data the array of word packs
- * \param i the index of the integer to read
- * \param width the width per integer in the container
- * \param mask the precomputed mask for masking out the `width` low bits of an integer (\see low_mask)
- * \return the read integer
+ * \param bit_off the position of the first bit to read
+ * \param nbits the number of bits to read, at least one and at most the number of bits per word pack
+ * \param mask the precomputed mask for masking out the `nbits` low bits of an integer (\see low_mask)
+ * \return the read bits, the first of which is the least significant
  */
 template<WordPackEligible Pack>
-inline uintmax_t get(Pack const* data, size_t const i, size_t const width, uintmax_t const mask) {
+inline uintmax_t get_bits(Pack const* data, size_t const bit_off, size_t const nbits, uintmax_t const mask) {
     constexpr size_t PACK_BITS = std::numeric_limits<Pack>::digits;
+    assert(nbits > 0);
+    assert(nbits <= PACK_BITS);
 
-    size_t const j = i * width;
-    size_t const a = j / PACK_BITS;                  // left border
-    size_t const b = (j + width - 1ULL) / PACK_BITS; // right border
+    size_t const a = bit_off / PACK_BITS;                  // left border
+    size_t const b = (bit_off + nbits - 1ULL) / PACK_BITS; // right border
 
     // da is the distance of a's relevant bits from the left border
-    size_t const da = j & (PACK_BITS - 1);
+    size_t const da = bit_off & (PACK_BITS - 1);
 
     // wa is the number of a's relevant bits
     size_t const wa = PACK_BITS - da;
@@ -70,6 +88,37 @@ inline uintmax_t get(Pack const* data, size_t const i, size_t const width, uintm
     return ((b_lo << wa) | a_hi) & mask;
 }
 
+/**
+ * \brief Reads a range of bits from an array of word packs
+ * 
+ * The range may start at any bit position and may span two word packs.
+ * 
+ * \tparam Pack the word pack type
+ * \param data the array of word packs
+ * \param bit_off the position of the first bit to read
+ * \param nbits the number of bits to read, at least one and at most the number of bits per word pack
+ * \return the read bits, the first of which is the least significant
+ */
+template<WordPackEligible Pack>
+inline uintmax_t get_bits(Pack const* data, size_t const bit_off, size_t const nbits) {
+    return get_bits(data, bit_off, nbits, low_mask(nbits));
+}
+
+/**
+ * \brief Reads an integer from a packed container
+ * 
+ * \tparam Pack the word pack type
+ * \param data the array of word packs
+ * \param i the index of the integer to read
+ * \param width the width per integer in the container
+ * \param mask the precomputed mask for masking out the `width` low bits of an integer (\see low_mask)
+ * \return the read integer
+ */
+template<WordPackEligible Pack>
+inline uintmax_t get(Pack const* data, size_t const i, size_t const width, uintmax_t const mask) {
+    return get_bits(data, i * width, width, mask);
+}
+
 /**
  * \brief Reads an integer from a packed container
  * 
@@ -124,42 +173,100 @@ inline uintmax_t get(Pack const* data, size_t const i) {
 }
 
 /**
- * \brief Writes an integer in a packed container
+ * \brief Reads consecutive integers of the same width from a range of bits
+ * 
+ * Each word pack is loaded only once and the integers are cut from a buffer holding its bits that have not yet been consumed,
+ * which is cheaper than reading the integers one by one.
  * 
  * \tparam Pack the word pack type
  * \param data the array of word packs
- * \param i the index of the integer to read
- * \param x the value to write
- * \param width the width per integer in the container
- * \param mask the precomputed mask for masking out the `width` low bits of an integer (\see low_mask)
- * \return the read integer
+ * \param bit_off the position of the first bit of the first integer
+ * \param num the number of integers to read
+ * \param width the width of each integer, at least one and at most the number of bits per word pack
+ * \param out the output array, receiving the integers
  */
 template<WordPackEligible Pack>
-inline void set(Pack* data, size_t const i, uintmax_t const x, size_t const width, uintmax_t const mask) {
+inline void unpack_bits(Pack const* data, size_t const bit_off, size_t const num, size_t const width, uintmax_t* out) {
+    constexpr size_t PACK_BITS = std::numeric_limits<Pack>::digits;
+    if(num == 0) return;
+    assert(width > 0);
+    assert(width <= PACK_BITS);
+
+    uintmax_t const mask = low_mask(width);
+    Pack const* p = data + bit_off / PACK_BITS;
+
+    // the buffer holds the avail unconsumed bits of the current pack as its lowest bits
+    size_t avail = PACK_BITS - bit_off % PACK_BITS;
+    uintmax_t buf = uintmax_t(*p++) >> (bit_off % PACK_BITS);
+    for(size_t k = 0; k < num; k++) {
+        if(avail >= width) {
+            out[k] = buf & mask;
+            buf = (buf >> 1) >> (width - 1); // nb: the split shift ensures that this works for width = 64
+            avail -= width;
+        } else {
+            // the integer straddles into the next pack
+            uintmax_t const next = *p++;
+            out[k] = (buf | (next << avail)) & mask;
+            buf = (next >> 1) >> (width - avail - 1);
+            avail = PACK_BITS - (width - avail);
+        }
+    }
+}
+
+/**
+ * \brief Reads consecutive integers from a packed container
+ * 
+ * \tparam Pack the word pack type
+ * \param data the array of word packs
+ * \param i the index of the first integer to read
+ * \param num the number of integers to read
+ * \param width the width per integer in the container, at least one and at most the number of bits per word pack
+ * \param out the output array, receiving the integers
+ */
+template<WordPackEligible Pack>
+inline void unpack(Pack const* data, size_t const i, size_t const num, size_t const width, uintmax_t* out) {
+    unpack_bits(data, i * width, num, width, out);
+}
+
+/**
+ * \brief Writes a range of bits to an array of word packs
+ * 
+ * The range may start at any bit position and may span two word packs.
+ * 
+ * \tparam Pack the word pack type
+ * \param data the array of word packs
+ * \param bit_off the position of the first bit to write
+ * \param nbits the number of bits to write, at least one and at most the number of bits per word pack
+ * \param x the bits to write, the first of which is the least significant
+ * \param mask the precomputed mask for masking out the `nbits` low bits of an integer (\see low_mask)
+ */
+template<WordPackEligible Pack>
+inline void set_bits(Pack* data, size_t const bit_off, size_t const nbits, uintmax_t const x, uintmax_t const mask) {
     constexpr size_t PACK_BITS = std::numeric_limits<Pack>::digits;
+    assert(nbits > 0);
+    assert(nbits <= PACK_BITS);
 
     uintmax_t const v = x & mask; // make sure it fits...
     
-    size_t const j = i * width;
-    size_t const a = j / PACK_BITS;                   // left border
-    size_t const b = (j + width - 1ULL) / PACK_BITS; // right border
+    size_t const a = bit_off / PACK_BITS;                  // left border
+    size_t const b = (bit_off + nbits - 1ULL) / PACK_BITS; // right border
 
     // get starting position of relevant bit block within data[a]
-    size_t const da = j & (PACK_BITS - 1);
+    size_t const da = bit_off & (PACK_BITS - 1);
     assert(da < PACK_BITS);
 
     if(a == b) {
         // the bits are an infix of data[a]
         uintmax_t const xa = data[a];
         uintmax_t const mask_lo = low_mask0(da);
-        uintmax_t const mask_hi = ~mask_lo << (width-1) << 1; // nb: the extra shift ensures that this works for width_ = 64
+        uintmax_t const mask_hi = ~mask_lo << (nbits-1) << 1; // nb: the extra shift ensures that this works for nbits = 64
         data[a] = (xa & mask_lo) | (v << da) | (xa & mask_hi);
     } else {
         // the bits are the suffix of data[a] and prefix of data[b]
         size_t const wa = PACK_BITS - da;
         assert(wa > 0);
-        assert(wa < width);
-        size_t const wb = width - wa;
+        assert(wa < nbits);
+        size_t const wb = nbits - wa;
 
         // combine the da lowest bits from a and the wa lowest bits of v
         uintmax_t const a_lo = data[a] & low_mask0(da);
@@ -173,6 +280,37 @@ inline void set(Pack* data, size_t const i, uintmax_t const x, size_t const widt
     }
 }
 
+/**
+ * \brief Writes a range of bits to an array of word packs
+ * 
+ * The range may start at any bit position and may span two word packs.
+ * 
+ * \tparam Pack the word pack type
+ * \param data the array of word packs
+ * \param bit_off the position of the first bit to write
+ * \param nbits the number of bits to write, at least one and at most the number of bits per word pack
+ * \param x the bits to write, the first of which is the least significant
+ */
+template<WordPackEligible Pack>
+inline void set_bits(Pack* data, size_t const bit_off, size_t const nbits, uintmax_t const x) {
+    set_bits(data, bit_off, nbits, x, low_mask(nbits));
+}
+
+/**
+ * \brief Writes an integer in a packed container
+ * 
+ * \tparam Pack the word pack type
+ * \param data the array of word packs
+ * \param i the index of the integer to read
+ * \param x the value to write
+ * \param width the width per integer in the container
+ * \param mask the precomputed mask for masking out the `width` low bits of an integer (\see low_mask)
+ */
+template<WordPackEligible Pack>
+inline void set(Pack* data, size_t const i, uintmax_t const x, size_t const width, uintmax_t const mask) {
+    set_bits(data, i * width, width, x, mask);
+}
+
 /**
  * \brief Writes an integer to a packed container
  * 
@@ -237,6 +375,113 @@ inline void set(Pack* data, size_t const i, uintmax_t const x) {
     }
 }
 
+
+/**
+ * \brief Adds a value to an integer according to an overflow policy
+ * 
+ * \tparam Overflow the overflow policy (\see word_packing::overflow)
+ * \param x the current integer
+ * \param d the value to add
+ * \param mask the mask for the `width` low bits of an integer (\see low_mask)
+ * \param y receives the new integer
+ * \return the part of the sum that did not fit (always zero if the policy does not saturate)
+ */
+template<typename Overflow>
+inline uintmax_t add_value(uintmax_t const x, uintmax_t const d, uintmax_t const mask, uintmax_t& y) {
+    if constexpr(Overflow::saturates) {
+        uintmax_t const room = mask - x;
+        if(d <= room) {
+            y = x + d;
+            return 0;
+        } else {
+            y = mask;
+            return d - room;
+        }
+    } else {
+        y = (x + d) & mask;
+        return 0;
+    }
+}
+
+/**
+ * \brief Adds a value to an integer in a packed container
+ * 
+ * In contrast to a \ref get followed by a \ref set , the affected packs are read and written only once.
+ * 
+ * \tparam Overflow the overflow policy (\see word_packing::overflow)
+ * \tparam Pack the word pack type
+ * \param data the array of word packs
+ * \param i the index of the integer to modify
+ * \param d the value to add
+ * \param width the width per integer in the container
+ * \param mask the precomputed mask for masking out the `width` low bits of an integer (\see low_mask)
+ * \return the part of the sum that did not fit (always zero if the policy does not saturate)
+ */
+template<typename Overflow, WordPackEligible Pack>
+inline uintmax_t add(Pack* data, size_t const i, uintmax_t const d, size_t const width, uintmax_t const mask) {
+    constexpr size_t PACK_BITS = std::numeric_limits<Pack>::digits;
+
+    size_t const j = i * width;
+    size_t const a = j / PACK_BITS;                  // left border
+    size_t const b = (j + width - 1ULL) / PACK_BITS; // right border
+    size_t const da = j & (PACK_BITS - 1);
+
+    uintmax_t y;
+    if(a == b) {
+        // the bits are an infix of data[a]
+        uintmax_t const xa = data[a];
+        uintmax_t const carry = add_value<Overflow>((xa >> da) & mask, d, mask, y);
+        data[a] = (xa & ~(mask << da)) | (y << da);
+        return carry;
+    } else {
+        // the bits are the suffix of data[a] and prefix of data[b]
+        size_t const wa = PACK_BITS - da;
+        size_t const wb = width - wa;
+
+        uintmax_t const xa = data[a];
+        uintmax_t const xb = data[b];
+        uintmax_t const carry = add_value<Overflow>(((xb << wa) | (xa >> da)) & mask, d, mask, y);
+        data[a] = (xa & low_mask0(da)) | (y << da);
+        data[b] = ((xb >> wb) << wb) | (y >> wa);
+        return carry;
+    }
+}
+
+/**
+ * \brief Adds a value to an integer in a packed container
+ * 
+ * In contrast to a \ref get followed by a \ref set , the affected packs are read and written only once.
+ * 
+ * \tparam width the width per integer in the container
+ * \tparam Overflow the overflow policy (\see word_packing::overflow)
+ * \tparam Pack the word pack type
+ * \param data the array of word packs
+ * \param i the index of the integer to modify
+ * \param d the value to add
+ * \return the part of the sum that did not fit (always zero if the policy does not saturate)
+ */
+template<size_t width, typename Overflow, WordPackEligible Pack>
+inline uintmax_t add(Pack* data, size_t const i, uintmax_t const d) {
+    constexpr size_t PACK_BITS = std::numeric_limits<Pack>::digits;
+    constexpr uintmax_t mask = low_mask(width);
+    constexpr bool aligned = (PACK_BITS % width) == 0;
+
+    if constexpr(aligned) {
+        // the bits are always an infix of a single pack
+        size_t const j = i * width;
+        size_t const a = j / PACK_BITS;
+        size_t const da = j & (PACK_BITS - 1);
+
+        uintmax_t y;
+        uintmax_t const xa = data[a];
+        uintmax_t const carry = add_value<Overflow>((xa >> da) & mask, d, mask, y);
+        data[a] = (xa & ~(mask << da)) | (y << da);
+        return carry;
+    } else {
+        return add<Overflow>(data, i, d, width, mask);
+    }
+}
+
 }
 
 #endif
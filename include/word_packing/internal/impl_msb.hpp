@@ -0,0 +1,341 @@
+/**
+ * word_packing/internal/impl_msb.hpp
+ * part of pdinklag/word-packing
+ * 
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _WORD_PACKING_INTERNAL_IMPL_MSB_HPP
+#define _WORD_PACKING_INTERNAL_IMPL_MSB_HPP
+
+#include "impl.hpp"
+
+#include <cassert>
+
+/**
+ * \brief Access to integers packed starting from the most significant bit
+ * 
+ * In this layout, the word packs are considered a big-endian bit stream:
+ * bit k is the (k mod 8)-th most significant bit of the (k / 8)-th byte, regardless of the word pack type,
+ * and every integer is stored starting with its most significant bit.
+ * This is the layout used by many network protocols and file formats, which can thus be accessed directly.
+ * 
+ * Word packs are converted to big-endian byte order when loaded and converted back when stored,
+ * which is a single instruction on little-endian machines.
+ */
+namespace word_packing::internal::msb {
+
+/**
+ * \brief Computes the mask selecting a range of bit positions within a single word pack in big-endian bit order
+ * 
+ * \tparam Pack the word pack type
+ * \param lo the first bit position within the word pack
+ * \param hi the bit position right beyond the last one, greater than `lo` and at most the number of bits per word pack
+ * \return the mask selecting the bit positions [lo, hi), in native byte order
+ */
+template<WordPackEligible Pack>
+constexpr Pack range_mask(size_t const lo, size_t const hi) {
+    constexpr size_t PACK_BITS = std::numeric_limits<Pack>::digits;
+    assert(lo < hi);
+    assert(hi <= PACK_BITS);
+    return big_endian(Pack(low_mask(hi - lo) << (PACK_BITS - hi)));
+}
+
+/**
+ * \brief Reads a range of bits from an array of word packs in big-endian bit order
+ * 
+ * \tparam Pack the word pack type
+ * \param data the array of word packs
+ * \param bit_off the position of the first bit to read
+ * \param nbits the number of bits to read, at least one and at most the number of bits per word pack
+ * \return the read bits, the first of which is the most significant
+ */
+template<WordPackEligible Pack>
+inline uintmax_t get_bits(Pack const* data, size_t const bit_off, size_t const nbits) {
+    constexpr size_t PACK_BITS = std::numeric_limits<Pack>::digits;
+    constexpr uintmax_t PACK_MASK = low_mask(PACK_BITS);
+    assert(nbits > 0);
+    assert(nbits <= PACK_BITS);
+
+    size_t const a = bit_off / PACK_BITS;                  // left border
+    size_t const b = (bit_off + nbits - 1ULL) / PACK_BITS; // right border
+    size_t const da = bit_off & (PACK_BITS - 1);
+
+    // align the relevant bits of a to the most significant end of a pack
+    uintmax_t const a_top = (uintmax_t(big_endian(data[a])) << da) & PACK_MASK;
+
+    // get the da highest bits of b as the lowest bits (they will be shifted away below if a == b)
+    // NOTE: the extra shift ensures that this works for da = 0
+    uintmax_t const b_lo = (uintmax_t(big_endian(data[b])) >> 1) >> (PACK_BITS - 1 - da);
+
+    // combine and move to the least significant end
+    return (a_top | b_lo) >> (PACK_BITS - nbits);
+}
+
+/**
+ * \brief Writes a range of bits to an array of word packs in big-endian bit order
+ * 
+ * \tparam Pack the word pack type
+ * \param data the array of word packs
+ * \param bit_off the position of the first bit to write
+ * \param nbits the number of bits to write, at least one and at most the number of bits per word pack
+ * \param x the bits to write, the first of which is the most significant
+ * \param mask the precomputed mask for masking out the `nbits` low bits of an integer (\see low_mask)
+ */
+template<WordPackEligible Pack>
+inline void set_bits(Pack* data, size_t const bit_off, size_t const nbits, uintmax_t const x, uintmax_t const mask) {
+    constexpr size_t PACK_BITS = std::numeric_limits<Pack>::digits;
+    assert(nbits > 0);
+    assert(nbits <= PACK_BITS);
+
+    uintmax_t const v = x & mask; // make sure it fits...
+
+    size_t const a = bit_off / PACK_BITS;                  // left border
+    size_t const b = (bit_off + nbits - 1ULL) / PACK_BITS; // right border
+    size_t const da = bit_off & (PACK_BITS - 1);
+
+    if(a == b) {
+        // the bits are an infix of data[a]
+        size_t const shift = PACK_BITS - da - nbits;
+        uintmax_t const xa = big_endian(data[a]);
+        data[a] = big_endian(Pack((xa & ~(mask << shift)) | (v << shift)));
+    } else {
+        // the high bits of v are the suffix of data[a], the low bits are the prefix of data[b]
+        size_t const wa = PACK_BITS - da;
+        size_t const wb = nbits - wa;
+
+        uintmax_t const xa = big_endian(data[a]);
+        data[a] = big_endian(Pack((xa & ~low_mask(wa)) | (v >> wb)));
+
+        uintmax_t const xb = big_endian(data[b]);
+        data[b] = big_endian(Pack((xb & low_mask0(PACK_BITS - wb)) | ((v & low_mask(wb)) << (PACK_BITS - wb))));
+    }
+}
+
+/**
+ * \brief Writes a range of bits to an array of word packs in big-endian bit order
+ * 
+ * \tparam Pack the word pack type
+ * \param data the array of word packs
+ * \param bit_off the position of the first bit to write
+ * \param nbits the number of bits to write, at least one and at most the number of bits per word pack
+ * \param x the bits to write, the first of which is the most significant
+ */
+template<WordPackEligible Pack>
+inline void set_bits(Pack* data, size_t const bit_off, size_t const nbits, uintmax_t const x) {
+    set_bits(data, bit_off, nbits, x, low_mask(nbits));
+}
+
+/**
+ * \brief Reads an integer from a packed container in big-endian bit order
+ * 
+ * \tparam Pack the word pack type
+ * \param data the array of word packs
+ * \param i the index of the integer to read
+ * \param width the width per integer in the container
+ * \return the read integer
+ */
+template<WordPackEligible Pack>
+inline uintmax_t get(Pack const* data, size_t const i, size_t const width) {
+    return get_bits(data, i * width, width);
+}
+
+/**
+ * \brief Reads an integer from a packed container in big-endian bit order
+ * 
+ * \tparam width the width per integer in the container
+ * \tparam Pack the word pack type
+ * \param data the array of word packs
+ * \param i the index of the integer to read
+ * \return the read integer
+ */
+template<size_t width, WordPackEligible Pack>
+inline uintmax_t get(Pack const* data, size_t const i) {
+    constexpr size_t PACK_BITS = std::numeric_limits<Pack>::digits;
+    constexpr uintmax_t mask = low_mask(width);
+    constexpr bool aligned = (PACK_BITS % width) == 0;
+
+    if constexpr(aligned) {
+        // if we're aligned, we don't need to consider the next pack
+        size_t const j = i * width;
+        size_t const a = j / PACK_BITS;
+        size_t const da = j & (PACK_BITS - 1);
+        return (uintmax_t(big_endian(data[a])) >> (PACK_BITS - da - width)) & mask;
+    } else {
+        return get_bits(data, i * width, width);
+    }
+}
+
+/**
+ * \brief Reads consecutive integers from a packed container in big-endian bit order
+ * 
+ * Each word pack is loaded only once and the integers are cut from a buffer holding its bits that have not yet been consumed.
+ * 
+ * \tparam Pack the word pack type
+ * \param data the array of word packs
+ * \param i the index of the first integer to read
+ * \param num the number of integers to read
+ * \param width the width per integer in the container, at least one and at most the number of bits per word pack
+ * \param out the output array, receiving the integers
+ */
+template<WordPackEligible Pack>
+inline void unpack(Pack const* data, size_t const i, size_t const num, size_t const width, uintmax_t* out) {
+    constexpr size_t PACK_BITS = std::numeric_limits<Pack>::digits;
+    if(num == 0) return;
+    assert(width > 0);
+    assert(width <= PACK_BITS);
+
+    uintmax_t const mask = low_mask(width);
+    size_t const bit_off = i * width;
+    Pack const* p = data + bit_off / PACK_BITS;
+
+    // the avail lowest bits of the buffer are the unconsumed bits of the current pack, the next of which is the most significant
+    size_t avail = PACK_BITS - bit_off % PACK_BITS;
+    uintmax_t buf = uintmax_t(big_endian(*p++));
+    for(size_t k = 0; k < num; k++) {
+        if(avail >= width) {
+            out[k] = (buf >> (avail - width)) & mask;
+            avail -= width;
+        } else {
+            // the integer straddles into the next pack
+            size_t const need = width - avail;
+            uintmax_t const next = uintmax_t(big_endian(*p++));
+            out[k] = (((buf << 1) << (need - 1)) | (next >> (PACK_BITS - need))) & mask; // nb: the split shift ensures that this works for need = 64
+            buf = next;
+            avail = PACK_BITS - need;
+        }
+    }
+}
+
+/**
+ * \brief Writes an integer in a packed container in big-endian bit order
+ * 
+ * \tparam Pack the word pack type
+ * \param data the array of word packs
+ * \param i the index of the integer to write
+ * \param x the value to write
+ * \param width the width per integer in the container
+ * \param mask the precomputed mask for masking out the `width` low bits of an integer (\see low_mask)
+ */
+template<WordPackEligible Pack>
+inline void set(Pack* data, size_t const i, uintmax_t const x, size_t const width, uintmax_t const mask) {
+    set_bits(data, i * width, width, x, mask);
+}
+
+/**
+ * \brief Writes an integer in a packed container in big-endian bit order
+ * 
+ * \tparam width the width per integer in the container
+ * \tparam Pack the word pack type
+ * \param data the array of word packs
+ * \param i the index of the integer to write
+ * \param x the value to write
+ */
+template<size_t width, WordPackEligible Pack>
+inline void set(Pack* data, size_t const i, uintmax_t const x) {
+    constexpr size_t PACK_BITS = std::numeric_limits<Pack>::digits;
+    constexpr uintmax_t mask = low_mask(width);
+    constexpr bool aligned = (PACK_BITS % width) == 0;
+
+    if constexpr(width == 1) {
+        // optimized write for single bits, clamping to 0 or 1 like the least-significant-first layout
+        bool const bit = bool(x);
+        size_t const a = i / PACK_BITS;
+        uintmax_t const m = uintmax_t(1) << (PACK_BITS - 1 - (i % PACK_BITS));
+        uintmax_t const xa = big_endian(data[a]);
+        data[a] = big_endian(Pack((xa & ~m) | (-uintmax_t(bit) & m)));
+    } else if constexpr(aligned) {
+        // the bits are always an infix of a single pack
+        size_t const j = i * width;
+        size_t const a = j / PACK_BITS;
+        size_t const shift = PACK_BITS - (j & (PACK_BITS - 1)) - width;
+        uintmax_t const xa = big_endian(data[a]);
+        data[a] = big_endian(Pack((xa & ~(mask << shift)) | ((x & mask) << shift)));
+    } else {
+        set_bits(data, i * width, width, x, mask);
+    }
+}
+
+/**
+ * \brief Adds a value to an integer in a packed container in big-endian bit order
+ * 
+ * In contrast to a \ref get followed by a \ref set , the affected packs are read and written only once.
+ * 
+ * \tparam Overflow the overflow policy (\see word_packing::overflow)
+ * \tparam Pack the word pack type
+ * \param data the array of word packs
+ * \param i the index of the integer to modify
+ * \param d the value to add
+ * \param width the width per integer in the container
+ * \param mask the precomputed mask for masking out the `width` low bits of an integer (\see low_mask)
+ * \return the part of the sum that did not fit (always zero if the policy does not saturate)
+ */
+template<typename Overflow, WordPackEligible Pack>
+inline uintmax_t add(Pack* data, size_t const i, uintmax_t const d, size_t const width, uintmax_t const mask) {
+    constexpr size_t PACK_BITS = std::numeric_limits<Pack>::digits;
+
+    size_t const j = i * width;
+    size_t const a = j / PACK_BITS;                  // left border
+    size_t const b = (j + width - 1ULL) / PACK_BITS; // right border
+    size_t const da = j & (PACK_BITS - 1);
+
+    uintmax_t y;
+    uintmax_t const xa = big_endian(data[a]);
+    if(a == b) {
+        // the bits are an infix of data[a]
+        size_t const shift = PACK_BITS - da - width;
+        uintmax_t const carry = add_value<Overflow>((xa >> shift) & mask, d, mask, y);
+        data[a] = big_endian(Pack((xa & ~(mask << shift)) | (y << shift)));
+        return carry;
+    } else {
+        // the high bits are the suffix of data[a], the low bits are the prefix of data[b]
+        size_t const wa = PACK_BITS - da;
+        size_t const wb = width - wa;
+
+        uintmax_t const xb = big_endian(data[b]);
+        uintmax_t const carry = add_value<Overflow>(((xa & low_mask(wa)) << wb) | (xb >> (PACK_BITS - wb)), d, mask, y);
+        data[a] = big_endian(Pack((xa & ~low_mask(wa)) | (y >> wb)));
+        data[b] = big_endian(Pack((xb & low_mask0(PACK_BITS - wb)) | ((y & low_mask(wb)) << (PACK_BITS - wb))));
+        return carry;
+    }
+}
+
+/**
+ * \brief Adds a value to an integer in a packed container in big-endian bit order
+ * 
+ * \tparam width the width per integer in the container
+ * \tparam Overflow the overflow policy (\see word_packing::overflow)
+ * \tparam Pack the word pack type
+ * \param data the array of word packs
+ * \param i the index of the integer to modify
+ * \param d the value to add
+ * \return the part of the sum that did not fit (always zero if the policy does not saturate)
+ */
+template<size_t width, typename Overflow, WordPackEligible Pack>
+inline uintmax_t add(Pack* data, size_t const i, uintmax_t const d) {
+    return add<Overflow>(data, i, d, width, low_mask(width)); // nb: constant propagation takes care of the aligned case
+}
+
+}
+
+#endif
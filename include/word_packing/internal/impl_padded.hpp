@@ -0,0 +1,284 @@
+/**
+ * word_packing/internal/impl_padded.hpp
+ * part of pdinklag/word-packing
+ * 
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _WORD_PACKING_INTERNAL_IMPL_PADDED_HPP
+#define _WORD_PACKING_INTERNAL_IMPL_PADDED_HPP
+
+#include "impl.hpp"
+
+#include <array>
+#include <cassert>
+
+/**
+ * \brief Access to integers packed such that none straddles two word packs
+ * 
+ * In this layout, each word pack holds `floor(PACK_BITS / width)` integers, starting from its least significant bit,
+ * and the remaining most significant bits are padding.
+ * Every access thus reads and writes exactly one word pack.
+ * 
+ * For runtime widths, the division of the index by the number of integers per pack is replaced by a multiplication with a tabulated reciprocal,
+ * which is exact for all indices below 2^58.
+ */
+namespace word_packing::internal::padded {
+
+// the number of integers per pack for a given width, and the reciprocal 2^64 / num (rounded up) if num > 1
+struct Divisor {
+    uint64_t reciprocal;
+    size_t num;
+};
+
+template<WordPackEligible Pack>
+constexpr auto make_divisors() {
+    constexpr size_t PACK_BITS = std::numeric_limits<Pack>::digits;
+
+    std::array<Divisor, PACK_BITS + 1> divisors = {};
+    for(size_t w = 1; w <= PACK_BITS; w++) {
+        size_t const num = PACK_BITS / w;
+        divisors[w].num = num;
+        divisors[w].reciprocal = (num > 1) ? uint64_t(((__uint128_t(1) << 64) + num - 1) / num) : 0;
+    }
+    return divisors;
+}
+
+template<WordPackEligible Pack>
+constexpr auto DIVISORS = make_divisors<Pack>();
+
+/**
+ * \brief Computes the number of integers stored in each word pack
+ * 
+ * \tparam Pack the word pack type
+ * \param width the bit width of each integer
+ * \return the number of integers per word pack
+ */
+template<WordPackEligible Pack>
+constexpr size_t num_per_pack(size_t const width) {
+    return std::numeric_limits<Pack>::digits / width;
+}
+
+/**
+ * \brief Computes the number of word packs required to store the given number of integers
+ * 
+ * \tparam Pack the word pack type
+ * \param num the number of integers
+ * \param width the bit width of each integer
+ * \return the number of word packs required
+ */
+template<WordPackEligible Pack>
+constexpr size_t num_packs(size_t const num, size_t const width) {
+    return idiv_ceil(num, num_per_pack<Pack>(width));
+}
+
+/**
+ * \brief Locates an integer
+ * 
+ * \tparam Pack the word pack type
+ * \param i the index of the integer
+ * \param width the bit width of each integer
+ * \param shift receives the position of the integer's least significant bit in its word pack
+ * \return the index of the word pack containing the integer
+ */
+template<WordPackEligible Pack>
+inline size_t locate(size_t const i, size_t const width, size_t& shift) {
+    assert(i < (size_t(1) << 58));
+    Divisor const& d = DIVISORS<Pack>[width];
+    size_t const p = (d.num > 1) ? size_t((__uint128_t(i) * d.reciprocal) >> 64) : i;
+    shift = (i - p * d.num) * width;
+    return p;
+}
+
+/**
+ * \brief Locates an integer of a fixed width
+ * 
+ * \tparam width the bit width of each integer
+ * \tparam Pack the word pack type
+ * \param i the index of the integer
+ * \param shift receives the position of the integer's least significant bit in its word pack
+ * \return the index of the word pack containing the integer
+ */
+template<size_t width, WordPackEligible Pack>
+inline size_t locate(size_t const i, size_t& shift) {
+    constexpr size_t num = num_per_pack<Pack>(width);
+    shift = (i % num) * width;
+    return i / num;
+}
+
+/**
+ * \brief Retrieves an integer
+ * 
+ * \tparam Pack the word pack type
+ * \param data the array of word packs
+ * \param i the index of the integer
+ * \param width the bit width of each integer
+ * \param mask the bit mask corresponding to the width
+ * \return the integer
+ */
+template<WordPackEligible Pack>
+inline uintmax_t get(Pack const* data, size_t const i, size_t const width, uintmax_t const mask) {
+    size_t shift;
+    size_t const p = locate<Pack>(i, width, shift);
+    return (uintmax_t(data[p]) >> shift) & mask;
+}
+
+/**
+ * \brief Retrieves an integer of a fixed width
+ * 
+ * \tparam width the bit width of each integer
+ * \tparam Pack the word pack type
+ * \param data the array of word packs
+ * \param i the index of the integer
+ * \return the integer
+ */
+template<size_t width, WordPackEligible Pack>
+inline uintmax_t get(Pack const* data, size_t const i) {
+    size_t shift;
+    size_t const p = locate<width, Pack>(i, shift);
+    return (uintmax_t(data[p]) >> shift) & low_mask(width);
+}
+
+/**
+ * \brief Reads consecutive integers
+ * 
+ * Each word pack is loaded only once and its integers are cut from it one after another.
+ * 
+ * \tparam Pack the word pack type
+ * \param data the array of word packs
+ * \param i the index of the first integer to read
+ * \param num the number of integers to read
+ * \param width the bit width of each integer
+ * \param out the output array, receiving the integers
+ */
+template<WordPackEligible Pack>
+inline void unpack(Pack const* data, size_t const i, size_t const num, size_t const width, uintmax_t* out) {
+    if(num == 0) return;
+
+    uintmax_t const mask = low_mask(width);
+    size_t const per_pack = num_per_pack<Pack>(width);
+
+    size_t shift;
+    size_t p = locate<Pack>(i, width, shift);
+    size_t left = per_pack - shift / width; // the number of integers left in the current pack
+    uintmax_t buf = uintmax_t(data[p]) >> shift;
+    for(size_t k = 0; k < num; k++) {
+        if(left == 0) {
+            buf = data[++p];
+            left = per_pack;
+        }
+        out[k] = buf & mask;
+        buf = (buf >> 1) >> (width - 1); // nb: the split shift ensures that this works for width = 64
+        --left;
+    }
+}
+
+/**
+ * \brief Writes an integer
+ * 
+ * The padding bits are not modified.
+ * 
+ * \tparam Pack the word pack type
+ * \param data the array of word packs
+ * \param i the index of the integer
+ * \param x the value to write
+ * \param width the bit width of each integer
+ * \param mask the bit mask corresponding to the width
+ */
+template<WordPackEligible Pack>
+inline void set(Pack* data, size_t const i, uintmax_t const x, size_t const width, uintmax_t const mask) {
+    size_t shift;
+    size_t const p = locate<Pack>(i, width, shift);
+    data[p] = (uintmax_t(data[p]) & ~(mask << shift)) | ((x & mask) << shift);
+}
+
+/**
+ * \brief Writes an integer of a fixed width
+ * 
+ * The padding bits are not modified.
+ * 
+ * \tparam width the bit width of each integer
+ * \tparam Pack the word pack type
+ * \param data the array of word packs
+ * \param i the index of the integer
+ * \param x the value to write
+ */
+template<size_t width, WordPackEligible Pack>
+inline void set(Pack* data, size_t const i, uintmax_t const x) {
+    constexpr uintmax_t mask = low_mask(width);
+    size_t shift;
+    size_t const p = locate<width, Pack>(i, shift);
+    data[p] = (uintmax_t(data[p]) & ~(mask << shift)) | ((x & mask) << shift);
+}
+
+/**
+ * \brief Adds a value to an integer
+ * 
+ * \tparam Overflow the overflow policy (\see word_packing::overflow)
+ * \tparam Pack the word pack type
+ * \param data the array of word packs
+ * \param i the index of the integer to modify
+ * \param d the value to add
+ * \param width the bit width of each integer
+ * \param mask the bit mask corresponding to the width
+ * \return the part of the sum that did not fit (always zero if the policy does not saturate)
+ */
+template<typename Overflow, WordPackEligible Pack>
+inline uintmax_t add(Pack* data, size_t const i, uintmax_t const d, size_t const width, uintmax_t const mask) {
+    size_t shift;
+    size_t const p = locate<Pack>(i, width, shift);
+
+    uintmax_t y;
+    uintmax_t const xp = data[p];
+    uintmax_t const carry = add_value<Overflow>((xp >> shift) & mask, d, mask, y);
+    data[p] = (xp & ~(mask << shift)) | (y << shift);
+    return carry;
+}
+
+/**
+ * \brief Adds a value to an integer of a fixed width
+ * 
+ * \tparam width the bit width of each integer
+ * \tparam Overflow the overflow policy (\see word_packing::overflow)
+ * \tparam Pack the word pack type
+ * \param data the array of word packs
+ * \param i the index of the integer to modify
+ * \param d the value to add
+ * \return the part of the sum that did not fit (always zero if the policy does not saturate)
+ */
+template<size_t width, typename Overflow, WordPackEligible Pack>
+inline uintmax_t add(Pack* data, size_t const i, uintmax_t const d) {
+    constexpr uintmax_t mask = low_mask(width);
+    size_t shift;
+    size_t const p = locate<width, Pack>(i, shift);
+
+    uintmax_t y;
+    uintmax_t const xp = data[p];
+    uintmax_t const carry = add_value<Overflow>((xp >> shift) & mask, d, mask, y);
+    data[p] = (xp & ~(mask << shift)) | (y << shift);
+    return carry;
+}
+
+}
+
+#endif
@@ -28,12 +28,15 @@
 #ifndef _PACKED_FIXED_WIDTH_INT_ACCESSOR_HPP
 #define _PACKED_FIXED_WIDTH_INT_ACCESSOR_HPP
 
+#include "../bit_order.hpp"
+#include "../overflow.hpp"
+#include "../stats.hpp"
 #include "impl.hpp"
 #include "int_ref.hpp"
 
 namespace word_packing::internal {
 
-template<size_t width_, WordPackEligible Pack = uintmax_t>
+template<size_t width_, WordPackEligible Pack = uintmax_t, typename BitOrder = bit_order::LsbFirst, typename Stats = stats::None>
 class PackedFixedWidthIntConstAccessor {
 private:
     Pack const* data_;
@@ -48,11 +51,15 @@ public:
     PackedFixedWidthIntConstAccessor(Pack const* data) : data_(data) {
     }
 
-    uintmax_t get(size_t i) const { return internal::get<width_>(data_, i); }
+    uintmax_t get(size_t i) const {
+        record_get<Stats, BitOrder, Pack>(i, width_);
+        return BitOrder::template get<width_>(data_, i);
+    }
+    uintmax_t get_bits(size_t bit_off, size_t nbits) const { return BitOrder::get_bits(data_, bit_off, nbits); }
     uintmax_t operator[](size_t i) const { return get(i); }
 };
 
-template<size_t width_, WordPackEligible Pack = uintmax_t>
+template<size_t width_, WordPackEligible Pack = uintmax_t, typename BitOrder = bit_order::LsbFirst, typename Stats = stats::None>
 class PackedFixedWidthIntAccessor {
 private:
     Pack* data_;
@@ -67,8 +74,26 @@ public:
     PackedFixedWidthIntAccessor(Pack* data) : data_(data) {
     }
 
-    uintmax_t get(size_t i) const { return internal::get<width_>(data_, i); }
-    void set(size_t i, uintmax_t x) { internal::set<width_>(data_, i, x); }
+    uintmax_t get(size_t i) const {
+        record_get<Stats, BitOrder, Pack>(i, width_);
+        return BitOrder::template get<width_>(data_, i);
+    }
+    void set(size_t i, uintmax_t x) {
+        record_set<Stats, BitOrder, Pack>(i, width_);
+        BitOrder::template set<width_>(data_, i, x);
+    }
+
+    uintmax_t get_bits(size_t bit_off, size_t nbits) const { return BitOrder::get_bits(data_, bit_off, nbits); }
+    void set_bits(size_t bit_off, size_t nbits, uintmax_t x) { BitOrder::set_bits(data_, bit_off, nbits, x); }
+
+    template<typename Overflow = overflow::Wrap>
+    uintmax_t add(size_t i, uintmax_t d) {
+        record_add<Stats, BitOrder, Pack>(i, width_);
+        return BitOrder::template add<width_, Overflow>(data_, i, d);
+    }
+
+    template<typename Overflow = overflow::Wrap>
+    uintmax_t increment(size_t i) { return add<Overflow>(i, 1); }
 
     uintmax_t operator[](size_t i) const { return get(i); }
     auto operator[](size_t i) { return IntRef(*this, i); }
@@ -28,12 +28,15 @@
 #ifndef _WORD_PACKING_INTERNAL_PACKED_INT_ACCESSOR_HPP
 #define _WORD_PACKING_INTERNAL_PACKED_INT_ACCESSOR_HPP
 
+#include "../bit_order.hpp"
+#include "../overflow.hpp"
+#include "../stats.hpp"
 #include "impl.hpp"
 #include "int_ref.hpp"
 
 namespace word_packing::internal {
 
-template<WordPackEligible Pack = uintmax_t>
+template<WordPackEligible Pack = uintmax_t, typename BitOrder = bit_order::LsbFirst, typename Stats = stats::None>
 class PackedIntConstAccessor {
 private:
     Pack const* data_;
@@ -52,11 +55,15 @@ public:
         assert(width_ <= std::numeric_limits<Pack>::digits);
     }
 
-    uintmax_t get(size_t i) const { return internal::get<Pack>(data_, i, width_, mask_); }
+    uintmax_t get(size_t i) const {
+        record_get<Stats, BitOrder, Pack>(i, width_);
+        return BitOrder::get(data_, i, width_, mask_);
+    }
+    uintmax_t get_bits(size_t bit_off, size_t nbits) const { return BitOrder::get_bits(data_, bit_off, nbits); }
     uintmax_t operator[](size_t i) const { return get(i); }
 };
 
-template<WordPackEligible Pack = uintmax_t>
+template<WordPackEligible Pack = uintmax_t, typename BitOrder = bit_order::LsbFirst, typename Stats = stats::None>
 class PackedIntAccessor {
 private:
     Pack* data_;
@@ -75,8 +82,26 @@ public:
         assert(width_ <= std::numeric_limits<Pack>::digits);
     }
 
-    uintmax_t get(size_t i) const { return internal::get(data_, i, width_, mask_); }
-    void set(size_t i, uintmax_t x) { internal::set(data_, i, x, width_, mask_); }
+    uintmax_t get(size_t i) const {
+        record_get<Stats, BitOrder, Pack>(i, width_);
+        return BitOrder::get(data_, i, width_, mask_);
+    }
+    void set(size_t i, uintmax_t x) {
+        record_set<Stats, BitOrder, Pack>(i, width_);
+        BitOrder::set(data_, i, x, width_, mask_);
+    }
+
+    uintmax_t get_bits(size_t bit_off, size_t nbits) const { return BitOrder::get_bits(data_, bit_off, nbits); }
+    void set_bits(size_t bit_off, size_t nbits, uintmax_t x) { BitOrder::set_bits(data_, bit_off, nbits, x); }
+
+    template<typename Overflow = overflow::Wrap>
+    uintmax_t add(size_t i, uintmax_t d) {
+        record_add<Stats, BitOrder, Pack>(i, width_);
+        return BitOrder::template add<Overflow>(data_, i, d, width_, mask_);
+    }
+
+    template<typename Overflow = overflow::Wrap>
+    uintmax_t increment(size_t i) { return add<Overflow>(i, 1); }
 
     uintmax_t operator[](size_t i) const { return get(i); }
     auto operator[](size_t i) { return IntRef(*this, i); }
@@ -0,0 +1,66 @@
+/**
+ * word_packing/internal/parallel.hpp
+ * part of pdinklag/word-packing
+ * 
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _WORD_PACKING_INTERNAL_PARALLEL_HPP
+#define _WORD_PACKING_INTERNAL_PARALLEL_HPP
+
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace word_packing::internal {
+
+/**
+ * \brief Runs the given function for each task number using the given number of threads
+ *
+ * Tasks are distributed to threads in a round-robin manner.
+ * If only one thread is requested or there is only one task, the tasks are processed in the calling thread.
+ *
+ * \tparam F the task function type, called with the task number
+ * \param num_threads the number of threads to use
+ * \param num_tasks the number of tasks
+ * \param f the task function
+ */
+template<typename F>
+void parallel_for(size_t const num_threads, size_t const num_tasks, F f) {
+    if(num_threads <= 1 || num_tasks <= 1) {
+        for(size_t t = 0; t < num_tasks; t++) f(t);
+    } else {
+        std::vector<std::thread> threads;
+        threads.reserve(num_threads);
+        for(size_t k = 0; k < num_threads; k++) {
+            threads.emplace_back([&, k](){
+                for(size_t t = k; t < num_tasks; t += num_threads) f(t);
+            });
+        }
+        for(auto& thread : threads) thread.join();
+    }
+}
+
+}
+
+#endif
@@ -28,9 +28,15 @@
 #ifndef _WORD_PACKING_INTERNAL_UTIL_HPP
 #define _WORD_PACKING_INTERNAL_UTIL_HPP
 
+#include <bit>
+#include <concepts>
 #include <cstddef>
 #include <cstdint>
 
+#ifdef __BMI2__
+#include <immintrin.h>
+#endif
+
 namespace word_packing::internal {
     constexpr uintmax_t low_mask(size_t const bits) {
         return ~((UINTMAX_MAX << (bits - 1)) << 1); // nb: bits > 0 is assumed!
@@ -43,6 +49,33 @@ namespace word_packing::internal {
     constexpr size_t idiv_ceil(size_t const a, size_t const b) {
         return ((a + b) - 1ULL) / b;
     }
+
+    constexpr uint64_t hash64(uint64_t x) {
+        // the finalizer of splitmix64
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+        return x ^ (x >> 31);
+    }
+
+    template<std::unsigned_integral T>
+    constexpr T big_endian(T const x) {
+        // converts between native and big-endian byte order (the conversion is symmetric)
+        static_assert(sizeof(T) <= 8);
+        if constexpr(std::endian::native == std::endian::big || sizeof(T) == 1) return x;
+        else if constexpr(sizeof(T) == 2) return __builtin_bswap16(x);
+        else if constexpr(sizeof(T) == 4) return __builtin_bswap32(x);
+        else return __builtin_bswap64(x);
+    }
+
+    inline size_t select1_in_word(uint64_t x, size_t const k) {
+        // nb: x is assumed to have more than k set bits
+    #ifdef __BMI2__
+        return std::countr_zero(_pdep_u64(1ULL << k, x));
+    #else
+        for(size_t j = 0; j < k; j++) x &= x - 1; // clear lowest set bit
+        return std::countr_zero(x);
+    #endif
+    }
 }
 
 #endif
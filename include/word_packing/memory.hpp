@@ -0,0 +1,137 @@
+/**
+ * word_packing/memory.hpp
+ * part of pdinklag/word-packing
+ * 
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _WORD_PACKING_MEMORY_HPP
+#define _WORD_PACKING_MEMORY_HPP
+
+#include <atomic>
+#include <cstddef>
+
+namespace word_packing {
+
+/**
+ * \brief Counts the heap memory allocated by containers
+ *
+ * A counter observes allocations only while it is installed using \ref set_allocation_counter .
+ * Memory is reported as freed to the counter that observed its allocation, so a counter must outlive the containers allocated while it was installed.
+ * The counters are updated atomically and may be shared between threads.
+ */
+class AllocationCounter {
+private:
+    std::atomic<size_t> current_;
+    std::atomic<size_t> peak_;
+    std::atomic<size_t> total_;
+    std::atomic<size_t> num_allocations_;
+
+public:
+    /**
+     * \brief Constructs a counter that has not observed any allocations
+     *
+     */
+    AllocationCounter() : current_(0), peak_(0), total_(0), num_allocations_(0) {
+    }
+
+    AllocationCounter(AllocationCounter const&) = delete;
+    AllocationCounter& operator=(AllocationCounter const&) = delete;
+
+    /**
+     * \brief Records an allocation
+     *
+     * \param bytes the number of allocated bytes
+     */
+    void allocated(size_t const bytes) {
+        size_t const current = current_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        size_t peak = peak_.load(std::memory_order_relaxed);
+        while(current > peak && !peak_.compare_exchange_weak(peak, current, std::memory_order_relaxed)) {}
+        total_.fetch_add(bytes, std::memory_order_relaxed);
+        num_allocations_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * \brief Records a deallocation
+     *
+     * \param bytes the number of freed bytes
+     */
+    void freed(size_t const bytes) {
+        current_.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+
+    /**
+     * \brief Reports the number of bytes currently allocated
+     *
+     * \return the number of allocated bytes that have not been freed yet
+     */
+    size_t current_bytes() const { return current_.load(std::memory_order_relaxed); }
+
+    /**
+     * \brief Reports the maximum number of bytes allocated at the same time
+     *
+     * \return the peak number of allocated bytes
+     */
+    size_t peak_bytes() const { return peak_.load(std::memory_order_relaxed); }
+
+    /**
+     * \brief Reports the total number of bytes allocated
+     *
+     * \return the total number of allocated bytes, regardless of whether they have been freed
+     */
+    size_t total_bytes() const { return total_.load(std::memory_order_relaxed); }
+
+    /**
+     * \brief Reports the number of allocations
+     *
+     * \return the number of allocations
+     */
+    size_t num_allocations() const { return num_allocations_.load(std::memory_order_relaxed); }
+};
+
+namespace internal {
+
+inline std::atomic<AllocationCounter*> allocation_counter_ = nullptr;
+
+}
+
+/**
+ * \brief Installs the global allocation counter
+ *
+ * All subsequent allocations of containers are reported to the given counter.
+ * No counter is installed by default, in which case allocations are not counted at all.
+ *
+ * \param counter the counter to install, or \c nullptr to stop counting
+ */
+inline void set_allocation_counter(AllocationCounter* const counter) { internal::allocation_counter_.store(counter, std::memory_order_relaxed); }
+
+/**
+ * \brief Reports the currently installed global allocation counter
+ *
+ * \return the installed counter, or \c nullptr if none is installed
+ */
+inline AllocationCounter* allocation_counter() { return internal::allocation_counter_.load(std::memory_order_relaxed); }
+
+}
+
+#endif
@@ -0,0 +1,207 @@
+/**
+ * word_packing/orc.hpp
+ * part of pdinklag/word-packing
+ * 
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _WORD_PACKING_ORC_HPP
+#define _WORD_PACKING_ORC_HPP
+
+#include "internal/bit_stream.hpp"
+#include "packed_int_vector.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <vector>
+
+namespace word_packing::internal::orc {
+
+// the sub-encodings of ORC's integer run-length encoding, version 2
+constexpr uint8_t SHORT_REPEAT = 0;
+constexpr uint8_t DIRECT = 1;
+constexpr uint8_t PATCHED_BASE = 2;
+constexpr uint8_t DELTA = 3;
+
+constexpr size_t MIN_REPEAT = 3;
+constexpr size_t MAX_SHORT_REPEAT = 10;
+constexpr size_t MAX_DIRECT = 512;
+
+// decodes the five-bit width code of a bit-packed run
+constexpr size_t decode_width(size_t const code) {
+    constexpr size_t large[] = { 26, 28, 30, 32, 40, 48, 56, 64 };
+    return code < 24 ? code + 1 : large[code - 24];
+}
+
+// rounds a width up to the next width that can be encoded for a bit-packed run
+constexpr size_t round_width(size_t const w) {
+    if(w <= 24) return std::max(w, size_t(1));
+    if(w <= 32) return w + (w % 2);
+    return idiv_ceil(w, 8) * 8;
+}
+
+// encodes a width, which must have been rounded using round_width, as the five-bit width code of a bit-packed run
+constexpr size_t encode_width(size_t const w) {
+    if(w <= 24) return w - 1;
+    if(w <= 32) return 24 + (w - 26) / 2;
+    return 28 + (w - 40) / 8;
+}
+
+}
+
+/**
+ * \brief Codecs for the Apache ORC file format
+ */
+namespace word_packing::orc {
+
+/**
+ * \brief Decodes a stream in the integer run-length encoding (version 2) of Apache ORC into a packed integer vector
+ * 
+ * The integers are decoded as unsigned.
+ * Only the short repeat and direct sub-encodings are supported, the latter consisting of runs of bit-packed integers.
+ * Because ORC packs integers starting from the most significant bit, each integer is decoded individually.
+ * 
+ * \tparam Pack the word pack type of the vector
+ * \param in the encoded stream
+ * \param in_size the size, in bytes, of the encoded stream
+ * \param num the number of integers to decode
+ * \param out the vector to decode into, which must have room for the decoded integers
+ * \param out_off the position in the vector of the first decoded integer
+ * \return true if the integers were decoded
+ * \return false if the stream ended prematurely, uses an unsupported sub-encoding or contains an integer that exceeds the width of the vector,
+ * in which case the vector contents are undefined
+ */
+template<WordPackEligible Pack>
+bool decode_rle_v2(uint8_t const* in, size_t const in_size, size_t const num, PackedIntVector<Pack>& out, size_t const out_off = 0) {
+    assert(out_off + num <= out.size());
+
+    uint8_t const* p = in;
+    uint8_t const* const end = in + in_size;
+    uintmax_t const mask = internal::low_mask(out.width());
+
+    size_t i = 0;
+    while(i < num) {
+        if(p == end) return false;
+        uint8_t const header = *p++;
+
+        size_t const remaining = num - i;
+        switch(header >> 6) {
+            case internal::orc::SHORT_REPEAT: {
+                size_t const value_bytes = ((header >> 3) & 0x07) + 1;
+                size_t const count = (header & 0x07) + internal::orc::MIN_REPEAT;
+                if(value_bytes > size_t(end - p)) return false;
+
+                uintmax_t v = 0;
+                for(size_t b = 0; b < value_bytes; b++) v = (v << 8) | p[b];
+                p += value_bytes;
+                if(v & ~mask) return false;
+
+                size_t const m = std::min(count, remaining);
+                for(size_t j = 0; j < m; j++) out.set(out_off + i + j, v);
+                i += m;
+                break;
+            }
+
+            case internal::orc::DIRECT: {
+                if(p == end) return false;
+                size_t const w = internal::orc::decode_width((header >> 1) & 0x1F);
+                size_t const count = ((size_t(header & 0x01) << 8) | *p++) + 1;
+                size_t const run_bytes = internal::idiv_ceil(count * w, 8);
+                if(run_bytes > size_t(end - p)) return false;
+
+                size_t const m = std::min(count, remaining);
+                for(size_t j = 0; j < m; j++) {
+                    uintmax_t const v = internal::load_bits_msb(p, run_bytes, j * w, w);
+                    if(v & ~mask) return false;
+                    out.set(out_off + i + j, v);
+                }
+                p += run_bytes;
+                i += m;
+                break;
+            }
+
+            default:
+                return false; // patched base and delta encodings are not supported
+        }
+    }
+    return true;
+}
+
+/**
+ * \brief Encodes a packed integer vector in the integer run-length encoding (version 2) of Apache ORC
+ * 
+ * The integers are encoded as unsigned.
+ * Runs of at least three equal integers are encoded using the short repeat sub-encoding,
+ * all other integers are bit-packed using the direct sub-encoding.
+ * 
+ * \tparam Pack the word pack type of the vector
+ * \param in the vector to encode
+ * \param out the byte stream to append the encoded stream to
+ */
+template<WordPackEligible Pack>
+void encode_rle_v2(PackedIntVector<Pack> const& in, std::vector<uint8_t>& out) {
+    size_t const n = in.size();
+
+    // computes the length of the run starting at i, but no more than max
+    auto run_length = [&](size_t const i, size_t const max){
+        auto const v = in[i];
+        size_t j = i + 1;
+        while(j < n && j - i < max && in[j] == v) ++j;
+        return j - i;
+    };
+
+    size_t i = 0;
+    while(i < n) {
+        size_t const r = run_length(i, internal::orc::MAX_SHORT_REPEAT);
+        if(r >= internal::orc::MIN_REPEAT) {
+            // short repeat
+            uintmax_t const v = in[i];
+            size_t const value_bytes = std::max(internal::idiv_ceil(std::bit_width(v), 8), size_t(1));
+            out.push_back(uint8_t((internal::orc::SHORT_REPEAT << 6) | ((value_bytes - 1) << 3) | (r - internal::orc::MIN_REPEAT)));
+            for(size_t b = value_bytes; b > 0; b--) out.push_back(uint8_t(v >> (8 * (b - 1))));
+            i += r;
+        } else {
+            // direct, until a run starts
+            size_t j = i + 1;
+            uintmax_t max = in[i];
+            while(j < n && j - i < internal::orc::MAX_DIRECT && run_length(j, internal::orc::MIN_REPEAT) < internal::orc::MIN_REPEAT) {
+                max = std::max(max, uintmax_t(in[j]));
+                ++j;
+            }
+
+            size_t const m = j - i;
+            size_t const w = internal::orc::round_width(std::bit_width(max));
+            out.push_back(uint8_t((internal::orc::DIRECT << 6) | (internal::orc::encode_width(w) << 1) | ((m - 1) >> 8)));
+            out.push_back(uint8_t(m - 1));
+
+            size_t const start = out.size();
+            out.resize(start + internal::idiv_ceil(m * w, 8), 0);
+            for(size_t k = 0; k < m; k++) internal::store_bits_msb(out.data() + start, k * w, w, in[i + k]);
+            i += m;
+        }
+    }
+}
+
+}
+
+#endif
@@ -0,0 +1,120 @@
+/**
+ * word_packing/overflow.hpp
+ * part of pdinklag/word-packing
+ * 
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _WORD_PACKING_OVERFLOW_HPP
+#define _WORD_PACKING_OVERFLOW_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+/**
+ * \brief Overflow policies for arithmetic on packed integers
+ *
+ * The policies are passed as template parameters to the `add` and `increment` functions of containers and accessors.
+ */
+namespace word_packing::overflow {
+
+/**
+ * \brief Overflow policy that wraps around, keeping only the low bits of the result
+ *
+ * This is the behaviour of writing the sum using `set`.
+ */
+struct Wrap {
+    static constexpr bool saturates = false;
+};
+
+/**
+ * \brief Overflow policy that saturates at the maximum value representable with the integer width
+ *
+ */
+struct Saturate {
+    static constexpr bool saturates = true;
+};
+
+/**
+ * \brief Overflow policy that saturates and records the excess in a map
+ *
+ * A saturated integer serves as an escape marker; its actual value is the maximum plus the recorded excess.
+ * Unlike the other policies, this policy is stateful and passed as an argument to `add` and `increment`.
+ */
+class Escape {
+private:
+    std::unordered_map<size_t, uintmax_t> excess_;
+
+public:
+    static constexpr bool saturates = true;
+
+    /**
+     * \brief Records excess for an integer
+     *
+     * \param i the index of the integer
+     * \param carry the excess that did not fit into the integer
+     */
+    void record(size_t const i, uintmax_t const carry) {
+        if(carry) excess_[i] += carry;
+    }
+
+    /**
+     * \brief Reports the recorded excess for an integer
+     *
+     * \param i the index of the integer
+     * \return the recorded excess, or zero if the integer never overflowed
+     */
+    uintmax_t excess(size_t const i) const {
+        auto const it = excess_.find(i);
+        return it != excess_.end() ? it->second : 0;
+    }
+
+    /**
+     * \brief Retrieves the actual value of an integer
+     *
+     * \tparam Container the container type
+     * \param c the container
+     * \param i the index of the integer
+     * \return the integer stored in the container plus its recorded excess
+     */
+    template<typename Container>
+    uintmax_t get(Container const& c, size_t const i) const { return c.get(i) + excess(i); }
+
+    /**
+     * \brief Reports the number of integers that overflowed
+     *
+     * \return the number of integers with recorded excess
+     */
+    size_t size() const { return excess_.size(); }
+
+    /**
+     * \brief Forgets all recorded excess
+     *
+     */
+    void clear() { excess_.clear(); }
+};
+
+}
+
+#endif
@@ -0,0 +1,241 @@
+/**
+ * word_packing/packed_count_min_sketch.hpp
+ * part of pdinklag/word-packing
+ * 
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _WORD_PACKING_PACKED_COUNT_MIN_SKETCH_HPP
+#define _WORD_PACKING_PACKED_COUNT_MIN_SKETCH_HPP
+
+#include "packed_fixed_width_int_vector.hpp"
+
+#include <algorithm>
+#include <vector>
+
+namespace word_packing {
+
+/**
+ * \brief Count-min sketch with packed saturating counters
+ *
+ * The sketch consists of d rows of counters of a fixed width.
+ * Each key is hashed to one counter per row, and the frequency estimate of a key is the minimum of its counters.
+ * Counters saturate instead of wrapping around, so estimates never underestimate the true frequency (up to saturation).
+ *
+ * Using conservative update, only the counters of a key that are below its new estimate are raised,
+ * which reduces the overestimation caused by collisions.
+ *
+ * \tparam counter_width_ the width per counter
+ * \tparam Pack the word pack type of the counter rows
+ */
+template<size_t counter_width_, WordPackEligible Pack = uintmax_t>
+class PackedCountMinSketch {
+private:
+    static constexpr size_t PACK_BITS = std::numeric_limits<Pack>::digits;
+    static constexpr uintmax_t MAX_COUNT = internal::low_mask(counter_width_);
+    static constexpr size_t MAX_ROWS = 16;
+
+    using Row = PackedFixedWidthIntVector<counter_width_, Pack>;
+
+    size_t num_rows_;
+    size_t num_columns_;
+    bool conservative_;
+    std::vector<Row> rows_;
+
+    // computes the column of the key in each row using double hashing
+    void columns(uint64_t const key, size_t* cols) const {
+        uint64_t const h1 = internal::hash64(key);
+        uint64_t const h2 = internal::hash64(h1) | 1ULL;
+        for(size_t r = 0; r < num_rows_; r++) {
+            cols[r] = (((h1 + r * h2) >> 32) * num_columns_) >> 32;
+        }
+    }
+
+    void prefetch(size_t const* cols) const {
+        for(size_t r = 0; r < num_rows_; r++) {
+            __builtin_prefetch(rows_[r].data() + (cols[r] * counter_width_) / PACK_BITS);
+        }
+    }
+
+    uintmax_t estimate(size_t const* cols) const {
+        uintmax_t est = MAX_COUNT;
+        for(size_t r = 0; r < num_rows_; r++) est = std::min(est, rows_[r].get(cols[r]));
+        return est;
+    }
+
+    void add(size_t const* cols, uintmax_t const count) {
+        if(conservative_) {
+            uintmax_t const est = estimate(cols);
+            uintmax_t const target = est + std::min(count, MAX_COUNT - est); // nb: saturating, est + count may wrap
+            for(size_t r = 0; r < num_rows_; r++) {
+                if(rows_[r].get(cols[r]) < target) rows_[r].set(cols[r], target);
+            }
+        } else {
+            for(size_t r = 0; r < num_rows_; r++) rows_[r].template add<overflow::Saturate>(cols[r], count);
+        }
+    }
+
+public:
+    /**
+     * \brief Constructs an empty sketch
+     *
+     * \param num_rows the number of rows, at most 16
+     * \param num_columns the number of counters per row
+     * \param conservative whether to use conservative update
+     */
+    PackedCountMinSketch(size_t const num_rows, size_t const num_columns, bool const conservative = false)
+        : num_rows_(num_rows), num_columns_(num_columns), conservative_(conservative) {
+
+        assert(num_rows_ > 0);
+        assert(num_rows_ <= MAX_ROWS);
+        assert(num_columns_ > 0);
+        assert(num_columns_ <= UINT32_MAX);
+
+        rows_.reserve(num_rows_);
+        for(size_t r = 0; r < num_rows_; r++) rows_.emplace_back(num_columns_);
+        clear();
+    }
+
+    /**
+     * \brief Adds occurrences of a key
+     *
+     * \param key the key
+     * \param count the number of occurrences to add
+     */
+    void add(uint64_t const key, uintmax_t const count = 1) {
+        size_t cols[MAX_ROWS];
+        columns(key, cols);
+        add(cols, count);
+    }
+
+    /**
+     * \brief Adds one occurrence of each of the given keys
+     *
+     * The counters of upcoming keys are prefetched in all rows while the current key is being added.
+     * Each key is hashed only once, the columns of the upcoming keys are buffered.
+     *
+     * \param keys the keys
+     * \param num the number of keys
+     */
+    void add_many(uint64_t const* keys, size_t const num) {
+        constexpr size_t LOOKAHEAD = 8;
+
+        size_t cols[LOOKAHEAD][MAX_ROWS];
+        auto prepare = [&](size_t const i){
+            columns(keys[i], cols[i % LOOKAHEAD]);
+            prefetch(cols[i % LOOKAHEAD]);
+        };
+
+        for(size_t i = 0; i < std::min(num, LOOKAHEAD); i++) prepare(i);
+        for(size_t i = 0; i < num; i++) {
+            add(cols[i % LOOKAHEAD], 1);
+            if(i + LOOKAHEAD < num) prepare(i + LOOKAHEAD); // nb: reuses the columns of the current key
+        }
+    }
+
+    /**
+     * \brief Estimates the frequency of a key
+     *
+     * \param key the key
+     * \return the minimum of the key's counters
+     */
+    uintmax_t estimate(uint64_t const key) const {
+        size_t cols[MAX_ROWS];
+        columns(key, cols);
+        return estimate(cols);
+    }
+
+    /**
+     * \brief Estimates the frequencies of the given keys
+     *
+     * The counters of upcoming keys are prefetched in all rows while the current key is being estimated.
+     * Each key is hashed only once, the columns of the upcoming keys are buffered.
+     *
+     * \param keys the keys
+     * \param num the number of keys
+     * \param out the output array, receiving the estimate for each key
+     */
+    void estimate_many(uint64_t const* keys, size_t const num, uintmax_t* out) const {
+        constexpr size_t LOOKAHEAD = 8;
+
+        size_t cols[LOOKAHEAD][MAX_ROWS];
+        auto prepare = [&](size_t const i){
+            columns(keys[i], cols[i % LOOKAHEAD]);
+            prefetch(cols[i % LOOKAHEAD]);
+        };
+
+        for(size_t i = 0; i < std::min(num, LOOKAHEAD); i++) prepare(i);
+        for(size_t i = 0; i < num; i++) {
+            out[i] = estimate(cols[i % LOOKAHEAD]);
+            if(i + LOOKAHEAD < num) prepare(i + LOOKAHEAD); // nb: reuses the columns of the current key
+        }
+    }
+
+    /**
+     * \brief Resets all counters to zero
+     *
+     */
+    void clear() {
+        for(auto& row : rows_) std::fill(row.data(), row.data() + num_packs_required<Pack>(num_columns_, counter_width_), Pack(0));
+    }
+
+    /**
+     * \brief Reports the number of rows
+     *
+     * \return the number of rows
+     */
+    size_t num_rows() const { return num_rows_; }
+
+    /**
+     * \brief Reports the number of counters per row
+     *
+     * \return the number of counters per row
+     */
+    size_t num_columns() const { return num_columns_; }
+
+    /**
+     * \brief Reports the width of the counters
+     *
+     * \return the width, in bits, of the counters
+     */
+    size_t counter_width() const { return counter_width_; }
+
+    /**
+     * \brief Tests whether conservative update is used
+     *
+     * \return true if conservative update is used
+     * \return false otherwise
+     */
+    bool conservative() const { return conservative_; }
+
+    /**
+     * \brief Reports the number of heap bytes used by the sketch
+     *
+     * \return the number of heap bytes used
+     */
+    size_t memory_usage() const { return internal::memory_usage(rows_); }
+};
+
+}
+
+#endif
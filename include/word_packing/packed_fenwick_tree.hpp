@@ -0,0 +1,223 @@
+/**
+ * word_packing/packed_fenwick_tree.hpp
+ * part of pdinklag/word-packing
+ * 
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _WORD_PACKING_PACKED_FENWICK_TREE_HPP
+#define _WORD_PACKING_PACKED_FENWICK_TREE_HPP
+
+#include "packed_int_vector.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <vector>
+
+namespace word_packing {
+
+/**
+ * \brief Fenwick tree (binary indexed tree) over packed counters
+ *
+ * In a Fenwick tree over counters of width w, the node with (one-based) number i stores the sum of the
+ * 2^k counters preceding and including the i-th counter, where k is the number of trailing zeros of i.
+ * This sum fits into w+k bits, so the nodes are laid out level-wise: level k contains all nodes with k trailing zeros
+ * in a packed integer vector of width w+k.
+ * The widths are capped at the width of the word pack type, so node sums on the upper levels may not fit even if all counters stay below 2^w.
+ * Updates therefore check that the affected node sums fit into their levels and are rejected otherwise.
+ *
+ * Updates and prefix sums are performed in O(log n) time, where n is the number of counters.
+ *
+ * \tparam Pack the word pack type
+ */
+template<WordPackEligible Pack = uintmax_t>
+class PackedFenwickTree {
+private:
+    static constexpr size_t MAX_WIDTH = std::numeric_limits<Pack>::digits;
+
+    size_t size_;
+    size_t counter_width_;
+    std::vector<PackedIntVector<Pack>> levels_;
+
+    // the level of the node with the given (one-based) number
+    static size_t level(size_t const i) { return std::countr_zero(i); }
+
+    // the position of the node with the given (one-based) number within its level
+    static size_t pos(size_t const i, size_t const k) { return i >> (k + 1); }
+
+    uintmax_t node(size_t const i) const {
+        size_t const k = level(i);
+        return levels_[k].get(pos(i, k));
+    }
+
+    void allocate() {
+        size_t const num_levels = size_ ? std::bit_width(size_) : 0;
+        levels_.reserve(num_levels);
+        for(size_t k = 0; k < num_levels; k++) {
+            // level k contains the nodes (2j+1) * 2^k <= size
+            size_t const num = ((size_ >> k) + 1) / 2;
+            PackedIntVector<Pack> level(num, std::min(MAX_WIDTH, counter_width_ + k));
+            std::fill(level.data(), level.data() + num_packs_required<Pack>(num, level.width()), Pack(0));
+            levels_.push_back(std::move(level));
+        }
+    }
+
+public:
+    /**
+     * \brief Constructs an empty Fenwick tree
+     *
+     */
+    PackedFenwickTree() : size_(0), counter_width_(0) {
+    }
+
+    /**
+     * \brief Constructs a Fenwick tree over the given number of counters, all initialized to zero
+     *
+     * \param size the number of counters
+     * \param counter_width the width, in bits, of each counter
+     */
+    PackedFenwickTree(size_t const size, size_t const counter_width) : size_(size), counter_width_(counter_width) {
+        assert(counter_width_ > 0);
+        assert(counter_width_ <= MAX_WIDTH);
+        allocate();
+    }
+
+    /**
+     * \brief Constructs a Fenwick tree over the given counters
+     *
+     * The construction takes linear time. The counter width equals the width of the given vector.
+     * The node sums of the given counters must fit into their levels (\see add).
+     *
+     * \tparam CounterPack the word pack type of the counters
+     * \param counters the initial counters
+     */
+    template<WordPackEligible CounterPack>
+    PackedFenwickTree(PackedIntVector<CounterPack> const& counters) : PackedFenwickTree(counters.size(), counters.width()) {
+        for(size_t i = 1; i <= size_; i++) {
+            // sum up the counter and the children (i - 2^m for m < k)
+            size_t const k = level(i);
+            uintmax_t sum = counters.get(i - 1);
+            for(size_t m = 0; m < k; m++) sum += node(i - (size_t(1) << m));
+            assert(sum <= internal::low_mask(levels_[k].width()));
+            levels_[k].set(pos(i, k), sum);
+        }
+    }
+
+    /**
+     * \brief Adds a value to a counter
+     *
+     * The value may be negative, but the counter must not become negative, and it must fit into the counter width.
+     * If any affected node sum would become negative or exceed the width of its level, the tree is left unchanged.
+     *
+     * \param i the index of the counter
+     * \param delta the value to add
+     * \return true if the value was added
+     * \return false if a node sum would not fit into its level, in which case the tree is unchanged
+     */
+    bool add(size_t const i, intmax_t const delta) {
+        assert(i < size_);
+        for(size_t j = i + 1; j <= size_; j += (j & -j)) {
+            size_t const k = level(j);
+            size_t const p = pos(j, k);
+            uintmax_t const old = levels_[k].get(p);
+            uintmax_t const x = old + uintmax_t(delta); // nb: wraps around correctly for negative deltas
+            if((delta >= 0 ? x < old : x > old) || x > internal::low_mask(levels_[k].width())) {
+                // roll back the nodes updated so far
+                for(size_t r = i + 1; r < j; r += (r & -r)) {
+                    size_t const kr = level(r);
+                    levels_[kr].set(pos(r, kr), levels_[kr].get(pos(r, kr)) - uintmax_t(delta));
+                }
+                return false;
+            }
+            levels_[k].set(p, x);
+        }
+        return true;
+    }
+
+    /**
+     * \brief Computes the sum of the first i counters
+     *
+     * \param i the number of counters to sum up, at most \ref size
+     * \return the sum of the counters in the range [0, i)
+     */
+    uintmax_t prefix_sum(size_t const i) const {
+        assert(i <= size_);
+        uintmax_t sum = 0;
+        for(size_t j = i; j > 0; j &= j - 1) sum += node(j);
+        return sum;
+    }
+
+    /**
+     * \brief Retrieves a single counter
+     *
+     * \param i the index of the counter
+     * \return the value of the counter
+     */
+    uintmax_t get(size_t const i) const { return prefix_sum(i + 1) - prefix_sum(i); }
+
+    /**
+     * \brief Searches by cumulative value
+     *
+     * \param sum the cumulative value to search
+     * \return the largest i such that the sum of the first i counters is at most the given value
+     */
+    size_t find(uintmax_t sum) const {
+        size_t i = 0;
+        for(size_t step = size_ ? std::bit_floor(size_) : 0; step > 0; step >>= 1) {
+            size_t const j = i + step;
+            if(j <= size_) {
+                uintmax_t const x = node(j);
+                if(x <= sum) {
+                    i = j;
+                    sum -= x;
+                }
+            }
+        }
+        return i;
+    }
+
+    /**
+     * \brief Reports the width of the counters
+     *
+     * \return the width, in bits, of the counters
+     */
+    size_t counter_width() const { return counter_width_; }
+
+    /**
+     * \brief Reports the number of counters
+     *
+     * \return the number of counters
+     */
+    size_t size() const { return size_; }
+
+    /**
+     * \brief Reports the number of heap bytes used by the tree
+     *
+     * \return the number of heap bytes used
+     */
+    size_t memory_usage() const { return internal::memory_usage(levels_); }
+};
+
+}
+
+#endif
@@ -28,9 +28,14 @@
 #ifndef _WORD_PACKING_PACKED_FIXED_INT_VECTOR_HPP
 #define _WORD_PACKING_PACKED_FIXED_INT_VECTOR_HPP
 
+#include "bit_order.hpp"
+#include "internal/alloc.hpp"
+#include "internal/bit_ranges.hpp"
 #include "internal/container.hpp"
+#include "stats.hpp"
 
 #include <algorithm>
+#include <functional>
 #include <memory>
 
 namespace word_packing {
@@ -45,18 +50,32 @@ namespace word_packing {
  * 
  * \tparam width_ the width per stored integer
  * \tparam Pack the unsigned integer type to pack words into
+ * \tparam BitOrder the order in which integers are packed (\see word_packing::bit_order)
+ * \tparam Stats the instrumentation policy (\see word_packing::stats)
  */
-template<size_t width_, WordPackEligible Pack = uintmax_t>
-class PackedFixedWidthIntVector : public internal::IntContainer<PackedFixedWidthIntVector<width_, Pack>> {
+template<size_t width_, WordPackEligible Pack = uintmax_t, typename BitOrder = bit_order::LsbFirst, typename Stats = stats::None>
+class PackedFixedWidthIntVector : public internal::IntContainer<PackedFixedWidthIntVector<width_, Pack, BitOrder, Stats>> {
 private:
     static_assert(width_ > 0, "width cannot be zero");
     static_assert(width_ <= std::numeric_limits<Pack>::digits, "word pack width must be at list the word width");
 
     size_t size_;
     size_t capacity_;
-    std::unique_ptr<Pack[]> data_;
+    internal::CountedArray<Pack> data_;
 
 public:
+    /**
+     * \brief The bit order policy
+     * 
+     */
+    using BitOrderType = BitOrder;
+
+    /**
+     * \brief The instrumentation policy
+     * 
+     */
+    using StatsType = Stats;
+
     /**
      * \brief Constructs an empty vector of size zero
      * 
@@ -67,12 +86,12 @@ public:
     PackedFixedWidthIntVector(PackedFixedWidthIntVector&&) = default;
     PackedFixedWidthIntVector& operator=(PackedFixedWidthIntVector&&) = default;
 
-    PackedFixedWidthIntVector(PackedFixedWidthIntVector const& other) { *this = other; }
+    PackedFixedWidthIntVector(PackedFixedWidthIntVector const& other) : internal::IntContainer<PackedFixedWidthIntVector>() { *this = other; }
     PackedFixedWidthIntVector& operator=(PackedFixedWidthIntVector const& other) {
         size_ = other.size_;
-        capacity_ = other.capacity_;
-        data_ = std::make_unique<Pack[]>(num_packs_required<Pack>(size_, width_));
-        std::copy(other.data(), other.data() + num_packs_required<Pack>(size_, width_), data());
+        capacity_ = other.size_; // nb: copies are allocated only for the contained integers
+        data_ = internal::make_counted_array<Pack>(BitOrder::template num_packs<Pack>(size_, width_));
+        std::copy(other.data(), other.data() + BitOrder::template num_packs<Pack>(size_, width_), data());
         return *this;
     }
 
@@ -85,7 +104,7 @@ public:
      */
     PackedFixedWidthIntVector(size_t size) : size_(size), capacity_(size) {
         if(capacity_ > 0) {
-            data_ = std::make_unique<Pack[]>(num_packs_required<Pack>(size_, width_));
+            data_ = internal::make_counted_array<Pack>(BitOrder::template num_packs<Pack>(size_, width_));
         }
     }
 
@@ -95,7 +114,10 @@ public:
      * \param i the index of the integer
      * \return the integer at the given index
      */
-    uintmax_t get(size_t i) const { return internal::get<width_>(data_.get(), i); }
+    uintmax_t get(size_t i) const {
+        internal::record_get<Stats, BitOrder, Pack>(i, width_);
+        return BitOrder::template get<width_>(data_.get(), i);
+    }
 
     /**
      * \brief Writes a specific integer in the vector
@@ -103,7 +125,84 @@ public:
      * \param i the index of the integer
      * \param value the value to write to the specified index
      */
-    void set(size_t i, uintmax_t value) { internal::set<width_>(data_.get(), i, value); }
+    void set(size_t i, uintmax_t value) {
+        internal::record_set<Stats, BitOrder, Pack>(i, width_);
+        BitOrder::template set<width_>(data_.get(), i, value);
+    }
+
+    /**
+     * \brief Adds a value to a specific integer in the vector
+     * 
+     * The affected word packs are read and written only once.
+     * 
+     * \tparam Overflow the overflow policy (\see word_packing::overflow)
+     * \param i the index of the integer
+     * \param d the value to add
+     * \return the part of the sum that did not fit (always zero if the policy does not saturate)
+     */
+    template<typename Overflow = overflow::Wrap>
+    uintmax_t add(size_t i, uintmax_t d) {
+        internal::record_add<Stats, BitOrder, Pack>(i, width_);
+        return BitOrder::template add<width_, Overflow>(data_.get(), i, d);
+    }
+    using internal::IntContainer<PackedFixedWidthIntVector<width_, Pack, BitOrder, Stats>>::add;
+
+    /**
+     * \brief Sets all bits in a range
+     * 
+     * This is available only for bit vectors. The partial word packs at the borders of the range are masked, the ones in between are filled at once.
+     * 
+     * \param l the position of the first bit
+     * \param r the position right beyond the last bit
+     */
+    void set_range(size_t l, size_t r) requires(width_ == 1) {
+        assert(l <= r && r <= size_);
+        if constexpr(Stats::enabled) Stats::bulk(r - l);
+        internal::fill_bit_range<BitOrder>(data_.get(), l, r, true);
+    }
+
+    /**
+     * \brief Unsets all bits in a range
+     * 
+     * This is available only for bit vectors. The partial word packs at the borders of the range are masked, the ones in between are filled at once.
+     * 
+     * \param l the position of the first bit
+     * \param r the position right beyond the last bit
+     */
+    void reset_range(size_t l, size_t r) requires(width_ == 1) {
+        assert(l <= r && r <= size_);
+        if constexpr(Stats::enabled) Stats::bulk(r - l);
+        internal::fill_bit_range<BitOrder>(data_.get(), l, r, false);
+    }
+
+    /**
+     * \brief Flips all bits in a range
+     * 
+     * This is available only for bit vectors. The partial word packs at the borders of the range are masked, the ones in between are inverted as a whole.
+     * 
+     * \param l the position of the first bit
+     * \param r the position right beyond the last bit
+     */
+    void flip_range(size_t l, size_t r) requires(width_ == 1) {
+        assert(l <= r && r <= size_);
+        if constexpr(Stats::enabled) Stats::bulk(r - l);
+        internal::flip_bit_range<BitOrder>(data_.get(), l, r);
+    }
+
+    /**
+     * \brief Counts the set bits in a range
+     * 
+     * This is available only for bit vectors. The word packs are counted as a whole using popcount.
+     * 
+     * \param l the position of the first bit
+     * \param r the position right beyond the last bit
+     * \return the number of set bits in the range [l, r)
+     */
+    size_t count_range(size_t l, size_t r) const requires(width_ == 1) {
+        assert(l <= r && r <= size_);
+        if constexpr(Stats::enabled) Stats::bulk(r - l);
+        return internal::count_bit_range<BitOrder>(data_.get(), l, r);
+    }
 
     /**
      * \brief Ensures that the vector's capacity fits at least the specified number of integers.
@@ -117,7 +216,7 @@ public:
         if(capacity > capacity_) {
             // allocate a new vector and copy data
             PackedFixedWidthIntVector new_vec(capacity);
-            std::copy(data(), data() + num_packs_required<Pack>(size_, width_), new_vec.data());
+            std::copy(data(), data() + BitOrder::template num_packs<Pack>(size_, width_), new_vec.data());
             new_vec.resize(size_); // this does nothing but set the size of the new vector
             *this = std::move(new_vec);
         }
@@ -131,7 +230,7 @@ public:
         if(size_ < capacity_) {
             // allocate a new vector and copy data
             PackedFixedWidthIntVector new_vec(size_);
-            std::copy(data(), data() + num_packs_required<Pack>(size_, width_), new_vec.data());
+            std::copy(data(), data() + BitOrder::template num_packs<Pack>(size_, width_), new_vec.data());
             for(size_t i = 0; i < size_; i++) new_vec.set(i, get(i)); // TODO: copy word packs instead of individual integers
             *this = std::move(new_vec);
         }
@@ -155,7 +254,7 @@ public:
             size_t const copy_num = std::min(size_, size);
             
             // copy packs
-            std::copy(data(), data() + num_packs_required<Pack>(copy_num, width_), new_vec.data());
+            std::copy(data(), data() + BitOrder::template num_packs<Pack>(copy_num, width_), new_vec.data());
 
             *this = std::move(new_vec);
         }
@@ -246,4 +345,12 @@ public:
 
 }
 
+/**
+ * \brief Hash support for packed integer vectors, e.g., for use in unordered containers
+ */
+template<size_t width_, word_packing::WordPackEligible Pack, typename BitOrder, typename Stats>
+struct std::hash<word_packing::PackedFixedWidthIntVector<width_, Pack, BitOrder, Stats>> {
+    size_t operator()(word_packing::PackedFixedWidthIntVector<width_, Pack, BitOrder, Stats> const& v) const { return v.hash(); }
+};
+
 #endif
@@ -28,9 +28,13 @@
 #ifndef _WORD_PACKING_PACKED_INT_VECTOR_HPP
 #define _WORD_PACKING_PACKED_INT_VECTOR_HPP
 
+#include "bit_order.hpp"
+#include "internal/alloc.hpp"
 #include "internal/container.hpp"
+#include "stats.hpp"
 
 #include <algorithm>
+#include <functional>
 #include <memory>
 
 namespace word_packing {
@@ -44,17 +48,31 @@ namespace word_packing {
  * The supported bit widths range from 1 to the width of the pack word type.
  * 
  * \tparam Pack the unsigned integer type to pack words into
+ * \tparam BitOrder the order in which integers are packed (\see word_packing::bit_order)
+ * \tparam Stats the instrumentation policy (\see word_packing::stats)
  */
-template<WordPackEligible Pack = uintmax_t>
-class PackedIntVector : public internal::IntContainer<PackedIntVector<Pack>> {
+template<WordPackEligible Pack = uintmax_t, typename BitOrder = bit_order::LsbFirst, typename Stats = stats::None>
+class PackedIntVector : public internal::IntContainer<PackedIntVector<Pack, BitOrder, Stats>> {
 private:
     size_t size_;
     size_t capacity_;
     size_t width_;
     size_t mask_;
-    std::unique_ptr<Pack[]> data_;
+    internal::CountedArray<Pack> data_;
 
 public:
+    /**
+     * \brief The bit order policy
+     * 
+     */
+    using BitOrderType = BitOrder;
+
+    /**
+     * \brief The instrumentation policy
+     * 
+     */
+    using StatsType = Stats;
+
     /**
      * \brief Constructs an empty vector of size zero
      * 
@@ -65,14 +83,14 @@ public:
     PackedIntVector(PackedIntVector&&) = default;
     PackedIntVector& operator=(PackedIntVector&&) = default;
 
-    PackedIntVector(PackedIntVector const& other) { *this = other; }
+    PackedIntVector(PackedIntVector const& other) : internal::IntContainer<PackedIntVector>() { *this = other; }
     PackedIntVector& operator=(PackedIntVector const& other) {
         size_ = other.size_;
-        capacity_ = other.capacity_;
+        capacity_ = other.size_; // nb: copies are allocated only for the contained integers
         width_ = other.width_;
         mask_ = other.mask_;
-        data_ = std::make_unique<Pack[]>(num_packs_required<Pack>(size_, width_));
-        std::copy(other.data(), other.data() + num_packs_required<Pack>(size_, width_), data());
+        data_ = internal::make_counted_array<Pack>(BitOrder::template num_packs<Pack>(size_, width_));
+        std::copy(other.data(), other.data() + BitOrder::template num_packs<Pack>(size_, width_), data());
         return *this;
     }
 
@@ -89,7 +107,7 @@ public:
         assert(width_ <= std::numeric_limits<Pack>::digits);
 
         if(capacity_ > 0) {
-            data_ = std::make_unique<Pack[]>(num_packs_required<Pack>(size_, width_));
+            data_ = internal::make_counted_array<Pack>(BitOrder::template num_packs<Pack>(size_, width_));
         }
     }
 
@@ -99,7 +117,10 @@ public:
      * \param i the index of the integer
      * \return the integer at the given index
      */
-    uintmax_t get(size_t i) const { return internal::get(data_.get(), i, width_, mask_); }
+    uintmax_t get(size_t i) const {
+        internal::record_get<Stats, BitOrder, Pack>(i, width_);
+        return BitOrder::get(data_.get(), i, width_, mask_);
+    }
 
     /**
      * \brief Writes a specific integer in the vector
@@ -107,7 +128,27 @@ public:
      * \param i the index of the integer
      * \param x the value to write to the specified index
      */
-    void set(size_t i, uintmax_t x) { internal::set(data_.get(), i, x, width_, mask_); }
+    void set(size_t i, uintmax_t x) {
+        internal::record_set<Stats, BitOrder, Pack>(i, width_);
+        BitOrder::set(data_.get(), i, x, width_, mask_);
+    }
+
+    /**
+     * \brief Adds a value to a specific integer in the vector
+     * 
+     * The affected word packs are read and written only once.
+     * 
+     * \tparam Overflow the overflow policy (\see word_packing::overflow)
+     * \param i the index of the integer
+     * \param d the value to add
+     * \return the part of the sum that did not fit (always zero if the policy does not saturate)
+     */
+    template<typename Overflow = overflow::Wrap>
+    uintmax_t add(size_t i, uintmax_t d) {
+        internal::record_add<Stats, BitOrder, Pack>(i, width_);
+        return BitOrder::template add<Overflow>(data_.get(), i, d, width_, mask_);
+    }
+    using internal::IntContainer<PackedIntVector<Pack, BitOrder, Stats>>::add;
 
     /**
      * \brief Ensures that the vector's capacity fits at least the specified number of integers.
@@ -121,7 +162,7 @@ public:
         if(capacity > capacity_) {
             // allocate a new vector and copy data
             PackedIntVector new_vec(capacity, width_);
-            std::copy(data(), data() + num_packs_required<Pack>(size_, width_), new_vec.data());
+            std::copy(data(), data() + BitOrder::template num_packs<Pack>(size_, width_), new_vec.data());
             new_vec.resize(size_); // this does nothing but set the size of the new vector
             *this = std::move(new_vec);
         }
@@ -135,7 +176,7 @@ public:
         if(size_ < capacity_) {
             // allocate a new vector and copy data
             PackedIntVector new_vec(size_, width_);
-            std::copy(data(), data() + num_packs_required<Pack>(size_, width_), new_vec.data());
+            std::copy(data(), data() + BitOrder::template num_packs<Pack>(size_, width_), new_vec.data());
             for(size_t i = 0; i < size_; i++) new_vec.set(i, get(i)); // TODO: copy pack words instead of individual integers
             *this = std::move(new_vec);
         }
@@ -161,7 +202,7 @@ public:
             size_t const copy_num = std::min(size_, size);
             if(width_ == width) {
                 // copy packs
-                std::copy(data(), data() + num_packs_required<Pack>(copy_num, width_), new_vec.data());
+                std::copy(data(), data() + BitOrder::template num_packs<Pack>(copy_num, width_), new_vec.data());
             } else {
                 // the width has changed, copy integers one by one and possibly truncate
                 for(size_t i = 0; i < copy_num; i++) new_vec.set(i, get(i));
@@ -267,4 +308,12 @@ public:
 
 }
 
+/**
+ * \brief Hash support for packed integer vectors, e.g., for use in unordered containers
+ */
+template<word_packing::WordPackEligible Pack, typename BitOrder, typename Stats>
+struct std::hash<word_packing::PackedIntVector<Pack, BitOrder, Stats>> {
+    size_t operator()(word_packing::PackedIntVector<Pack, BitOrder, Stats> const& v) const { return v.hash(); }
+};
+
 #endif
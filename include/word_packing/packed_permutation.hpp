@@ -0,0 +1,281 @@
+/**
+ * word_packing/packed_permutation.hpp
+ * part of pdinklag/word-packing
+ * 
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _WORD_PACKING_PACKED_PERMUTATION_HPP
+#define _WORD_PACKING_PACKED_PERMUTATION_HPP
+
+#include "internal/parallel.hpp"
+#include "packed_fixed_width_int_vector.hpp"
+#include "packed_int_vector.hpp"
+#include "rank_select.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace word_packing {
+
+/**
+ * \brief Permutation with fast inverse using shortcut pointers
+ *
+ * The permutation pi is stored as a packed integer vector.
+ * Along each cycle longer than t, every t-th element is marked in a bit vector with rank support
+ * and stores a back pointer to the previous marked element on its cycle.
+ * To compute the inverse of i, the cycle is followed from i until a marked element is reached,
+ * which is then used to jump back to the previous marked element, from where the cycle is followed until i is reached again.
+ * This takes O(t) time and n log n / t bits of extra space.
+ *
+ * \tparam Pack the word pack type
+ */
+template<WordPackEligible Pack = uintmax_t>
+class PackedPermutation {
+private:
+    using Bits = PackedFixedWidthIntVector<1>;
+
+    static constexpr size_t BITS_PER_PACK = std::numeric_limits<uintmax_t>::digits;
+
+    size_t t_;
+    PackedIntVector<Pack> pi_;
+    Bits marks_;
+    RankSelect<> marks_rank_;
+    PackedIntVector<Pack> back_;
+
+    // a part of a cycle, visited by a single thread
+    struct Segment {
+        size_t start, stop, last_mark;
+    };
+
+    void construct(size_t const num_threads) {
+        size_t const n = pi_.size();
+
+        // claim elements by atomically setting their bit in a shared bit vector
+        Bits visited(n);
+        std::fill(visited.data(), visited.data() + num_packs_required<uintmax_t>(n, 1), uintmax_t(0));
+        auto claim = [&](size_t const x){
+            uintmax_t const bit = uintmax_t(1) << (x % BITS_PER_PACK);
+            return !(std::atomic_ref<uintmax_t>(visited.data()[x / BITS_PER_PACK]).fetch_or(bit) & bit);
+        };
+
+        // each thread walks cycles starting from the elements of its chunk until it reaches an element that has been claimed before
+        // nb: the reached element is the start of another segment, because its only predecessor has been claimed by this thread
+        size_t const num_chunks = (num_threads > 1) ? 4 * num_threads : 1;
+        size_t const chunk_len = internal::idiv_ceil(n, num_chunks);
+
+        std::vector<std::vector<std::pair<size_t, size_t>>> marks(num_chunks);       // marked element and back pointer
+        std::vector<std::vector<std::pair<size_t, size_t>>> open_marks(num_chunks);  // marked segment start and segment index, back pointer unknown
+        std::vector<std::vector<Segment>> open_segments(num_chunks);
+
+        internal::parallel_for(num_threads, num_chunks, [&](size_t const c){
+            size_t const s = c * chunk_len;
+            size_t const e = std::min(n, s + chunk_len);
+            for(size_t i = s; i < e; i++) {
+                if(!claim(i)) continue;
+
+                // walk the segment
+                size_t len = 1;
+                size_t x = pi_.get(i);
+                while(claim(x)) {
+                    x = pi_.get(x);
+                    ++len;
+                }
+
+                bool const closed = (x == i);
+                if(closed && len <= t_) continue; // short cycles need no shortcuts
+
+                // mark every t-th element, starting with the segment's start
+                size_t last_mark = i;
+                size_t y = i;
+                for(size_t k = t_; k < len; k += t_) {
+                    for(size_t j = 0; j < t_; j++) y = pi_.get(y);
+                    marks[c].emplace_back(y, last_mark);
+                    last_mark = y;
+                }
+
+                if(closed) {
+                    marks[c].emplace_back(i, last_mark);
+                } else {
+                    open_marks[c].emplace_back(i, open_segments[c].size());
+                    open_segments[c].push_back(Segment { i, x, last_mark });
+                }
+            }
+        });
+
+        // link the starts of open segments to the last mark of the preceding segment
+        std::unordered_map<size_t, size_t> last_mark_before;
+        for(auto const& segments : open_segments) {
+            for(auto const& seg : segments) last_mark_before.emplace(seg.stop, seg.last_mark);
+        }
+        for(size_t c = 0; c < num_chunks; c++) {
+            for(auto const& [start, seg] : open_marks[c]) marks[c].emplace_back(start, last_mark_before.at(start));
+        }
+
+        // build the mark bit vector and store the back pointers in the order of the marked elements
+        marks_ = Bits(n);
+        std::fill(marks_.data(), marks_.data() + num_packs_required<uintmax_t>(n, 1), uintmax_t(0));
+
+        size_t num_marks = 0;
+        for(auto const& m : marks) {
+            for(auto const& [x, back] : m) marks_.set(x, 1);
+            num_marks += m.size();
+        }
+        marks_rank_ = RankSelect<>(marks_);
+
+        back_ = PackedIntVector<Pack>(num_marks, pi_.width());
+        for(auto const& m : marks) {
+            for(auto const& [x, back] : m) back_.set(marks_rank_.rank1(x), back);
+        }
+    }
+
+public:
+    /**
+     * \brief Constructs an empty permutation
+     *
+     */
+    PackedPermutation() : t_(1) {
+    }
+
+    PackedPermutation(PackedPermutation&&) = default;
+    PackedPermutation& operator=(PackedPermutation&&) = default;
+
+    PackedPermutation(PackedPermutation const&) = delete;
+    PackedPermutation& operator=(PackedPermutation const&) = delete;
+
+    /**
+     * \brief Constructs the shortcut structure for the given permutation
+     *
+     * The cycles are walked in parallel, with threads claiming elements in a shared bit vector.
+     * Cycles visited by multiple threads consist of several segments, each of which receives at least one shortcut.
+     *
+     * \param pi the permutation of the integers 0 to n-1
+     * \param t the maximum distance between two marked elements on a cycle
+     * \param num_threads the number of threads to use for construction
+     */
+    PackedPermutation(PackedIntVector<Pack> pi, size_t const t = 16, size_t const num_threads = 1) : t_(t), pi_(std::move(pi)) {
+        assert(t_ > 0);
+        construct(num_threads);
+    }
+
+    /**
+     * \brief Retrieves the image of an element
+     *
+     * \param i the element
+     * \return the image of i under the permutation
+     */
+    uintmax_t get(size_t const i) const { return pi_.get(i); }
+
+    /**
+     * \brief Retrieves the image of an element
+     *
+     * This function simply forwards to \ref get .
+     *
+     * \param i the element
+     * \return the image of i under the permutation
+     */
+    uintmax_t operator[](size_t const i) const { return get(i); }
+
+    /**
+     * \brief Retrieves the preimage of an element
+     *
+     * \param i the element
+     * \return the element j such that the image of j is i
+     */
+    uintmax_t inverse(size_t const i) const {
+        size_t x = i;
+        bool jumped = false;
+        while(true) {
+            size_t const y = pi_.get(x);
+            if(y == i) return x;
+
+            if(!jumped && marks_.get(x)) {
+                x = back_.get(marks_rank_.rank1(x));
+                jumped = true;
+            } else {
+                x = y;
+            }
+        }
+    }
+
+    /**
+     * \brief Applies the permutation to a sequence
+     *
+     * This computes dst[i] = src[pi(i)] for all i, prefetching upcoming source word packs.
+     *
+     * \tparam Src the source container type
+     * \tparam Dst the destination container type
+     * \param src the source sequence
+     * \param dst the destination sequence, which must have at least the size of the permutation
+     */
+    template<typename Src, typename Dst>
+    void apply(Src const& src, Dst& dst) const {
+        constexpr size_t LOOKAHEAD = 16;
+        using SrcPack = std::remove_cvref_t<decltype(*src.data())>;
+        using SrcBitOrder = typename Src::BitOrderType;
+
+        size_t const n = size();
+        size_t const src_width = src.width();
+        for(size_t i = 0; i < n; i++) {
+            if(i + LOOKAHEAD < n) __builtin_prefetch(src.data() + SrcBitOrder::template pack_index<SrcPack>(pi_.get(i + LOOKAHEAD), src_width));
+            dst.set(i, src.get(pi_.get(i)));
+        }
+    }
+
+    /**
+     * \brief Reports the maximum distance between two marked elements on a cycle
+     *
+     * \return the maximum distance between two marked elements on a cycle
+     */
+    size_t shortcut_interval() const { return t_; }
+
+    /**
+     * \brief Reports the number of shortcuts
+     *
+     * \return the number of marked elements
+     */
+    size_t num_shortcuts() const { return back_.size(); }
+
+    /**
+     * \brief Reports the number of elements
+     *
+     * \return the number of elements
+     */
+    size_t size() const { return pi_.size(); }
+
+    /**
+     * \brief Reports the number of heap bytes used by the permutation
+     *
+     * This includes the shortcuts and their rank support.
+     *
+     * \return the number of heap bytes used
+     */
+    size_t memory_usage() const { return pi_.memory_usage() + marks_.memory_usage() + marks_rank_.memory_usage() + back_.memory_usage(); }
+};
+
+}
+
+#endif
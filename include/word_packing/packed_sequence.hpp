@@ -0,0 +1,400 @@
+/**
+ * word_packing/packed_sequence.hpp
+ * part of pdinklag/word-packing
+ * 
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _WORD_PACKING_PACKED_SEQUENCE_HPP
+#define _WORD_PACKING_PACKED_SEQUENCE_HPP
+
+#include "internal/cpu.hpp"
+#include "packed_fixed_width_int_vector.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <string_view>
+
+namespace word_packing {
+
+/**
+ * \brief Lookup table mapping ASCII characters to symbol codes
+ *
+ * Characters that are not part of the alphabet are mapped to \ref INVALID_SYMBOL .
+ */
+using AsciiTable = std::array<uint8_t, 256>;
+
+/**
+ * \brief The code of characters that are not part of an alphabet
+ */
+constexpr uint8_t INVALID_SYMBOL = 0xFF;
+
+/**
+ * \brief Creates a lookup table that maps the i-th character of the given alphabet to code i
+ *
+ * Letters are mapped case-insensitively.
+ *
+ * \param symbols the characters of the alphabet
+ * \return the lookup table
+ */
+constexpr AsciiTable make_ascii_table(std::string_view const symbols) {
+    AsciiTable table;
+    table.fill(INVALID_SYMBOL);
+    for(size_t i = 0; i < symbols.size(); i++) {
+        uint8_t const c = symbols[i];
+        table[c] = i;
+        if(c >= 'A' && c <= 'Z') table[c + ('a' - 'A')] = i;
+        if(c >= 'a' && c <= 'z') table[c - ('a' - 'A')] = i;
+    }
+    return table;
+}
+
+/**
+ * \brief Commonly used alphabets
+ */
+namespace alphabet {
+    /**
+     * \brief The DNA alphabet (A, C, G, T), requiring 2 bits per symbol
+     */
+    constexpr AsciiTable DNA = make_ascii_table("ACGT");
+
+    /**
+     * \brief The alphabet of the 20 standard amino acids, requiring 5 bits per symbol
+     */
+    constexpr AsciiTable PROTEIN = make_ascii_table("ACDEFGHIKLMNPQRSTVWY");
+}
+
+namespace internal {
+    // translation of blocks of characters to symbol codes without instruction set extensions
+    struct AsciiPortable {
+        static constexpr size_t BLOCK = 8;
+
+        // translates a block of characters and reports whether any code exceeds the given maximum
+        // the rows are a bit mask of the high nibbles of characters that are mapped to codes
+        static bool translate(uint8_t const* text, AsciiTable const& table, uint16_t, uint8_t const max_code, uint8_t* codes) {
+            uint8_t max = 0;
+            for(size_t k = 0; k < BLOCK; k++) {
+                codes[k] = table[text[k]];
+                max = std::max(max, codes[k]);
+            }
+            return max > max_code;
+        }
+
+        // packs eight codes of the given width into the low bits of an integer
+        template<size_t bits>
+        static uint64_t pack8(uint8_t const* codes) {
+            uint64_t x;
+            std::memcpy(&x, codes, 8);
+            if constexpr(bits == 8) {
+                return x;
+            } else {
+                uint64_t packed = 0;
+                for(size_t k = 0; k < 8; k++) packed |= ((x >> (8 * k)) & low_mask(bits)) << (k * bits);
+                return packed;
+            }
+        }
+    };
+
+#ifdef WORD_PACKING_X86_DISPATCH
+    // translates 16 characters at once, using a shuffle per mapped high nibble as a lookup table for the low nibbles
+    // nb: characters with other high nibbles keep the code INVALID_SYMBOL
+    struct AsciiSsse3 : AsciiPortable {
+        static constexpr size_t BLOCK = 16;
+
+        [[gnu::target("ssse3")]] static bool translate(uint8_t const* text, AsciiTable const& table, uint16_t rows, uint8_t const max_code, uint8_t* codes) {
+            __m128i const nibble = _mm_set1_epi8(0x0F);
+            __m128i const v = _mm_loadu_si128((__m128i const*)text);
+            __m128i const lo = _mm_and_si128(v, nibble);
+            __m128i const hi = _mm_and_si128(_mm_srli_epi16(v, 4), nibble);
+
+            __m128i r = _mm_set1_epi8(char(INVALID_SYMBOL));
+            for(; rows; rows &= rows - 1) {
+                size_t const h = std::countr_zero(rows);
+                __m128i const row = _mm_loadu_si128((__m128i const*)(table.data() + 16 * h));
+                __m128i const in_row = _mm_cmpeq_epi8(hi, _mm_set1_epi8(h));
+                r = _mm_or_si128(_mm_andnot_si128(in_row, r), _mm_and_si128(in_row, _mm_shuffle_epi8(row, lo)));
+            }
+            _mm_storeu_si128((__m128i*)codes, r);
+
+            // a code exceeds the maximum iff the maximum changes it
+            __m128i const m = _mm_set1_epi8(max_code);
+            return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(r, m), m)) != 0xFFFF;
+        }
+    };
+
+    // as above, translating 32 characters at once and packing codes using a parallel bit extract
+    struct AsciiAvx2 {
+        static constexpr size_t BLOCK = 32;
+
+        [[gnu::target("avx2")]] static bool translate(uint8_t const* text, AsciiTable const& table, uint16_t rows, uint8_t const max_code, uint8_t* codes) {
+            __m256i const nibble = _mm256_set1_epi8(0x0F);
+            __m256i const v = _mm256_loadu_si256((__m256i const*)text);
+            __m256i const lo = _mm256_and_si256(v, nibble);
+            __m256i const hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble);
+
+            __m256i r = _mm256_set1_epi8(char(INVALID_SYMBOL));
+            for(; rows; rows &= rows - 1) {
+                size_t const h = std::countr_zero(rows);
+                __m256i const row = _mm256_broadcastsi128_si256(_mm_loadu_si128((__m128i const*)(table.data() + 16 * h)));
+                r = _mm256_blendv_epi8(r, _mm256_shuffle_epi8(row, lo), _mm256_cmpeq_epi8(hi, _mm256_set1_epi8(h)));
+            }
+            _mm256_storeu_si256((__m256i*)codes, r);
+
+            __m256i const m = _mm256_set1_epi8(max_code);
+            return uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_max_epu8(r, m), m))) != UINT32_MAX;
+        }
+
+        template<size_t bits>
+        [[gnu::target("bmi2")]] static uint64_t pack8(uint8_t const* codes) {
+            uint64_t x;
+            std::memcpy(&x, codes, 8);
+            return _pext_u64(x, low_mask(bits) * 0x0101010101010101ULL);
+        }
+    };
+#endif
+
+    // translates a text to codes of the given width and packs them into the given word packs, writing each word pack once
+    // returns whether all characters could be translated
+    template<typename Isa, size_t bits>
+    [[gnu::always_inline]] inline bool pack_ascii(uint8_t const* text, size_t const n, AsciiTable const& table, uintmax_t* data) {
+        constexpr size_t PACK_BITS = std::numeric_limits<uintmax_t>::digits;
+        constexpr uint8_t MAX_CODE = std::min(low_mask(bits), uintmax_t(INVALID_SYMBOL - 1));
+
+        uintmax_t buffer = 0;
+        size_t fill = 0;
+        size_t p = 0;
+        auto append = [&](uintmax_t const x, size_t const w){
+            buffer |= x << fill;
+            fill += w;
+            if(fill >= PACK_BITS) {
+                data[p++] = buffer;
+                fill -= PACK_BITS;
+                buffer = fill ? x >> (w - fill) : 0;
+            }
+        };
+
+        bool invalid = false;
+        size_t i = 0;
+        if constexpr(bits <= 8) {
+            // the high nibbles of the characters that are mapped to codes
+            uint16_t rows = 0;
+            for(size_t c = 0; c < 256; c++) rows |= uint16_t(table[c] != INVALID_SYMBOL) << (c / 16);
+
+            // blocks of characters, packed eight codes at a time
+            uint8_t codes[Isa::BLOCK];
+            for(; i + Isa::BLOCK <= n; i += Isa::BLOCK) {
+                invalid |= Isa::translate(text + i, table, rows, MAX_CODE, codes);
+                for(size_t k = 0; k < Isa::BLOCK; k += 8) append(Isa::template pack8<bits>(codes + k), 8 * bits);
+            }
+        }
+        for(; i < n; i++) {
+            uint8_t const code = table[text[i]];
+            invalid |= (code > MAX_CODE);
+            append(code & low_mask(bits), bits);
+        }
+        if(fill) data[p] = buffer;
+        return !invalid;
+    }
+
+#ifdef WORD_PACKING_X86_DISPATCH
+    template<size_t bits>
+    [[gnu::target("ssse3")]] bool pack_ascii_ssse3(uint8_t const* text, size_t const n, AsciiTable const& table, uintmax_t* data) {
+        return pack_ascii<AsciiSsse3, bits>(text, n, table, data);
+    }
+
+    template<size_t bits>
+    [[gnu::target("avx2,bmi2")]] bool pack_ascii_avx2(uint8_t const* text, size_t const n, AsciiTable const& table, uintmax_t* data) {
+        return pack_ascii<AsciiAvx2, bits>(text, n, table, data);
+    }
+#endif
+}
+
+/**
+ * \brief Sequence of symbols over a small alphabet
+ *
+ * The symbols are packed into a \ref PackedFixedWidthIntVector .
+ * Because integers are packed starting from the least significant bit,
+ * k consecutive symbols are a contiguous range of k times the alphabet width bits,
+ * which can be extracted as a single integer using \ref internal::get_bits .
+ *
+ * In an extracted integer, the j-th symbol is contained in the j-th lowest group of `alphabet_bits_` bits.
+ *
+ * \tparam alphabet_bits_ the width per symbol
+ */
+template<size_t alphabet_bits_>
+class PackedSequence {
+private:
+    static constexpr size_t PACK_BITS = std::numeric_limits<uintmax_t>::digits;
+
+    PackedFixedWidthIntVector<alphabet_bits_> symbols_;
+
+public:
+    /**
+     * \brief The maximum number of symbols that can be extracted as a single integer
+     */
+    static constexpr size_t MAX_K = PACK_BITS / alphabet_bits_;
+
+    /**
+     * \brief Constructs an empty sequence
+     *
+     */
+    PackedSequence() {
+    }
+
+    /**
+     * \brief Constructs a sequence of the given length
+     *
+     * Note that the sequence's content is \em not initialized.
+     *
+     * \param size the number of symbols
+     */
+    PackedSequence(size_t const size) : symbols_(size) {
+    }
+
+    /**
+     * \brief Retrieves a specific symbol
+     *
+     * \param i the position of the symbol
+     * \return the code of the symbol at the given position
+     */
+    uintmax_t get(size_t const i) const { return symbols_.get(i); }
+
+    /**
+     * \brief Retrieves a specific symbol
+     *
+     * This function simply forwards to \ref get .
+     *
+     * \param i the position of the symbol
+     * \return the code of the symbol at the given position
+     */
+    uintmax_t operator[](size_t const i) const { return get(i); }
+
+    /**
+     * \brief Writes a specific symbol
+     *
+     * \param i the position of the symbol
+     * \param x the code of the symbol
+     */
+    void set(size_t const i, uintmax_t const x) { symbols_.set(i, x); }
+
+    /**
+     * \brief Extracts consecutive symbols as a single integer
+     *
+     * \param i the position of the first symbol
+     * \param k the number of symbols to extract, at most \ref MAX_K
+     * \return the symbols at positions i to i+k-1, the j-th of which is contained in the j-th lowest group of bits
+     */
+    uintmax_t extract(size_t const i, size_t const k) const {
+        assert(k <= MAX_K);
+        assert(i + k <= size());
+
+        return k ? internal::get_bits(symbols_.data(), i * alphabet_bits_, k * alphabet_bits_) : 0;
+    }
+
+    /**
+     * \brief Calls the given function for every k-mer of the sequence
+     *
+     * The k-mers are computed in a rolling manner, shifting in one symbol per step.
+     * The function is called with the position of each k-mer and the k-mer in the format of \ref extract .
+     *
+     * \tparam F the function type
+     * \param k the length of the k-mers, at most \ref MAX_K
+     * \param f the function to call
+     */
+    template<typename F>
+    void for_each_kmer(size_t const k, F f) const {
+        assert(k > 0);
+        assert(k <= MAX_K);
+
+        size_t const n = size();
+        if(n < k) return;
+
+        size_t const hi_shift = (k - 1) * alphabet_bits_;
+        uintmax_t kmer = extract(0, k);
+        f(size_t(0), kmer);
+        for(size_t i = 1; i + k <= n; i++) {
+            kmer = (kmer >> alphabet_bits_) | (get(i + k - 1) << hi_shift);
+            f(i, kmer);
+        }
+    }
+
+    /**
+     * \brief Replaces the sequence by the given text
+     *
+     * The characters are translated using the lookup table and packed word by word,
+     * so every word pack of the sequence is written only once.
+     * Depending on the CPU, which is detected at runtime, blocks of 32 or 16 characters are translated at once using AVX2 or SSSE3 shuffles,
+     * which look up the low nibble of each character in the row of the table selected by its high nibble.
+     * With AVX2, the codes are then packed using BMI2 `pext`.
+     *
+     * \param text the text
+     * \param table the lookup table mapping characters to symbol codes
+     * \return true if all characters could be translated
+     * \return false if the text contains characters that are not part of the alphabet, in which case the sequence is undefined
+     */
+    bool assign_ascii(std::string_view const text, AsciiTable const& table) {
+        size_t const n = text.size();
+        symbols_ = PackedFixedWidthIntVector<alphabet_bits_>(n);
+
+        auto const* in = reinterpret_cast<uint8_t const*>(text.data());
+#ifdef WORD_PACKING_X86_DISPATCH
+        if(internal::cpu::has_avx2() && internal::cpu::has_bmi2()) return internal::pack_ascii_avx2<alphabet_bits_>(in, n, table, symbols_.data());
+        if(internal::cpu::has_ssse3()) return internal::pack_ascii_ssse3<alphabet_bits_>(in, n, table, symbols_.data());
+#endif
+        return internal::pack_ascii<internal::AsciiPortable, alphabet_bits_>(in, n, table, symbols_.data());
+    }
+
+    /**
+     * \brief Provides read access to the underlying vector of symbols
+     *
+     * \return the vector of symbols
+     */
+    PackedFixedWidthIntVector<alphabet_bits_> const& symbols() const { return symbols_; }
+
+    /**
+     * \brief Reports the width of the symbols
+     *
+     * \return the width, in bits, of the symbols
+     */
+    size_t width() const { return alphabet_bits_; }
+
+    /**
+     * \brief Reports the length of the sequence
+     *
+     * \return the number of symbols
+     */
+    size_t size() const { return symbols_.size(); }
+
+    /**
+     * \brief Reports the number of heap bytes used by the sequence
+     *
+     * \return the number of heap bytes used
+     */
+    size_t memory_usage() const { return symbols_.memory_usage(); }
+};
+
+}
+
+#endif
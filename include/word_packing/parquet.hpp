@@ -0,0 +1,176 @@
+/**
+ * word_packing/parquet.hpp
+ * part of pdinklag/word-packing
+ * 
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _WORD_PACKING_PARQUET_HPP
+#define _WORD_PACKING_PARQUET_HPP
+
+#include "internal/bit_stream.hpp"
+#include "packed_int_vector.hpp"
+
+#include <algorithm>
+#include <vector>
+
+/**
+ * \brief Codecs for the Apache Parquet file format
+ */
+namespace word_packing::parquet {
+
+/**
+ * \brief Decodes a stream in the RLE / bit-packing hybrid encoding of Apache Parquet into a packed integer vector
+ * 
+ * The stream is expected without any length prefix.
+ * Bit-packed runs use the same bit order as packed integer vectors.
+ * If the widths match, they are copied into the vector's word packs without decoding the individual integers,
+ * and directly as bytes if the target position is byte-aligned.
+ * 
+ * \tparam Pack the word pack type of the vector
+ * \param in the encoded stream
+ * \param in_size the size, in bytes, of the encoded stream
+ * \param bit_width the bit width of the encoded integers, at most the width of the vector
+ * \param num the number of integers to decode
+ * \param out the vector to decode into, which must have room for the decoded integers
+ * \param out_off the position in the vector of the first decoded integer
+ * \return true if the integers were decoded
+ * \return false if the stream ended prematurely, in which case the vector contents are undefined
+ */
+template<WordPackEligible Pack>
+bool decode_rle_hybrid(uint8_t const* in, size_t const in_size, size_t const bit_width, size_t const num, PackedIntVector<Pack>& out, size_t const out_off = 0) {
+    assert(bit_width <= out.width());
+    assert(out_off + num <= out.size());
+
+    uint8_t const* p = in;
+    uint8_t const* const end = in + in_size;
+    size_t const value_bytes = internal::idiv_ceil(bit_width, 8);
+
+    size_t i = 0;
+    while(i < num) {
+        uint64_t header;
+        if(!internal::read_uleb128(p, end, header)) return false;
+
+        size_t const remaining = num - i;
+        if(header & 1) {
+            // bit-packed run of groups of eight integers
+            size_t const num_groups = header >> 1;
+            if(bit_width && num_groups > size_t(end - p) / bit_width) return false;
+
+            size_t const run_bytes = num_groups * bit_width;
+            size_t const m = (num_groups >= internal::idiv_ceil(remaining, 8)) ? remaining : 8 * num_groups; // nb: the final group may be padded
+            if(bit_width == out.width()) {
+                internal::copy_bits_from_bytes(out.data(), (out_off + i) * bit_width, p, m * bit_width);
+            } else {
+                for(size_t j = 0; j < m; j++) out.set(out_off + i + j, internal::load_bits_lsb(p, run_bytes, j * bit_width, bit_width));
+            }
+            p += run_bytes;
+            i += m;
+        } else {
+            // run of a repeated integer
+            if(value_bytes > size_t(end - p)) return false;
+
+            uintmax_t v = 0;
+            for(size_t b = 0; b < value_bytes; b++) v |= uintmax_t(p[b]) << (8 * b);
+            p += value_bytes;
+
+            size_t const m = std::min(size_t(header >> 1), remaining);
+            for(size_t j = 0; j < m; j++) out.set(out_off + i + j, v);
+            i += m;
+        }
+    }
+    return true;
+}
+
+/**
+ * \brief Encodes a packed integer vector in the RLE / bit-packing hybrid encoding of Apache Parquet
+ * 
+ * Runs of at least eight equal integers are run-length encoded, all other integers are bit-packed.
+ * If the widths match, bit-packed runs are copied from the vector's word packs without encoding the individual integers.
+ * The stream is written without any length prefix.
+ * 
+ * \tparam Pack the word pack type of the vector
+ * \param in the vector to encode
+ * \param bit_width the bit width of the encoded integers, which must suffice for all integers in the vector
+ * \param out the byte stream to append the encoded stream to
+ */
+template<WordPackEligible Pack>
+void encode_rle_hybrid(PackedIntVector<Pack> const& in, size_t const bit_width, std::vector<uint8_t>& out) {
+    assert(bit_width <= 64);
+
+    size_t const n = in.size();
+    size_t const value_bytes = internal::idiv_ceil(bit_width, 8);
+
+    // computes the length of the run starting at i, but no more than max
+    auto run_length = [&](size_t const i, size_t const max){
+        auto const v = in[i];
+        size_t j = i + 1;
+        while(j < n && j - i < max && in[j] == v) ++j;
+        return j - i;
+    };
+
+    size_t i = 0;
+    while(i < n) {
+        size_t const r = run_length(i, SIZE_MAX);
+        if(r >= 8) {
+            // run of a repeated integer
+            internal::write_uleb128(out, uint64_t(r) << 1);
+            uintmax_t const v = in[i];
+            for(size_t b = 0; b < value_bytes; b++) out.push_back(uint8_t(v >> (8 * b)));
+            i += r;
+        } else {
+            // bit-packed groups of eight integers, until a run starts at a group boundary
+            size_t j = i + 8;
+            while(j < n && run_length(j, 8) < 8) j += 8;
+
+            size_t const m = std::min(j, n) - i;
+            size_t const num_groups = internal::idiv_ceil(m, 8);
+            internal::write_uleb128(out, (uint64_t(num_groups) << 1) | 1);
+
+            size_t const start = out.size();
+            out.resize(start + num_groups * bit_width, 0);
+            if(bit_width == in.width()) {
+                internal::copy_bits_to_bytes(out.data() + start, in.data(), i * bit_width, m * bit_width);
+            } else {
+                for(size_t k = 0; k < m; k++) internal::store_bits_lsb(out.data() + start, k * bit_width, bit_width, in[i + k]);
+            }
+            i += m;
+        }
+    }
+}
+
+/**
+ * \brief Encodes a packed integer vector in the RLE / bit-packing hybrid encoding of Apache Parquet using the vector's width
+ * 
+ * \tparam Pack the word pack type of the vector
+ * \param in the vector to encode
+ * \param out the byte stream to append the encoded stream to
+ */
+template<WordPackEligible Pack>
+void encode_rle_hybrid(PackedIntVector<Pack> const& in, std::vector<uint8_t>& out) {
+    encode_rle_hybrid(in, in.width(), out);
+}
+
+}
+
+#endif
@@ -0,0 +1,354 @@
+/**
+ * word_packing/profiler.hpp
+ * part of pdinklag/word-packing
+ * 
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _WORD_PACKING_PROFILER_HPP
+#define _WORD_PACKING_PROFILER_HPP
+
+#include "internal/compare.hpp"
+#include "internal/int_ref.hpp"
+#include "packed_fixed_width_int_vector.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <string_view>
+#include <type_traits>
+
+namespace word_packing {
+
+namespace internal {
+    // whether the width of a container is known at compile time
+    template<typename C>
+    struct is_fixed_width : std::false_type {};
+
+    template<size_t width_, WordPackEligible Pack, typename BitOrder, typename Stats>
+    struct is_fixed_width<PackedFixedWidthIntVector<width_, Pack, BitOrder, Stats>> : std::true_type {};
+}
+
+/**
+ * \brief Layout and tuning changes suggested by an \ref AccessProfile
+ */
+struct Recommendation {
+    bool fixed_width = false;       ///< whether to use a container with a width known at compile time
+    bool padded = false;            ///< whether to use the padded bit order (\see word_packing::bit_order::Padded)
+    bool huge_pages = false;        ///< whether to back the container by huge pages
+    bool block_compression = false; ///< whether to store the integers in compressed blocks that are decoded at once
+
+    /**
+     * \brief Prints the recommendation as key-value pairs in a single line
+     *
+     * \param out the output stream
+     * \param name the name to print along with the recommendation
+     */
+    void print(std::ostream& out, std::string_view const name) const {
+        out << "RECOMMEND name=" << name <<
+            " fixed_width=" << fixed_width <<
+            " padded=" << padded <<
+            " huge_pages=" << huge_pages <<
+            " block_compression=" << block_compression << std::endl;
+    }
+};
+
+/**
+ * \brief Access statistics gathered by a \ref Profiled container
+ *
+ * All counts except \ref accesses refer to sampled accesses only.
+ */
+struct AccessProfile {
+    /**
+     * \brief The number of buckets of the stride histogram
+     *
+     * Bucket zero counts strides of zero, bucket \c b > 0 counts strides whose absolute value is in the range [2^(b-1), 2^b).
+     */
+    static constexpr size_t NUM_STRIDE_BUCKETS = 65;
+
+    /**
+     * \brief The page size assumed for the working set
+     */
+    static constexpr size_t PAGE_BYTES = 4096;
+
+    uint64_t accesses = 0;    ///< the total number of accesses, sampled or not
+    uint64_t samples = 0;     ///< the number of sampled accesses
+    uint64_t reads = 0;       ///< the number of sampled reads
+    uint64_t writes = 0;      ///< the number of sampled writes
+    uint64_t sequential = 0;  ///< the number of sampled accesses within one cache line of the preceding access
+    uint64_t backward = 0;    ///< the number of sampled accesses preceding the preceding access
+    uint64_t straddling = 0;  ///< the number of sampled accesses to integers that straddle two word packs
+    uint64_t stride_histogram[NUM_STRIDE_BUCKETS] = {}; ///< the histogram of strides between accesses, in integers
+    size_t pages = 0;         ///< the number of distinct pages touched by sampled accesses
+    size_t width = 0;         ///< the width of the profiled container
+    size_t pack_bits = 0;     ///< the number of bits per word pack of the profiled container
+    size_t memory_bytes = 0;  ///< the number of heap bytes used by the profiled container
+    bool fixed_width = false; ///< whether the profiled container has a width known at compile time
+
+    /**
+     * \brief Reports the fraction of sampled accesses that are sequential
+     *
+     * \return the fraction of sampled accesses within one cache line of the preceding access
+     */
+    double sequential_ratio() const { return samples ? double(sequential) / double(samples) : 0.0; }
+
+    /**
+     * \brief Reports the fraction of sampled accesses that are reads
+     *
+     * \return the fraction of sampled reads
+     */
+    double read_ratio() const { return samples ? double(reads) / double(samples) : 0.0; }
+
+    /**
+     * \brief Reports the fraction of sampled accesses to integers that straddle two word packs
+     *
+     * \return the fraction of straddling sampled accesses
+     */
+    double straddling_ratio() const { return samples ? double(straddling) / double(samples) : 0.0; }
+
+    /**
+     * \brief Estimates the working set size
+     *
+     * Sampling may miss pages, so this is a lower bound.
+     *
+     * \return the number of bytes of the distinct pages touched
+     */
+    size_t working_set_bytes() const { return pages * PAGE_BYTES; }
+
+    /**
+     * \brief Derives layout and tuning changes from the profile
+     *
+     * The following rules apply:
+     * - a fixed width is recommended for containers with a runtime width that were accessed at least once per integer on average,
+     * - the padded bit order is recommended if most accesses are random, at least a tenth of them straddle two word packs
+     *   and padding wastes at most an eighth of each word pack,
+     * - huge pages are recommended if most accesses are random and the working set exceeds the reach of a typical TLB (8 MiB), and
+     * - block compression is recommended if at least 90 percent of the accesses are sequential reads.
+     *
+     * \param size the number of integers in the profiled container
+     * \return the recommendation
+     */
+    Recommendation recommend(size_t const size) const {
+        constexpr size_t TLB_REACH_BYTES = 8ULL << 20;
+
+        Recommendation r;
+        if(samples == 0) return r;
+
+        bool const random = sequential_ratio() < 0.5;
+        r.fixed_width = !fixed_width && accesses >= size;
+        r.padded = random && straddling_ratio() >= 0.1 && width && 8 * (pack_bits % width) <= pack_bits;
+        r.huge_pages = random && working_set_bytes() > TLB_REACH_BYTES;
+        r.block_compression = sequential_ratio() >= 0.9 && read_ratio() >= 0.9;
+        return r;
+    }
+
+    /**
+     * \brief Prints the profile as key-value pairs in a single line
+     *
+     * Only the non-empty buckets of the stride histogram are printed, as \c stride_<b>.
+     *
+     * \param out the output stream
+     * \param name the name to print along with the profile
+     */
+    void print(std::ostream& out, std::string_view const name) const {
+        out << "PROFILE name=" << name <<
+            " accesses=" << accesses <<
+            " samples=" << samples <<
+            " reads=" << reads <<
+            " writes=" << writes <<
+            " sequential=" << sequential <<
+            " backward=" << backward <<
+            " straddling=" << straddling <<
+            " working_set_bytes=" << working_set_bytes();
+        for(size_t b = 0; b < NUM_STRIDE_BUCKETS; b++) {
+            if(stride_histogram[b]) out << " stride_" << b << "=" << stride_histogram[b];
+        }
+        out << std::endl;
+    }
+};
+
+/**
+ * \brief Sampling access profiler wrapping a packed container
+ *
+ * Reads and writes are forwarded to the wrapped container.
+ * Every k-th access is sampled: its stride to the preceding access, whether it is a read or a write,
+ * whether the integer straddles two word packs and the memory page it touches are recorded in an \ref AccessProfile .
+ * Accesses that are not sampled cost no more than a decrement and a store.
+ *
+ * The wrapped container is referenced, not copied, and may be modified directly while it is profiled; such accesses are not recorded.
+ * The profiler itself is not thread-safe.
+ *
+ * \tparam Container the container type, e.g., \ref PackedIntVector
+ */
+template<typename Container>
+class Profiled {
+private:
+    using Pack = internal::pack_of<Container>;
+    static constexpr size_t PACK_BITS = std::numeric_limits<Pack>::digits;
+    static constexpr size_t CACHE_LINE_BITS = 512;
+
+    Container* container_;
+    size_t period_;
+    size_t countdown_;
+    size_t last_;
+    AccessProfile profile_;
+    PackedFixedWidthIntVector<1> touched_pages_;
+
+    void sample(size_t const i, bool const write) {
+        auto& p = profile_;
+        size_t const width = container_->width();
+        size_t const stride = i >= last_ ? i - last_ : last_ - i;
+
+        ++p.samples;
+        ++(write ? p.writes : p.reads);
+        if(stride * width <= CACHE_LINE_BITS) ++p.sequential;
+        if(i < last_) ++p.backward;
+        ++p.stride_histogram[std::bit_width(stride)];
+        if(Container::BitOrderType::template straddles<Pack>(i, width)) ++p.straddling;
+
+        size_t const page = Container::BitOrderType::template pack_index<Pack>(i, width) * sizeof(Pack) / AccessProfile::PAGE_BYTES;
+        if(page >= touched_pages_.size()) {
+            // nb: grow the bitmap and zero the new bits, the pages are not known in advance if the container grows
+            size_t const old_size = touched_pages_.size();
+            touched_pages_.resize(std::max(page + 1, 2 * old_size));
+            for(size_t q = old_size; q < touched_pages_.size(); q++) touched_pages_.set(q, 0);
+        }
+        if(!touched_pages_.get(page)) {
+            touched_pages_.set(page, 1);
+            ++p.pages;
+        }
+    }
+
+    void record(size_t const i, bool const write) {
+        ++profile_.accesses;
+        if(--countdown_ == 0) {
+            countdown_ = period_;
+            sample(i, write);
+        }
+        last_ = i;
+    }
+
+public:
+    /**
+     * \brief Starts profiling accesses to the given container
+     *
+     * \param container the container to profile
+     * \param period the sampling period, i.e., every \c period -th access is sampled
+     */
+    Profiled(Container& container, size_t const period = 64) : container_(&container), period_(period), countdown_(period), last_(0) {
+        assert(period > 0);
+        size_t const num_pages = internal::idiv_ceil(container.memory_usage(), AccessProfile::PAGE_BYTES);
+        touched_pages_ = PackedFixedWidthIntVector<1>(std::max(num_pages, size_t(1)));
+        reset();
+    }
+
+    /**
+     * \brief Reads an integer from the container
+     *
+     * \param i the index of the integer
+     * \return the integer at the given index
+     */
+    uintmax_t get(size_t const i) {
+        record(i, false);
+        return container_->get(i);
+    }
+
+    /**
+     * \brief Writes an integer to the container
+     *
+     * \param i the index of the integer
+     * \param x the integer to write
+     */
+    void set(size_t const i, uintmax_t const x) {
+        record(i, true);
+        container_->set(i, x);
+    }
+
+    /**
+     * \brief Provides profiled read/write access to a specific integer in the container
+     *
+     * \param i the index of the integer
+     * \return a proxy allowing reading and writing
+     */
+    auto operator[](size_t const i) { return internal::IntRef<Profiled>(*this, i); }
+
+    /**
+     * \brief Reports the number of integers in the container
+     *
+     * \return the number of integers in the container
+     */
+    size_t size() const { return container_->size(); }
+
+    /**
+     * \brief Reports the width of the integers in the container
+     *
+     * \return the width of the integers in the container
+     */
+    size_t width() const { return container_->width(); }
+
+    /**
+     * \brief Provides direct access to the profiled container
+     *
+     * \return the profiled container
+     */
+    Container& container() { return *container_; }
+
+    /**
+     * \brief Reports the access statistics gathered so far
+     *
+     * \return the access profile
+     */
+    AccessProfile profile() const {
+        AccessProfile p = profile_;
+        p.width = container_->width();
+        p.pack_bits = PACK_BITS;
+        p.memory_bytes = container_->memory_usage();
+        p.fixed_width = internal::is_fixed_width<Container>::value;
+        return p;
+    }
+
+    /**
+     * \brief Derives layout and tuning changes from the access statistics gathered so far
+     *
+     * \return the recommendation (\see AccessProfile::recommend)
+     */
+    Recommendation recommend() const { return profile().recommend(container_->size()); }
+
+    /**
+     * \brief Discards the access statistics gathered so far
+     *
+     */
+    void reset() {
+        profile_ = AccessProfile();
+        countdown_ = period_;
+        std::fill(touched_pages_.data(), touched_pages_.data() + num_packs_required<uintmax_t>(touched_pages_.size(), 1), 0);
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,236 @@
+/**
+ * word_packing/rank_select.hpp
+ * part of pdinklag/word-packing
+ * 
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _WORD_PACKING_RANK_SELECT_HPP
+#define _WORD_PACKING_RANK_SELECT_HPP
+
+#include "internal/alloc.hpp"
+#include "internal/cpu.hpp"
+#include "packed_fixed_width_int_vector.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <memory>
+
+namespace word_packing {
+
+namespace internal {
+    // stores the number of set bits preceding each block of the given size and returns the total number of set bits
+    template<size_t block_bits, WordPackEligible Pack>
+    [[gnu::always_inline]] inline size_t count_block_ranks(Pack const* data, size_t const size, size_t* blocks, size_t const num_blocks) {
+        constexpr size_t PACK_BITS = std::numeric_limits<Pack>::digits;
+        constexpr size_t PACKS_PER_BLOCK = block_bits / PACK_BITS;
+
+        size_t const num_packs = num_packs_required<Pack>(size, 1);
+        size_t const tail = size % PACK_BITS;
+
+        size_t ones = 0;
+        for(size_t b = 0; b < num_blocks; b++) {
+            blocks[b] = ones;
+
+            size_t const p_end = std::min(num_packs, (b + 1) * PACKS_PER_BLOCK);
+            for(size_t p = b * PACKS_PER_BLOCK; p < p_end; p++) {
+                uintmax_t x = data[p];
+                if(tail && p == num_packs - 1) x &= low_mask0(tail); // ignore bits beyond the end
+                ones += std::popcount(x);
+            }
+        }
+        blocks[num_blocks] = ones;
+        return ones;
+    }
+
+#ifdef WORD_PACKING_X86_DISPATCH
+    template<size_t block_bits, WordPackEligible Pack>
+    [[gnu::target("popcnt")]] size_t count_block_ranks_popcnt(Pack const* data, size_t const size, size_t* blocks, size_t const num_blocks) {
+        return count_block_ranks<block_bits>(data, size, blocks, num_blocks);
+    }
+#endif
+}
+
+/**
+ * \brief Rank and select support for packed bits
+ *
+ * This structure stores the number of set bits preceding each block of 512 bits, using one integer per block.
+ * Rank queries are answered by a table lookup followed by popcounts over at most one block,
+ * select queries by a binary search over the block table followed by a scan over at most one block.
+ *
+ * The supported bits are referenced, not copied, so they must neither be modified nor moved in memory while the structure is in use.
+ *
+ * \tparam Pack the word pack type of the supported bits
+ */
+template<WordPackEligible Pack = uintmax_t>
+class RankSelect {
+private:
+    static constexpr size_t PACK_BITS = std::numeric_limits<Pack>::digits;
+    static constexpr size_t BLOCK_BITS = 512;
+    static constexpr size_t PACKS_PER_BLOCK = BLOCK_BITS / PACK_BITS;
+
+    Pack const* data_;
+    size_t size_;
+    size_t num_blocks_;
+    size_t num_ones_;
+    internal::CountedArray<size_t> blocks_;
+
+    size_t zeros_before_block(size_t const b) const { return b * BLOCK_BITS - blocks_[b]; }
+
+public:
+    /**
+     * \brief Constructs an empty rank and select support
+     *
+     */
+    RankSelect() : data_(nullptr), size_(0), num_blocks_(0), num_ones_(0) {
+    }
+
+    RankSelect(RankSelect&&) = default;
+    RankSelect& operator=(RankSelect&&) = default;
+
+    /**
+     * \brief Constructs rank and select support for the given array of packed bits
+     *
+     * \param data the array of packed bits
+     * \param size the number of bits
+     */
+    RankSelect(Pack const* data, size_t size) : data_(data), size_(size), num_blocks_(internal::idiv_ceil(size, BLOCK_BITS)) {
+        blocks_ = internal::make_counted_array<size_t>(num_blocks_ + 1);
+
+        // the block table is counted using the popcnt instruction if the CPU supports it, which is detected at runtime
+    #ifdef WORD_PACKING_X86_DISPATCH
+        if(internal::cpu::has_popcnt()) {
+            num_ones_ = internal::count_block_ranks_popcnt<BLOCK_BITS>(data_, size_, blocks_.get(), num_blocks_);
+            return;
+        }
+    #endif
+        num_ones_ = internal::count_block_ranks<BLOCK_BITS>(data_, size_, blocks_.get(), num_blocks_);
+    }
+
+    /**
+     * \brief Constructs rank and select support for the given bit vector
+     *
+     * \param bv the bit vector
+     */
+    RankSelect(PackedFixedWidthIntVector<1, Pack> const& bv) : RankSelect(bv.data(), bv.size()) {
+    }
+
+    /**
+     * \brief Counts the set bits preceding the given position
+     *
+     * \param i the position, at most \ref size
+     * \return the number of set bits in the range [0, i)
+     */
+    size_t rank1(size_t const i) const {
+        assert(i <= size_);
+
+        size_t const b = i / BLOCK_BITS;
+        size_t const p_end = i / PACK_BITS;
+
+        size_t r = blocks_[b];
+        for(size_t p = b * PACKS_PER_BLOCK; p < p_end; p++) r += std::popcount(data_[p]);
+
+        size_t const j = i % PACK_BITS;
+        if(j) r += std::popcount(uintmax_t(data_[p_end]) & internal::low_mask0(j));
+        return r;
+    }
+
+    /**
+     * \brief Counts the unset bits preceding the given position
+     *
+     * \param i the position, at most \ref size
+     * \return the number of unset bits in the range [0, i)
+     */
+    size_t rank0(size_t const i) const { return i - rank1(i); }
+
+    /**
+     * \brief Finds the position of the k-th set bit
+     *
+     * \param k the zero-based number of the set bit to find
+     * \return the position of the k-th set bit, or \ref size if there are not enough set bits
+     */
+    size_t select1(size_t k) const {
+        if(k >= num_ones_) return size_;
+
+        size_t const b = std::upper_bound(blocks_.get(), blocks_.get() + num_blocks_ + 1, k) - blocks_.get() - 1;
+        k -= blocks_[b];
+
+        for(size_t p = b * PACKS_PER_BLOCK;; p++) {
+            size_t const c = std::popcount(data_[p]);
+            if(k < c) return p * PACK_BITS + internal::select1_in_word(data_[p], k);
+            k -= c;
+        }
+    }
+
+    /**
+     * \brief Finds the position of the k-th unset bit
+     *
+     * \param k the zero-based number of the unset bit to find
+     * \return the position of the k-th unset bit, or \ref size if there are not enough unset bits
+     */
+    size_t select0(size_t k) const {
+        if(k >= size_ - num_ones_) return size_;
+
+        // binary search for the last block preceded by at most k unset bits
+        size_t lo = 0, hi = num_blocks_;
+        while(hi - lo > 1) {
+            size_t const m = (lo + hi) / 2;
+            if(zeros_before_block(m) <= k) lo = m; else hi = m;
+        }
+        k -= zeros_before_block(lo);
+
+        for(size_t p = lo * PACKS_PER_BLOCK;; p++) {
+            uintmax_t const x = Pack(~data_[p]);
+            size_t const c = std::popcount(x);
+            if(k < c) return p * PACK_BITS + internal::select1_in_word(x, k);
+            k -= c;
+        }
+    }
+
+    /**
+     * \brief Reports the total number of set bits
+     *
+     * \return the total number of set bits
+     */
+    size_t num_ones() const { return num_ones_; }
+
+    /**
+     * \brief Reports the number of supported bits
+     *
+     * \return the number of supported bits
+     */
+    size_t size() const { return size_; }
+
+    /**
+     * \brief Reports the number of heap bytes used by the structure
+     *
+     * The supported bits are not included, only the block table.
+     *
+     * \return the number of heap bytes used
+     */
+    size_t memory_usage() const { return blocks_ ? (num_blocks_ + 1) * sizeof(size_t) : 0; }
+};
+
+}
+
+#endif
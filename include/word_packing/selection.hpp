@@ -0,0 +1,229 @@
+/**
+ * word_packing/selection.hpp
+ * part of pdinklag/word-packing
+ * 
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _WORD_PACKING_SELECTION_HPP
+#define _WORD_PACKING_SELECTION_HPP
+
+#include "bool_conversion.hpp"
+#include "internal/cpu.hpp"
+#include "packed_fixed_width_int_vector.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+namespace word_packing {
+
+/**
+ * \brief Strategies for decoding the integers selected by a bit mask
+ */
+enum class SelectionStrategy {
+    AUTO,   ///< pick one of the other strategies according to the fraction of selected integers
+    DENSE,  ///< decode blocks of 64 integers and compress the selected ones
+    SPARSE, ///< read the selected integers individually, prefetching upcoming ones
+};
+
+namespace internal {
+    // compression of the selected integers among 64 decoded ones without instruction set extensions
+    struct SelectPortable {
+        // stores buf[k] for every set bit k of w consecutively and returns the number of stored integers
+        static size_t compress(uintmax_t const* buf, uint64_t const w, uintmax_t* out) {
+            // every integer is stored, but the output position only advances for the selected ones, which avoids branches
+            // nb: this may store one integer beyond the selected ones, so it is done in a local buffer
+            uintmax_t tmp[65];
+            size_t n = 0;
+            for(size_t k = 0; k < 64; k++) {
+                tmp[n] = buf[k];
+                n += (w >> k) & 1;
+            }
+            std::copy(tmp, tmp + n, out);
+            return n;
+        }
+    };
+
+#ifdef WORD_PACKING_X86_DISPATCH
+    // compresses the indices of each group of eight selected integers using a parallel bit extract
+    struct SelectBmi2 {
+        [[gnu::target("bmi2")]] static size_t compress(uintmax_t const* buf, uint64_t const w, uintmax_t* out) {
+            size_t n = 0;
+            for(size_t g = 0; g < 8; g++) {
+                uint64_t const m = uint8_t(w >> (8 * g));
+                uint64_t const lanes = _pdep_u64(m, 0x0101010101010101ULL) * 0xFF; // one byte per selected integer
+                uint64_t idx = _pext_u64(0x0706050403020100ULL, lanes);            // the indices of the selected integers
+                size_t const c = std::popcount(m);
+                for(size_t k = 0; k < c; k++, idx >>= 8) out[n + k] = buf[8 * g + (idx & 0xFF)];
+                n += c;
+            }
+            return n;
+        }
+    };
+
+    // compresses each group of eight selected integers using a single masked compress store
+    struct SelectAvx512 {
+        [[gnu::target("avx512f")]] static size_t compress(uintmax_t const* buf, uint64_t const w, uintmax_t* out) {
+            static_assert(sizeof(uintmax_t) == 8);
+            size_t n = 0;
+            for(size_t g = 0; g < 8; g++) {
+                __mmask8 const m = uint8_t(w >> (8 * g));
+                _mm512_mask_compressstoreu_epi64(out + n, m, _mm512_loadu_si512(buf + 8 * g));
+                n += std::popcount(uint8_t(m));
+            }
+            return n;
+        }
+    };
+#endif
+
+    // the mask bits for the integers [64w, 64w+64), with bits beyond the end unset
+    template<WordPackEligible Pack>
+    inline uint64_t selection_word(Pack const* mask, size_t const w, size_t const size) {
+        size_t const tail = size - 64 * w;
+        if(tail >= 64) return load64(mask, w);
+
+        // the last word may be covered only partially by word packs narrower than 64 bits, so only the existing ones are read
+        constexpr size_t PACK_BITS = std::numeric_limits<Pack>::digits;
+        constexpr size_t PACKS_PER_WORD = 64 / PACK_BITS;
+        size_t const num_packs = num_packs_required<Pack>(size, 1);
+        uint64_t x = 0;
+        for(size_t p = w * PACKS_PER_WORD; p < num_packs; p++) x |= uint64_t(mask[p]) << ((p - w * PACKS_PER_WORD) * PACK_BITS);
+        return x & low_mask0(tail);
+    }
+
+    // decodes blocks of 64 integers that contain selected ones and compresses the selected integers
+    template<typename Isa, typename Column, WordPackEligible MaskPack>
+    [[gnu::always_inline]] inline size_t decode_selected_dense(Column const& column, MaskPack const* mask, uintmax_t* out) {
+        size_t const size = column.size();
+        uintmax_t buf[64] = {};
+
+        size_t n = 0;
+        for(size_t w = 0; w < idiv_ceil(size, 64); w++) {
+            uint64_t const x = selection_word(mask, w, size);
+            if(x == 0) continue;
+
+            size_t const base = 64 * w;
+            if(x == UINT64_MAX) {
+                // all integers are selected, decode them directly into the output
+                column.unpack(base, 64, out + n);
+                n += 64;
+            } else {
+                column.unpack(base, std::min(size - base, size_t(64)), buf);
+                n += Isa::compress(buf, x, out + n);
+            }
+        }
+        return n;
+    }
+
+#ifdef WORD_PACKING_X86_DISPATCH
+    template<typename Column, WordPackEligible MaskPack>
+    [[gnu::target("bmi2")]] size_t decode_selected_dense_bmi2(Column const& column, MaskPack const* mask, uintmax_t* out) {
+        return decode_selected_dense<SelectBmi2>(column, mask, out);
+    }
+
+    template<typename Column, WordPackEligible MaskPack>
+    [[gnu::target("avx512f")]] size_t decode_selected_dense_avx512(Column const& column, MaskPack const* mask, uintmax_t* out) {
+        return decode_selected_dense<SelectAvx512>(column, mask, out);
+    }
+#endif
+
+    // reads the selected integers individually, prefetching the word packs of upcoming selected integers
+    template<typename Column, WordPackEligible MaskPack>
+    inline size_t decode_selected_sparse(Column const& column, MaskPack const* mask, uintmax_t* out) {
+        constexpr size_t LOOKAHEAD = 8;
+        using Pack = pack_of<Column>;
+        using BitOrder = typename Column::BitOrderType;
+
+        size_t const size = column.size();
+        size_t const width = column.width();
+
+        // the positions of selected integers are queued for LOOKAHEAD steps after their word packs are prefetched
+        size_t queue[LOOKAHEAD];
+        size_t n = 0, queued = 0;
+        for(size_t w = 0; w < idiv_ceil(size, 64); w++) {
+            uint64_t x = selection_word(mask, w, size);
+            while(x) {
+                size_t const i = 64 * w + std::countr_zero(x);
+                x &= x - 1;
+
+                __builtin_prefetch(column.data() + BitOrder::template pack_index<Pack>(i, width));
+                if(queued >= LOOKAHEAD) out[n++] = column.get(queue[queued % LOOKAHEAD]);
+                queue[queued++ % LOOKAHEAD] = i;
+            }
+        }
+
+        // drain the queue
+        for(size_t k = queued > LOOKAHEAD ? queued - LOOKAHEAD : 0; k < queued; k++) out[n++] = column.get(queue[k % LOOKAHEAD]);
+        return n;
+    }
+}
+
+/**
+ * \brief Decodes the integers of a column at the positions of the set bits in a mask
+ *
+ * Unless a strategy is given, the fraction of set bits in the mask, counted using popcount, selects the strategy.
+ * If at least half of the integers are selected, each block of 64 integers containing a selected one is unpacked at once,
+ * and the selected integers are compressed into the output.
+ * Depending on the CPU, which is detected at runtime, this is done using AVX-512 compress stores, BMI2 `pext` on the lane indices,
+ * or branchless stores.
+ * Otherwise, the selected integers are read individually and the word packs of upcoming ones are prefetched.
+ *
+ * \tparam Column the column type, e.g., \ref PackedIntVector
+ * \param column the column
+ * \param mask the mask, which must have the same size as the column
+ * \param out the output array, which must have room for as many integers as there are set bits in the mask
+ * \param strategy the strategy
+ * \return the number of decoded integers, i.e., the number of set bits in the mask
+ */
+template<typename Column, WordPackEligible MaskPack, typename MaskBitOrder, typename MaskStats>
+size_t decode_selected(
+    Column const& column,
+    PackedFixedWidthIntVector<1, MaskPack, MaskBitOrder, MaskStats> const& mask,
+    uintmax_t* out,
+    SelectionStrategy strategy = SelectionStrategy::AUTO) {
+
+    static_assert(!std::is_same_v<MaskBitOrder, bit_order::MsbFirst>, "the mask must store bits starting from the least significant bit");
+    assert(mask.size() == column.size());
+
+    if(strategy == SelectionStrategy::AUTO) {
+        size_t const ones = mask.count_range(0, mask.size());
+        strategy = (2 * ones >= mask.size()) ? SelectionStrategy::DENSE : SelectionStrategy::SPARSE;
+    }
+
+    if(strategy == SelectionStrategy::SPARSE) return internal::decode_selected_sparse(column, mask.data(), out);
+
+#ifdef WORD_PACKING_X86_DISPATCH
+    if(internal::cpu::has_avx512bw()) return internal::decode_selected_dense_avx512(column, mask.data(), out);
+    if(internal::cpu::has_bmi2()) return internal::decode_selected_dense_bmi2(column, mask.data(), out);
+#endif
+    return internal::decode_selected_dense<internal::SelectPortable>(column, mask.data(), out);
+}
+
+}
+
+#endif
@@ -0,0 +1,266 @@
+/**
+ * word_packing/stats.hpp
+ * part of pdinklag/word-packing
+ * 
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _WORD_PACKING_STATS_HPP
+#define _WORD_PACKING_STATS_HPP
+
+#include "util.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+/**
+ * \brief Instrumentation policies for packed integer access
+ *
+ * The policies are passed as template parameters to containers and accessors, which report every access to them.
+ * The default policy \ref None ignores all reports and causes no overhead whatsoever.
+ */
+namespace word_packing::stats {
+
+/**
+ * \brief A snapshot of access counters
+ */
+struct Counters {
+    uint64_t gets = 0;            ///< the number of integers read
+    uint64_t straddling_gets = 0; ///< the number of integers read that straddle two word packs
+    uint64_t sets = 0;            ///< the number of integers written
+    uint64_t straddling_sets = 0; ///< the number of integers written that straddle two word packs
+    uint64_t adds = 0;            ///< the number of integers added to
+    uint64_t straddling_adds = 0; ///< the number of integers added to that straddle two word packs
+    uint64_t bulk_calls = 0;      ///< the number of calls to bulk operations
+    uint64_t bulk_elements = 0;   ///< the number of integers processed by bulk operations
+
+    /**
+     * \brief Prints the counters as key-value pairs in a single line
+     *
+     * \param out the output stream
+     * \param name the name to print along with the counters
+     */
+    void print(std::ostream& out, std::string_view const name) const {
+        out << "STATS name=" << name <<
+            " gets=" << gets <<
+            " straddling_gets=" << straddling_gets <<
+            " sets=" << sets <<
+            " straddling_sets=" << straddling_sets <<
+            " adds=" << adds <<
+            " straddling_adds=" << straddling_adds <<
+            " bulk_calls=" << bulk_calls <<
+            " bulk_elements=" << bulk_elements << std::endl;
+    }
+};
+
+/**
+ * \brief Instrumentation policy that ignores all accesses
+ *
+ * This is the default policy.
+ */
+struct None {
+    static constexpr bool enabled = false;
+
+    static void get(bool) {}
+    static void set(bool) {}
+    static void add(bool) {}
+    static void bulk(size_t) {}
+};
+
+/**
+ * \brief Instrumentation policy that counts accesses
+ *
+ * Each thread counts in its own set of counters, which are summed up only when the counters are aggregated.
+ * The counters of exited threads are retained.
+ * All containers and accessors using the same policy type share the same counters,
+ * so a distinct tag type should be used for every group of containers to be observed separately.
+ *
+ * \tparam Tag a type to distinguish between sets of counters
+ */
+template<typename Tag = void>
+class Counting {
+private:
+    enum Event { GET, STRADDLING_GET, SET, STRADDLING_SET, ADD, STRADDLING_ADD, BULK_CALL, BULK_ELEMENT, NUM_EVENTS };
+
+    struct ThreadCounters {
+        std::atomic<uint64_t> count[NUM_EVENTS] = {};
+    };
+
+    struct Registry {
+        std::mutex mutex;
+        std::vector<ThreadCounters*> threads;
+        uint64_t retired[NUM_EVENTS] = {};
+    };
+
+    static Registry& registry() {
+        static Registry r;
+        return r;
+    }
+
+    // registers the counters of a thread on construction and retires them on destruction
+    struct ThreadSlot {
+        ThreadCounters counters;
+
+        ThreadSlot() {
+            auto& r = registry();
+            std::lock_guard lock(r.mutex);
+            r.threads.push_back(&counters);
+        }
+
+        ~ThreadSlot() {
+            auto& r = registry();
+            std::lock_guard lock(r.mutex);
+            for(size_t e = 0; e < NUM_EVENTS; e++) r.retired[e] += counters.count[e].load(std::memory_order_relaxed);
+            r.threads.erase(std::find(r.threads.begin(), r.threads.end(), &counters));
+        }
+    };
+
+    static void count(Event const e, uint64_t const n = 1) {
+        thread_local ThreadSlot slot;
+        // nb: only the owning thread writes, so there is no need for an atomic read-modify-write
+        auto& c = slot.counters.count[e];
+        c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+public:
+    static constexpr bool enabled = true;
+
+    /**
+     * \brief Counts an integer read
+     *
+     * \param straddles whether the integer straddles two word packs
+     */
+    static void get(bool const straddles) {
+        count(GET);
+        if(straddles) count(STRADDLING_GET);
+    }
+
+    /**
+     * \brief Counts an integer write
+     *
+     * \param straddles whether the integer straddles two word packs
+     */
+    static void set(bool const straddles) {
+        count(SET);
+        if(straddles) count(STRADDLING_SET);
+    }
+
+    /**
+     * \brief Counts an addition to an integer
+     *
+     * \param straddles whether the integer straddles two word packs
+     */
+    static void add(bool const straddles) {
+        count(ADD);
+        if(straddles) count(STRADDLING_ADD);
+    }
+
+    /**
+     * \brief Counts a call to a bulk operation
+     *
+     * \param num the number of integers processed by the operation
+     */
+    static void bulk(size_t const num) {
+        count(BULK_CALL);
+        count(BULK_ELEMENT, num);
+    }
+
+    /**
+     * \brief Sums up the counters of all threads
+     *
+     * \return the aggregated counters
+     */
+    static Counters aggregate() {
+        uint64_t sum[NUM_EVENTS];
+        {
+            auto& r = registry();
+            std::lock_guard lock(r.mutex);
+            std::copy(r.retired, r.retired + NUM_EVENTS, sum);
+            for(auto const* t : r.threads) {
+                for(size_t e = 0; e < NUM_EVENTS; e++) sum[e] += t->count[e].load(std::memory_order_relaxed);
+            }
+        }
+
+        Counters c;
+        c.gets = sum[GET];
+        c.straddling_gets = sum[STRADDLING_GET];
+        c.sets = sum[SET];
+        c.straddling_sets = sum[STRADDLING_SET];
+        c.adds = sum[ADD];
+        c.straddling_adds = sum[STRADDLING_ADD];
+        c.bulk_calls = sum[BULK_CALL];
+        c.bulk_elements = sum[BULK_ELEMENT];
+        return c;
+    }
+
+    /**
+     * \brief Resets the counters of all threads to zero
+     *
+     * This should only be done while no other thread is counting.
+     */
+    static void reset() {
+        auto& r = registry();
+        std::lock_guard lock(r.mutex);
+        std::fill(r.retired, r.retired + NUM_EVENTS, 0);
+        for(auto* t : r.threads) {
+            for(auto& c : t->count) c.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * \brief Prints the aggregated counters
+     *
+     * \param out the output stream
+     * \param name the name to print along with the counters
+     */
+    static void dump(std::ostream& out, std::string_view const name) { aggregate().print(out, name); }
+};
+
+}
+
+namespace word_packing::internal {
+
+template<typename Stats, typename BitOrder, WordPackEligible Pack>
+inline void record_get(size_t const i, size_t const width) {
+    if constexpr(Stats::enabled) Stats::get(BitOrder::template straddles<Pack>(i, width));
+}
+
+template<typename Stats, typename BitOrder, WordPackEligible Pack>
+inline void record_set(size_t const i, size_t const width) {
+    if constexpr(Stats::enabled) Stats::set(BitOrder::template straddles<Pack>(i, width));
+}
+
+template<typename Stats, typename BitOrder, WordPackEligible Pack>
+inline void record_add(size_t const i, size_t const width) {
+    if constexpr(Stats::enabled) Stats::add(BitOrder::template straddles<Pack>(i, width));
+}
+
+}
+
+#endif
@@ -0,0 +1,357 @@
+/**
+ * word_packing/varint.hpp
+ * part of pdinklag/word-packing
+ * 
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _WORD_PACKING_VARINT_HPP
+#define _WORD_PACKING_VARINT_HPP
+
+#include "internal/bit_stream.hpp"
+#include "internal/cpu.hpp"
+#include "packed_int_vector.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <vector>
+
+namespace word_packing::internal {
+
+// LEB128 decoding without instruction set extensions, using windows of eight bytes
+struct Leb128Portable {
+    static constexpr size_t WINDOW = 8;
+
+    // finds the bytes of the window without a continuation bit, one bit per byte
+    static uint64_t stops(uint8_t const* p) {
+        uint64_t w;
+        std::memcpy(&w, p, 8);
+        uint64_t const x = ~w & 0x8080808080808080ULL;
+        return ((x >> 7) * 0x0102040810204080ULL) >> 56; // nb: gathers the lowest bit of each byte
+    }
+
+    // extracts the payload of an integer of the given length from its loaded bytes, one byte at a time
+    static uint64_t extract(uint64_t const bytes, size_t const len) {
+        uint64_t x = 0;
+        for(size_t j = 0; j < len; j++) x |= ((bytes >> (8 * j)) & 0x7F) << (7 * j);
+        return x;
+    }
+};
+
+#ifdef WORD_PACKING_X86_DISPATCH
+// LEB128 decoding using windows of 16 bytes, whose continuation bits are gathered using `movemask`,
+// and parallel bit extraction of the payloads
+struct Leb128Bmi2 {
+    static constexpr size_t WINDOW = 16;
+
+    [[gnu::target("sse2")]] static uint64_t stops(uint8_t const* p) {
+        return uint16_t(~_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const*>(p))));
+    }
+
+    [[gnu::target("bmi2")]] static uint64_t extract(uint64_t const bytes, size_t) {
+        return _pext_u64(bytes, 0x7F7F7F7F7F7F7F7FULL);
+    }
+};
+
+// LEB128 decoding using windows of 64 bytes, whose continuation bits are gathered into a mask register
+struct Leb128Avx512 : public Leb128Bmi2 {
+    static constexpr size_t WINDOW = 64;
+
+    [[gnu::target("avx512bw")]] static uint64_t stops(uint8_t const* p) {
+        return ~_mm512_movepi8_mask(_mm512_loadu_si512(p));
+    }
+};
+#endif
+
+template<typename Isa, WordPackEligible Pack>
+[[gnu::always_inline]] inline bool decode_leb128_kernel(uint8_t const* in, size_t const in_size, size_t const num, PackedIntVector<Pack>& out, size_t const out_off) {
+    uint8_t const* p = in;
+    uint8_t const* const end = in + in_size;
+    uintmax_t const mask = low_mask(out.width());
+
+    size_t i = 0;
+    while(i < num) {
+        uint64_t x;
+        if(std::endian::native == std::endian::little && size_t(end - p) >= Isa::WINDOW + 8) {
+            // nb: the slack of eight bytes allows loading eight bytes at any integer that ends within the window
+            uint64_t stops = Isa::stops(p);
+            if(stops == low_mask(Isa::WINDOW)) {
+                // the window consists of single-byte integers only
+                size_t const m = std::min(Isa::WINDOW, num - i);
+                for(size_t k = 0; k < m; k++) {
+                    if(p[k] & ~mask) return false;
+                    out.set(out_off + i + k, p[k]);
+                }
+                p += m;
+                i += m;
+                continue;
+            }
+
+            // decode the integers that end within the window and are encoded in at most eight bytes
+            uint8_t const* const window = p;
+            while(stops && i < num) {
+                size_t const len = std::countr_zero(stops) + 1;
+                if(len > 8) break;
+
+                uint64_t w;
+                std::memcpy(&w, p, 8);
+                x = Isa::extract(w & low_mask(8 * len), len);
+                if(x & ~mask) return false;
+                out.set(out_off + i, x);
+
+                p += len;
+                ++i;
+                stops >>= len;
+            }
+            if(p != window) continue;
+        }
+
+        // decode a single integer byte by byte
+        if(!read_uleb128(p, end, x)) return false;
+        if(x & ~mask) return false;
+        out.set(out_off + i, x);
+        ++i;
+    }
+    return true;
+}
+
+#ifdef WORD_PACKING_X86_DISPATCH
+template<WordPackEligible Pack>
+[[gnu::target("sse2,bmi2")]] bool decode_leb128_bmi2(uint8_t const* in, size_t const in_size, size_t const num, PackedIntVector<Pack>& out, size_t const out_off) {
+    return decode_leb128_kernel<Leb128Bmi2>(in, in_size, num, out, out_off);
+}
+
+template<WordPackEligible Pack>
+[[gnu::target("avx512bw,bmi2")]] bool decode_leb128_avx512(uint8_t const* in, size_t const in_size, size_t const num, PackedIntVector<Pack>& out, size_t const out_off) {
+    return decode_leb128_kernel<Leb128Avx512>(in, in_size, num, out, out_off);
+}
+#endif
+
+// shuffle masks that move the bytes of the integers of a group varint group, given by its tag, into four 32-bit lanes
+constexpr std::array<std::array<uint8_t, 16>, 256> GROUP_VARINT_SHUFFLE = [](){
+    std::array<std::array<uint8_t, 16>, 256> table;
+    for(size_t tag = 0; tag < 256; tag++) {
+        size_t off = 0;
+        for(size_t k = 0; k < 4; k++) {
+            size_t const len = ((tag >> (2 * k)) & 0x03) + 1;
+            for(size_t b = 0; b < 4; b++) table[tag][4 * k + b] = (b < len) ? uint8_t(off + b) : 0x80; // nb: 0x80 yields a zero byte
+            off += len;
+        }
+    }
+    return table;
+}();
+
+// the number of data bytes of a group varint group with four integers, given by its tag
+constexpr std::array<uint8_t, 256> GROUP_VARINT_LENGTH = [](){
+    std::array<uint8_t, 256> table;
+    for(size_t tag = 0; tag < 256; tag++) {
+        table[tag] = 4 + (tag & 0x03) + ((tag >> 2) & 0x03) + ((tag >> 4) & 0x03) + ((tag >> 6) & 0x03);
+    }
+    return table;
+}();
+
+// decodes a full group varint group using a four-byte load per integer
+struct GroupVarintPortable {
+    static void decode(uint8_t const tag, uint8_t const* p, uint32_t* x) {
+        for(size_t k = 0; k < 4; k++) {
+            size_t const len = ((tag >> (2 * k)) & 0x03) + 1;
+            std::memcpy(x + k, p, 4);
+            x[k] &= uint32_t(low_mask(8 * len));
+            p += len;
+        }
+    }
+};
+
+#ifdef WORD_PACKING_X86_DISPATCH
+// decodes a full group varint group using a single byte shuffle
+struct GroupVarintSsse3 {
+    [[gnu::target("ssse3")]] static void decode(uint8_t const tag, uint8_t const* p, uint32_t* x) {
+        __m128i const data = _mm_loadu_si128(reinterpret_cast<__m128i const*>(p));
+        __m128i const shuffle = _mm_loadu_si128(reinterpret_cast<__m128i const*>(GROUP_VARINT_SHUFFLE[tag].data()));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(x), _mm_shuffle_epi8(data, shuffle));
+    }
+};
+#endif
+
+template<typename Isa, WordPackEligible Pack>
+[[gnu::always_inline]] inline bool decode_group_varint_kernel(uint8_t const* in, size_t const in_size, size_t const num, PackedIntVector<Pack>& out, size_t const out_off) {
+    constexpr size_t MAX_GROUP_DATA = 16; // the maximum number of bytes following a tag
+
+    uint8_t const* p = in;
+    uint8_t const* const end = in + in_size;
+    uintmax_t const mask = low_mask(out.width());
+
+    for(size_t i = 0; i < num; i += 4) {
+        if(p == end) return false;
+        uint8_t const tag = *p++;
+        size_t const m = std::min(size_t(4), num - i);
+
+        if(std::endian::native == std::endian::little && m == 4 && size_t(end - p) >= MAX_GROUP_DATA) {
+            uint32_t x[4];
+            Isa::decode(tag, p, x);
+            p += GROUP_VARINT_LENGTH[tag];
+
+            if((x[0] | x[1] | x[2] | x[3]) & ~mask) return false;
+            for(size_t k = 0; k < 4; k++) out.set(out_off + i + k, x[k]);
+        } else {
+            for(size_t k = 0; k < m; k++) {
+                size_t const len = ((tag >> (2 * k)) & 0x03) + 1;
+                if(size_t(end - p) < len) return false;
+
+                uintmax_t x = 0;
+                for(size_t b = 0; b < len; b++) x |= uintmax_t(p[b]) << (8 * b);
+                p += len;
+
+                if(x & ~mask) return false;
+                out.set(out_off + i + k, x);
+            }
+        }
+    }
+    return true;
+}
+
+#ifdef WORD_PACKING_X86_DISPATCH
+template<WordPackEligible Pack>
+[[gnu::target("ssse3")]] bool decode_group_varint_ssse3(uint8_t const* in, size_t const in_size, size_t const num, PackedIntVector<Pack>& out, size_t const out_off) {
+    return decode_group_varint_kernel<GroupVarintSsse3>(in, in_size, num, out, out_off);
+}
+#endif
+
+}
+
+/**
+ * \brief Codecs for variable-length integer encodings
+ */
+namespace word_packing::varint {
+
+/**
+ * \brief Decodes a stream of unsigned LEB128 encoded integers into a packed integer vector
+ * 
+ * On little-endian machines, the stream is processed in windows of bytes, whose continuation bits are gathered into a mask
+ * (as in Masked VByte).
+ * A window consisting of single-byte integers is copied directly.
+ * Otherwise, the integers ending within the window are decoded one after another, each length being determined by a bit scan over the mask.
+ * Depending on the CPU, which is detected at runtime, windows of 64 bytes are scanned using AVX-512BW mask registers,
+ * or windows of 16 bytes using `movemask` with payloads extracted using BMI2 `pext`;
+ * otherwise, windows of eight bytes are scanned using a multiplication trick.
+ * 
+ * \tparam Pack the word pack type of the vector
+ * \param in the encoded stream
+ * \param in_size the size, in bytes, of the encoded stream
+ * \param num the number of integers to decode
+ * \param out the vector to decode into, which must have room for the decoded integers
+ * \param out_off the position in the vector of the first decoded integer
+ * \return true if the integers were decoded
+ * \return false if the stream ended prematurely or contains an integer that exceeds 64 bits or the width of the vector,
+ * in which case the vector contents are undefined
+ */
+template<WordPackEligible Pack>
+bool decode_leb128(uint8_t const* in, size_t const in_size, size_t const num, PackedIntVector<Pack>& out, size_t const out_off = 0) {
+    assert(out_off + num <= out.size());
+
+#ifdef WORD_PACKING_X86_DISPATCH
+    if(internal::cpu::has_avx512bw() && internal::cpu::has_bmi2()) return internal::decode_leb128_avx512(in, in_size, num, out, out_off);
+    if(internal::cpu::has_bmi2()) return internal::decode_leb128_bmi2(in, in_size, num, out, out_off);
+#endif
+    return internal::decode_leb128_kernel<internal::Leb128Portable>(in, in_size, num, out, out_off);
+}
+
+/**
+ * \brief Encodes a packed integer vector as a stream of unsigned LEB128 encoded integers
+ * 
+ * \tparam Pack the word pack type of the vector
+ * \param in the vector to encode
+ * \param out the byte stream to append the encoded stream to
+ */
+template<WordPackEligible Pack>
+void encode_leb128(PackedIntVector<Pack> const& in, std::vector<uint8_t>& out) {
+    for(size_t i = 0; i < in.size(); i++) internal::write_uleb128(out, in[i]);
+}
+
+/**
+ * \brief Decodes a stream of group varint encoded integers into a packed integer vector
+ * 
+ * In the group varint encoding, integers of up to 32 bits are encoded in groups of four.
+ * Each group starts with a tag byte that contains the byte length minus one of each integer in two bits, starting from the least significant bits.
+ * The integers follow in little-endian byte order.
+ * In the final group, the tag fields of missing integers are zero and no bytes follow for them.
+ * 
+ * On little-endian machines, while a group of maximum size would fit into the remaining stream,
+ * each full group is decoded using a single SSSE3 byte shuffle (`pshufb`) selected by the tag (as in Stream VByte)
+ * if the CPU supports it, which is detected at runtime.
+ * Otherwise, each integer is read using a single four-byte load and masked according to its length.
+ * 
+ * \tparam Pack the word pack type of the vector
+ * \param in the encoded stream
+ * \param in_size the size, in bytes, of the encoded stream
+ * \param num the number of integers to decode
+ * \param out the vector to decode into, which must have room for the decoded integers
+ * \param out_off the position in the vector of the first decoded integer
+ * \return true if the integers were decoded
+ * \return false if the stream ended prematurely or contains an integer that exceeds the width of the vector,
+ * in which case the vector contents are undefined
+ */
+template<WordPackEligible Pack>
+bool decode_group_varint(uint8_t const* in, size_t const in_size, size_t const num, PackedIntVector<Pack>& out, size_t const out_off = 0) {
+    assert(out_off + num <= out.size());
+
+#ifdef WORD_PACKING_X86_DISPATCH
+    if(internal::cpu::has_ssse3()) return internal::decode_group_varint_ssse3(in, in_size, num, out, out_off);
+#endif
+    return internal::decode_group_varint_kernel<internal::GroupVarintPortable>(in, in_size, num, out, out_off);
+}
+
+/**
+ * \brief Encodes a packed integer vector as a stream of group varint encoded integers
+ * 
+ * The vector must only contain integers of up to 32 bits.
+ * 
+ * \tparam Pack the word pack type of the vector
+ * \param in the vector to encode
+ * \param out the byte stream to append the encoded stream to
+ */
+template<WordPackEligible Pack>
+void encode_group_varint(PackedIntVector<Pack> const& in, std::vector<uint8_t>& out) {
+    size_t const n = in.size();
+    for(size_t i = 0; i < n; i += 4) {
+        size_t const tag_pos = out.size();
+        out.push_back(0);
+
+        uint8_t tag = 0;
+        for(size_t k = 0; k < std::min(size_t(4), n - i); k++) {
+            uintmax_t const x = in[i + k];
+            assert(x <= UINT32_MAX);
+
+            size_t const len = std::max(internal::idiv_ceil(std::bit_width(x), 8), size_t(1));
+            tag |= (len - 1) << (2 * k);
+            for(size_t b = 0; b < len; b++) out.push_back(uint8_t(x >> (8 * b)));
+        }
+        out[tag_pos] = tag;
+    }
+}
+
+}
+
+#endif
@@ -0,0 +1,350 @@
+/**
+ * word_packing/wavelet_matrix.hpp
+ * part of pdinklag/word-packing
+ * 
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _WORD_PACKING_WAVELET_MATRIX_HPP
+#define _WORD_PACKING_WAVELET_MATRIX_HPP
+
+#include "internal/parallel.hpp"
+#include "packed_fixed_width_int_vector.hpp"
+#include "packed_int_vector.hpp"
+#include "rank_select.hpp"
+
+#include <queue>
+#include <utility>
+#include <vector>
+
+namespace word_packing {
+
+/**
+ * \brief Wavelet matrix over a sequence of packed integers
+ *
+ * For a sequence of integers of width w, the wavelet matrix consists of w bit vectors with rank and select support.
+ * Level l contains the (w-1-l)-th bit of each integer, where the integers are stably partitioned by the bits of the previous levels.
+ * This allows for answering access, rank, select and range quantile queries in O(w) time.
+ *
+ * The wavelet matrix is static; the source sequence is not required after construction.
+ */
+class WaveletMatrix {
+private:
+    using Bits = PackedFixedWidthIntVector<1>;
+    static constexpr size_t BITS_PER_PACK = std::numeric_limits<uintmax_t>::digits;
+
+    size_t size_;
+    size_t width_;
+    std::vector<Bits> levels_;
+    std::vector<RankSelect<>> rank_;
+    std::vector<size_t> zeros_;
+
+    // maps a range on level l to the corresponding range on level l+1 following the given bit
+    void descend(size_t const l, bool const bit, size_t& b, size_t& e) const {
+        if(bit) {
+            b = zeros_[l] + rank_[l].rank1(b);
+            e = zeros_[l] + rank_[l].rank1(e);
+        } else {
+            b = rank_[l].rank0(b);
+            e = rank_[l].rank0(e);
+        }
+    }
+
+    template<WordPackEligible Pack>
+    void construct(PackedIntVector<Pack> const& seq, size_t const num_threads) {
+        // divide the sequence into chunks aligned to bit packs, so threads never write the same level pack
+        size_t const num_chunks = (num_threads > 1) ? 4 * num_threads : 1;
+        size_t const chunk_len = std::max(BITS_PER_PACK, internal::idiv_ceil(internal::idiv_ceil(size_, num_chunks), BITS_PER_PACK) * BITS_PER_PACK);
+        size_t const num_active_chunks = internal::idiv_ceil(size_, chunk_len);
+
+        std::vector<size_t> chunk_zeros(num_active_chunks);
+        std::vector<std::vector<std::pair<size_t, uintmax_t>>> deferred(num_active_chunks);
+
+        PackedIntVector<Pack> cur = seq;
+        PackedIntVector<Pack> next(size_, width_);
+
+        levels_.reserve(width_);
+        zeros_.reserve(width_);
+        for(size_t l = 0; l < width_; l++) {
+            size_t const shift = width_ - 1 - l;
+            Bits bits(size_);
+
+            // write the level's bits pack by pack and count the zeros in each chunk
+            internal::parallel_for(num_threads, num_active_chunks, [&](size_t const t){
+                size_t const s = t * chunk_len;
+                size_t const e = std::min(size_, s + chunk_len);
+
+                size_t z = 0;
+                uintmax_t pack = 0;
+                for(size_t i = s; i < e; i++) {
+                    uintmax_t const bit = (cur.get(i) >> shift) & 1ULL;
+                    z += bit ^ 1ULL;
+                    pack |= bit << (i % BITS_PER_PACK);
+                    if((i + 1) % BITS_PER_PACK == 0 || i + 1 == e) {
+                        bits.data()[i / BITS_PER_PACK] = pack;
+                        pack = 0;
+                    }
+                }
+                chunk_zeros[t] = z;
+            });
+
+            size_t num_zeros = 0;
+            for(size_t t = 0; t < num_active_chunks; t++) num_zeros += chunk_zeros[t];
+
+            // stably partition the integers into the next level, zeros first
+            // nb: a chunk's output ranges may share packs with other chunks' ranges,
+            //     integers that touch such packs are deferred and written sequentially afterwards
+            auto boundary_packs = [&](size_t const b, size_t const e){
+                return std::make_pair((b * width_) / std::numeric_limits<Pack>::digits, (e * width_ - 1) / std::numeric_limits<Pack>::digits);
+            };
+            bool const concurrent = (num_threads > 1 && num_active_chunks > 1);
+
+            size_t zeros_before = 0;
+            std::vector<size_t> zero_offs(num_active_chunks);
+            for(size_t t = 0; t < num_active_chunks; t++) {
+                zero_offs[t] = zeros_before;
+                zeros_before += chunk_zeros[t];
+            }
+
+            internal::parallel_for(num_threads, num_active_chunks, [&](size_t const t){
+                size_t const s = t * chunk_len;
+                size_t const e = std::min(size_, s + chunk_len);
+
+                size_t zi = zero_offs[t];
+                size_t oi = num_zeros + (s - zero_offs[t]);
+                auto const zb = boundary_packs(zi, zi + chunk_zeros[t]);
+                auto const ob = boundary_packs(oi, oi + (e - s - chunk_zeros[t]));
+
+                for(size_t i = s; i < e; i++) {
+                    uintmax_t const x = cur.get(i);
+                    bool const bit = (x >> shift) & 1ULL;
+                    size_t const j = bit ? oi++ : zi++;
+
+                    if(concurrent) {
+                        auto const packs = boundary_packs(j, j + 1);
+                        auto const& range = bit ? ob : zb;
+                        if(packs.first == range.first || packs.second == range.second) {
+                            deferred[t].emplace_back(j, x);
+                            continue;
+                        }
+                    }
+                    next.set(j, x);
+                }
+            });
+
+            for(auto& d : deferred) {
+                for(auto const& [j, x] : d) next.set(j, x);
+                d.clear();
+            }
+
+            std::swap(cur, next);
+            levels_.push_back(std::move(bits));
+            zeros_.push_back(num_zeros);
+        }
+
+        // build rank and select support for all levels
+        rank_.resize(width_);
+        internal::parallel_for(num_threads, width_, [&](size_t const l){
+            rank_[l] = RankSelect<>(levels_[l]);
+        });
+    }
+
+public:
+    /**
+     * \brief Constructs an empty wavelet matrix
+     *
+     */
+    WaveletMatrix() : size_(0), width_(0) {
+    }
+
+    WaveletMatrix(WaveletMatrix&&) = default;
+    WaveletMatrix& operator=(WaveletMatrix&&) = default;
+
+    WaveletMatrix(WaveletMatrix const&) = delete;
+    WaveletMatrix& operator=(WaveletMatrix const&) = delete;
+
+    /**
+     * \brief Constructs the wavelet matrix for the given sequence
+     *
+     * The levels are constructed one after another, each in two passes over the sequence:
+     * the first writes the level's bits pack by pack, the second stably partitions the sequence by these bits.
+     * Both passes can be distributed to multiple threads.
+     *
+     * \tparam Pack the word pack type of the sequence
+     * \param seq the sequence
+     * \param num_threads the number of threads to use for construction
+     */
+    template<WordPackEligible Pack>
+    WaveletMatrix(PackedIntVector<Pack> const& seq, size_t const num_threads = 1) : size_(seq.size()), width_(seq.width()) {
+        if(size_ > 0) construct(seq, num_threads);
+    }
+
+    /**
+     * \brief Retrieves the integer at the given position
+     *
+     * \param i the position
+     * \return the integer at the given position
+     */
+    uintmax_t access(size_t i) const {
+        uintmax_t c = 0;
+        for(size_t l = 0; l < width_; l++) {
+            bool const bit = levels_[l].get(i);
+            i = bit ? zeros_[l] + rank_[l].rank1(i) : rank_[l].rank0(i);
+            c = (c << 1) | bit;
+        }
+        return c;
+    }
+
+    /**
+     * \brief Retrieves the integer at the given position
+     *
+     * This function simply forwards to \ref access .
+     *
+     * \param i the position
+     * \return the integer at the given position
+     */
+    uintmax_t operator[](size_t const i) const { return access(i); }
+
+    /**
+     * \brief Counts the occurrences of an integer preceding the given position
+     *
+     * \param c the integer to count
+     * \param i the position, at most \ref size
+     * \return the number of occurrences of c in the range [0, i)
+     */
+    size_t rank(uintmax_t const c, size_t const i) const {
+        if(width_ == 0 || c > internal::low_mask(width_)) return 0;
+
+        size_t b = 0, e = i;
+        for(size_t l = 0; l < width_; l++) descend(l, (c >> (width_ - 1 - l)) & 1ULL, b, e);
+        return e - b;
+    }
+
+    /**
+     * \brief Finds the position of the k-th occurrence of an integer
+     *
+     * \param c the integer to find
+     * \param k the zero-based number of the occurrence to find
+     * \return the position of the k-th occurrence of c, or \ref size if there are not enough occurrences
+     */
+    size_t select(uintmax_t const c, size_t const k) const {
+        if(width_ == 0 || c > internal::low_mask(width_)) return size_;
+
+        size_t b = 0, e = size_;
+        for(size_t l = 0; l < width_; l++) descend(l, (c >> (width_ - 1 - l)) & 1ULL, b, e);
+        if(k >= e - b) return size_;
+
+        size_t pos = b + k;
+        for(size_t l = width_; l > 0; l--) {
+            bool const bit = (c >> (width_ - l)) & 1ULL;
+            pos = bit ? rank_[l-1].select1(pos - zeros_[l-1]) : rank_[l-1].select0(pos);
+        }
+        return pos;
+    }
+
+    /**
+     * \brief Finds the k-th smallest integer in the given range
+     *
+     * \param b the beginning of the range
+     * \param e the end of the range (exclusive)
+     * \param k the zero-based rank of the integer to find, must be less than the range's length
+     * \return the k-th smallest integer in the range [b, e)
+     */
+    uintmax_t quantile(size_t b, size_t e, size_t k) const {
+        assert(k < e - b);
+
+        uintmax_t c = 0;
+        for(size_t l = 0; l < width_; l++) {
+            size_t const z = rank_[l].rank0(e) - rank_[l].rank0(b);
+            bool const bit = (k >= z);
+            if(bit) k -= z;
+            descend(l, bit, b, e);
+            c = (c << 1) | bit;
+        }
+        return c;
+    }
+
+    /**
+     * \brief Finds the most frequent integers in the given range
+     *
+     * The result is ordered by decreasing frequency.
+     *
+     * \param b the beginning of the range
+     * \param e the end of the range (exclusive)
+     * \param k the maximum number of integers to report
+     * \return pairs of integers and their frequency in the range [b, e)
+     */
+    std::vector<std::pair<uintmax_t, size_t>> top_k(size_t const b, size_t const e, size_t const k) const {
+        struct Node {
+            size_t b, e, level;
+            uintmax_t prefix;
+
+            bool operator<(Node const& other) const { return (e - b) < (other.e - other.b); }
+        };
+
+        std::vector<std::pair<uintmax_t, size_t>> result;
+        std::priority_queue<Node> queue;
+        if(b < e) queue.push(Node { b, e, 0, 0 });
+
+        while(!queue.empty() && result.size() < k) {
+            Node const node = queue.top();
+            queue.pop();
+
+            if(node.level == width_) {
+                result.emplace_back(node.prefix, node.e - node.b);
+            } else {
+                for(bool const bit : { false, true }) {
+                    Node child { node.b, node.e, node.level + 1, (node.prefix << 1) | bit };
+                    descend(node.level, bit, child.b, child.e);
+                    if(child.b < child.e) queue.push(child);
+                }
+            }
+        }
+        return result;
+    }
+
+    /**
+     * \brief Reports the bit width of the contained integers
+     *
+     * \return the bit width of the contained integers
+     */
+    size_t width() const { return width_; }
+
+    /**
+     * \brief Reports the number of contained integers
+     *
+     * \return the number of contained integers
+     */
+    size_t size() const { return size_; }
+
+    /**
+     * \brief Reports the number of heap bytes used by the wavelet matrix
+     *
+     * \return the number of heap bytes used
+     */
+    size_t memory_usage() const { return internal::memory_usage(levels_) + internal::memory_usage(rank_) + internal::memory_usage(zeros_); }
+};
+
+}
+
+#endif
@@ -28,6 +28,9 @@
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 #include "doctest.h"
 
+#include <utility>
+#include <vector>
+
 #include <word_packing.hpp>
 
 namespace word_packing::test::packed_int_access {
@@ -45,4 +45,105 @@ TEST_SUITE("packed_int_access") {
 
         for(size_t w = 1; w <= MAX_WIDTH; w++) iota_test(w);
     }
+
+    TEST_CASE("add") {
+        auto add_test = [](size_t width){
+            size_t const num = 999;
+            auto const mask = word_packing::internal::low_mask(width);
+
+            Pack packs[num_packs_required<Pack>(num, width)];
+            for(size_t i = 0; i < num; i++) {
+                word_packing::internal::set(packs, i, i, width, mask);
+            }
+
+            // add to every other integer, so that neighbours must remain unchanged
+            for(size_t i = 0; i < num; i += 2) {
+                auto const carry = word_packing::internal::add<overflow::Wrap>(packs, i, 3 * i, width, mask);
+                CHECK(carry == 0);
+            }
+            for(size_t i = 1; i < num; i += 2) {
+                uintmax_t const x = i & mask;
+                auto const carry = word_packing::internal::add<overflow::Saturate>(packs, i, 3 * i, width, mask);
+                CHECK(carry == (x + 3 * i > mask ? x + 3 * i - mask : 0));
+            }
+
+            for(size_t i = 0; i < num; i++) {
+                uintmax_t const x = i & mask;
+                auto const expect = (i % 2 == 0) ? ((x + 3 * i) & mask) : std::min(x + 3 * i, mask);
+                CHECK(word_packing::internal::get(packs, i, width, mask) == expect);
+            }
+        };
+
+        for(size_t w = 1; w <= MAX_WIDTH; w++) add_test(w);
+    }
+
+    template<size_t width>
+    void add_fixed_width_test() {
+        size_t const num = 999;
+        constexpr auto mask = word_packing::internal::low_mask(width);
+
+        Pack packs[num_packs_required<Pack>(num, width)];
+        for(size_t i = 0; i < num; i++) {
+            word_packing::internal::set<width>(packs, i, i & mask); // nb: writing bits clamps to 0 or 1 rather than masking
+        }
+
+        for(size_t i = 0; i < num; i++) {
+            if(i % 2 == 0) {
+                word_packing::internal::add<width, overflow::Wrap>(packs, i, 5 * i);
+            } else {
+                word_packing::internal::add<width, overflow::Saturate>(packs, i, 5 * i);
+            }
+        }
+
+        for(size_t i = 0; i < num; i++) {
+            uintmax_t const x = i & mask;
+            auto const expect = (i % 2 == 0) ? ((x + 5 * i) & mask) : std::min(x + 5 * i, mask);
+            CHECK(word_packing::internal::get<width>(packs, i) == expect);
+        }
+    }
+
+    template<size_t... widths>
+    void add_fixed_width_tests(std::index_sequence<widths...>) {
+        (add_fixed_width_test<widths + 1>(), ...);
+    }
+
+    TEST_CASE("add fixed width") {
+        add_fixed_width_tests(std::make_index_sequence<MAX_WIDTH>());
+    }
+
+    TEST_CASE("bit ranges") {
+        size_t const num_bits = 1'000;
+        Pack packs[num_packs_required<Pack>(num_bits, 1)];
+        std::vector<bool> bits(num_bits);
+
+        // fill with a pseudo-random bit pattern
+        uint64_t state = 1;
+        for(size_t i = 0; i < num_bits; i++) {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            bits[i] = (state >> 63);
+            word_packing::internal::set<1>(packs, i, bits[i]);
+        }
+
+        auto read_test = [&](){
+            for(size_t nbits = 1; nbits <= MAX_WIDTH; nbits++) {
+                for(size_t off = 0; off + nbits <= num_bits; off += 7) {
+                    uintmax_t expect = 0;
+                    for(size_t j = 0; j < nbits; j++) expect |= uintmax_t(bits[off + j]) << j;
+                    CHECK(word_packing::internal::get_bits(packs, off, nbits) == expect);
+                }
+            }
+        };
+        read_test();
+
+        // write ranges of varying length, so that neighbouring bits must remain unchanged
+        auto acc = word_packing::accessor(packs, 1);
+        for(size_t off = 0, nbits = 1; off + nbits <= num_bits; off += nbits + 3, nbits = nbits % MAX_WIDTH + 1) {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            uintmax_t const x = state & word_packing::internal::low_mask(nbits);
+            acc.set_bits(off, nbits, x);
+            for(size_t j = 0; j < nbits; j++) bits[off + j] = (x >> j) & 1;
+            CHECK(acc.get_bits(off, nbits) == x);
+        }
+        read_test();
+    }
 }
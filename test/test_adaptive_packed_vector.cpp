@@ -0,0 +1,193 @@
+/**
+ * test_adaptive_packed_vector.cpp
+ * part of pdinklag/word-packing
+ * 
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include <vector>
+
+#include <word_packing.hpp>
+#include <word_packing/adaptive_packed_vector.hpp>
+
+namespace word_packing::test::adaptive_packed_vector {
+
+using Vector = AdaptivePackedVector<uint64_t, 1024>;
+
+// five chunks, each suited for a different encoding, and a partial chunk
+std::vector<uint64_t> make_data() {
+    std::vector<uint64_t> v;
+    for(size_t j = 0; j < 1024; j++) v.push_back(42);                                      // constant (RLE)
+    for(size_t j = 0; j < 1024; j++) v.push_back(1'000'000 + internal::hash64(j) % 4096);  // FOR
+    for(size_t j = 0; j < 1024; j++) v.push_back((internal::hash64(j) % 3) << 40);         // dictionary
+    for(size_t j = 0; j < 1024; j++) v.push_back(j / 256);                                 // RLE
+    for(size_t j = 0; j < 1024; j++) v.push_back(internal::hash64(j) % (1ULL << 20));      // plain
+    for(size_t j = 0; j < 100; j++) v.push_back(j);
+    return v;
+}
+
+void check_content(Vector const& av, std::vector<uint64_t> const& v) {
+    REQUIRE(av.size() == v.size());
+    for(size_t i = 0; i < v.size(); i++) CHECK(av[i] == v[i]);
+}
+
+TEST_SUITE("adaptive_packed_vector") {
+    TEST_CASE("encodings") {
+        auto const v = make_data();
+        Vector const av(v);
+        CHECK(av.num_chunks() == 6);
+        CHECK(av.chunk_encoding(0) == Encoding::RLE);
+        CHECK(av.chunk_encoding(1) == Encoding::FOR);
+        CHECK(av.chunk_encoding(2) == Encoding::DICTIONARY);
+        CHECK(av.chunk_encoding(3) == Encoding::RLE);
+        CHECK(av.chunk_encoding(4) == Encoding::PLAIN);
+        CHECK(av.chunk_size(5) == 100);
+        check_content(av, v);
+
+        // plain packing would take 42 bits per integer
+        CHECK(av.memory_usage() < PackedIntVector(v.size(), 42).memory_usage() / 2);
+    }
+
+    TEST_CASE("decode_chunk") {
+        auto const v = make_data();
+        Vector const av(v);
+        std::vector<uintmax_t> buf(Vector::CHUNK_SIZE);
+        for(size_t c = 0; c < av.num_chunks(); c++) {
+            size_t const n = av.decode_chunk(c, buf.data());
+            CHECK(n == av.chunk_size(c));
+            for(size_t j = 0; j < n; j++) CHECK(buf[j] == v[c * Vector::CHUNK_SIZE + j]);
+        }
+    }
+
+    TEST_CASE("parallel") {
+        auto const v = make_data();
+        Vector const av(v, 4);
+        CHECK(av.chunk_encoding(3) == Encoding::RLE);
+        check_content(av, v);
+    }
+
+    TEST_CASE("updates") {
+        auto v = make_data();
+        Vector av(v);
+
+        // in place
+        av[1024 + 5] = v[1024 + 6];
+        v[1024 + 5] = v[1024 + 6];
+        av[2048 + 7] = 2ULL << 40;
+        v[2048 + 7] = 2ULL << 40;
+        av[3072 + 300] = 1;
+        v[3072 + 300] = 1;
+        for(size_t c = 0; c < av.num_chunks(); c++) CHECK(!av.chunk_dirty(c));
+        check_content(av, v);
+
+        // not representable in place
+        av[10] = 43;
+        v[10] = 43;
+        av[1024] = 7;
+        v[1024] = 7;
+        av[3072] = 9;
+        v[3072] = 9;
+        CHECK(av.chunk_dirty(0));
+        CHECK(av.chunk_dirty(1));
+        CHECK(!av.chunk_dirty(2));
+        CHECK(av.chunk_dirty(3));
+        CHECK(av.chunk_encoding(0) == Encoding::PLAIN);
+        check_content(av, v);
+
+        // re-encode lazily
+        av.optimize(2);
+        for(size_t c = 0; c < av.num_chunks(); c++) CHECK(!av.chunk_dirty(c));
+        CHECK(av.chunk_encoding(0) == Encoding::RLE);
+        CHECK(av.chunk_encoding(3) == Encoding::RLE);
+        check_content(av, v);
+    }
+
+    TEST_CASE("constant_block") {
+        // the first block of the FOR chunk is constant, its integers take no bits
+        auto v = make_data();
+        for(size_t j = 0; j < DataAnalysis::BLOCK_SIZE; j++) v[1024 + j] = 1'000'000;
+        Vector av(v);
+        REQUIRE(av.chunk_encoding(1) == Encoding::FOR);
+
+        av[1024 + 3] = 1'000'000;
+        v[1024 + 3] = 1'000'000;
+        CHECK(!av.chunk_dirty(1));
+        av[1024 + 3] = 1'000'007;
+        v[1024 + 3] = 1'000'007;
+        CHECK(av.chunk_dirty(1));
+        check_content(av, v);
+    }
+
+    TEST_CASE("narrow_packs") {
+        // the run end positions and payload offsets of chunks with the default size do not fit into the word packs
+        auto test = [](auto av_type, uintmax_t const max, uintmax_t const range, Encoding const e1){
+            using NarrowVector = decltype(av_type);
+            size_t const n = 3 * NarrowVector::CHUNK_SIZE + 1'000;
+            std::vector<uintmax_t> v(n);
+            for(size_t i = 0; i < n; i++) {
+                size_t const c = i / NarrowVector::CHUNK_SIZE;
+                if(c == 0) v[i] = (i < n / 8) ? 1 : max;                                  // RLE
+                else if(c == 1) v[i] = max - internal::hash64(i) % range;                 // FOR or dictionary
+                else v[i] = (internal::hash64(i) % 4) * (max / 4);                        // dictionary
+            }
+            NarrowVector const av(v);
+            CHECK(av.chunk_encoding(0) == Encoding::RLE);
+            CHECK(av.chunk_encoding(1) == e1);
+            CHECK(av.chunk_encoding(2) == Encoding::DICTIONARY);
+            REQUIRE(av.size() == n);
+            for(size_t i = 0; i < n; i++) CHECK(av[i] == v[i]);
+
+            std::vector<uintmax_t> buf(NarrowVector::CHUNK_SIZE);
+            for(size_t c = 0; c < av.num_chunks(); c++) {
+                size_t const m = av.decode_chunk(c, buf.data());
+                for(size_t j = 0; j < m; j++) CHECK(buf[j] == v[c * NarrowVector::CHUNK_SIZE + j]);
+            }
+        };
+        test(AdaptivePackedVector<uint8_t>(), 255, 16, Encoding::DICTIONARY);
+        test(AdaptivePackedVector<uint16_t>(), 65'535, 4'096, Encoding::FOR);
+    }
+
+    TEST_CASE("push_back") {
+        auto const v = make_data();
+        Vector av;
+        CHECK(av.empty());
+        for(auto const x : v) av.push_back(x);
+        CHECK(av.num_chunks() == 6);
+        for(size_t c = 0; c < av.num_chunks(); c++) CHECK(av.chunk_dirty(c));
+        check_content(av, v);
+
+        av.optimize();
+        CHECK(av.chunk_encoding(0) == Encoding::RLE);
+        CHECK(av.chunk_encoding(3) == Encoding::RLE);
+        check_content(av, v);
+
+        av.push_back(1ULL << 50);
+        CHECK(av.chunk_dirty(5));
+        CHECK(av[v.size()] == (1ULL << 50));
+    }
+}
+
+}
@@ -0,0 +1,165 @@
+/**
+ * test_bit_expressions.cpp
+ * part of pdinklag/word-packing
+ * 
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include <random>
+#include <vector>
+
+#include <word_packing.hpp>
+#include <word_packing/bit_expressions.hpp>
+
+namespace word_packing::test::bit_expressions {
+
+template<typename Pack, typename BitOrder>
+using Bits = PackedFixedWidthIntVector<1, Pack, BitOrder>;
+
+template<typename Pack, typename BitOrder>
+Bits<Pack, BitOrder> random_bits(size_t const n, std::mt19937_64& gen) {
+    Bits<Pack, BitOrder> bv(n);
+    for(size_t i = 0; i < n; i++) bv[i] = (gen() % 3 == 0);
+    return bv;
+}
+
+template<typename Pack, typename BitOrder>
+void test_expressions(size_t const n) {
+    std::mt19937_64 gen(99);
+    auto const a = random_bits<Pack, BitOrder>(n, gen);
+    auto const b = random_bits<Pack, BitOrder>(n, gen);
+    auto const c = random_bits<Pack, BitOrder>(n, gen);
+    auto const d = random_bits<Pack, BitOrder>(n, gen);
+
+    auto naive = [&](size_t i){ return ((a[i] && b[i]) || !c[i]) != bool(d[i]); };
+    auto const expr = ((a & b) | ~c) ^ d;
+
+    auto const result = evaluate(expr);
+    static_assert(std::is_same_v<std::remove_cv_t<decltype(result)>, Bits<Pack, BitOrder>>);
+    REQUIRE(result.size() == n);
+    size_t expected = 0;
+    for(size_t i = 0; i < n; i++) {
+        CHECK(result[i] == naive(i));
+        expected += naive(i);
+    }
+    CHECK(count_ones(expr) == expected);
+    CHECK(count_ones(result) == expected);
+
+    std::vector<size_t> positions;
+    for_each_set(expr, [&](size_t i){ positions.push_back(i); });
+    REQUIRE(positions.size() == expected);
+    for(size_t k = 0; k + 1 < positions.size(); k++) CHECK(positions[k] < positions[k + 1]);
+    for(size_t i : positions) CHECK(naive(i));
+
+    // the bits beyond the end are not set by negation
+    CHECK(count_ones(~Bits<Pack, BitOrder>(evaluate(a ^ a))) == n);
+}
+
+template<typename BitOrder>
+void test_expressions() {
+    for(size_t n : { 0, 1, 63, 64, 65, 1'000, 2'048, 2'049, 5'000 }) {
+        test_expressions<uint8_t, BitOrder>(n);
+        test_expressions<uint16_t, BitOrder>(n);
+        test_expressions<uint32_t, BitOrder>(n);
+        test_expressions<uint64_t, BitOrder>(n);
+    }
+}
+
+TEST_SUITE("bit_expressions") {
+    TEST_CASE("lsb_first") { test_expressions<bit_order::LsbFirst>(); }
+    TEST_CASE("msb_first") { test_expressions<bit_order::MsbFirst>(); }
+
+    TEST_CASE("in_place") {
+        std::mt19937_64 gen(99);
+        auto a = random_bits<uint64_t, bit_order::LsbFirst>(1'000, gen);
+        auto const b = random_bits<uint64_t, bit_order::LsbFirst>(1'000, gen);
+        auto const before = a;
+        evaluate(a & ~b, a);
+        for(size_t i = 0; i < a.size(); i++) CHECK(a[i] == (before[i] && !b[i]));
+    }
+
+    TEST_CASE("many") {
+        std::mt19937_64 gen(99);
+        std::vector<BitVector> v;
+        for(size_t k = 0; k < 8; k++) v.push_back(random_bits<uint64_t, bit_order::LsbFirst>(10'000, gen));
+
+        auto const expr = (v[0] | v[1] | v[2]) & ~(v[3] & v[4]) & (v[5] ^ v[6]) & ~v[7];
+        size_t expected = 0;
+        for(size_t i = 0; i < 10'000; i++) {
+            expected += (v[0][i] || v[1][i] || v[2][i]) && !(v[3][i] && v[4][i]) && (uintmax_t(v[5][i]) != uintmax_t(v[6][i])) && !v[7][i];
+        }
+        CHECK(count_ones(expr) == expected);
+    }
+
+    TEST_CASE("kernels") {
+        // forces the AVX2 and portable kernels
+        auto& features = internal::cpu::features();
+        auto const detected = features;
+
+        // sparse bits, so that blocks without set bits are skipped
+        BitVector a(100'000), b(100'000);
+        std::vector<size_t> expected;
+        for(size_t i = 0; i < a.size(); i++) {
+            a[i] = (i % 9'001 == 0) || (i >= 50'000 && i < 50'100);
+            b[i] = (i % 2 == 0);
+            if(a[i] && b[i]) expected.push_back(i);
+        }
+
+        auto check = [&](){
+            test_expressions<bit_order::LsbFirst>();
+            test_expressions<bit_order::MsbFirst>();
+
+            CHECK(count_ones(a & b) == expected.size());
+            std::vector<size_t> positions;
+            for_each_set(a & b, [&](size_t i){ positions.push_back(i); });
+            CHECK(positions == expected);
+
+            auto const c = evaluate(a & b);
+            CHECK(count_ones(c) == expected.size());
+        };
+
+        check();
+        features.avx512bw = false;
+        check();
+        features.avx2 = false;
+        check();
+        features = detected;
+    }
+
+    TEST_CASE("buffers") {
+        uint64_t const x[2] = { 0xF0F0, 0x1 };
+        uint64_t const y[2] = { 0xFF00, 0x3 };
+        BitOperand<uint64_t> const bx(x, 70), by(y, 70);
+        CHECK(count_ones(bx & by) == 5);
+        CHECK(count_ones(~bx) == 70 - 9);
+
+        std::vector<size_t> positions;
+        for_each_set(bx & by, [&](size_t i){ positions.push_back(i); });
+        CHECK(positions == std::vector<size_t>{ 12, 13, 14, 15, 64 });
+    }
+}
+
+}
@@ -0,0 +1,339 @@
+/**
+ * test_bit_order.cpp
+ * part of pdinklag/word-packing
+ * 
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include <cstring>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <word_packing.hpp>
+
+namespace word_packing::test::bit_order {
+
+using word_packing::bit_order::LsbFirst;
+using word_packing::bit_order::MsbFirst;
+using word_packing::bit_order::Padded;
+
+// tests whether the given integers form a big-endian bit stream in the buffer
+template<WordPackEligible Pack>
+void check_stream(Pack const* packs, std::vector<uintmax_t> const& values, size_t const width) {
+    uint8_t const* bytes = reinterpret_cast<uint8_t const*>(packs);
+    for(size_t i = 0; i < values.size(); i++) {
+        uintmax_t x = 0;
+        for(size_t j = 0; j < width; j++) {
+            size_t const k = i * width + j;
+            x = (x << 1) | ((bytes[k / 8] >> (7 - k % 8)) & 1);
+        }
+        CHECK(x == values[i]);
+    }
+}
+
+// tests whether the given integers are stored without straddling word packs, and whether the padding is zero
+template<WordPackEligible Pack>
+void check_padded(Pack const* packs, std::vector<uintmax_t> const& values, size_t const width) {
+    size_t const num_per_pack = std::numeric_limits<Pack>::digits / width;
+    for(size_t i = 0; i < values.size(); i++) {
+        CHECK(((uintmax_t(packs[i / num_per_pack]) >> ((i % num_per_pack) * width)) & internal::low_mask(width)) == values[i]);
+    }
+    for(size_t p = 0; p < internal::idiv_ceil(values.size(), num_per_pack); p++) {
+        CHECK((uintmax_t(packs[p]) >> (num_per_pack * width - 1) >> 1) == 0);
+    }
+}
+
+template<WordPackEligible Pack>
+void test_padded_dynamic_width() {
+    constexpr size_t MAX_WIDTH = std::numeric_limits<Pack>::digits;
+    std::mt19937_64 gen(MAX_WIDTH);
+
+    for(size_t w = 1; w <= MAX_WIDTH; w++) {
+        size_t const num = 999;
+        auto const mask = internal::low_mask(w);
+
+        std::vector<uintmax_t> values(num);
+        for(auto& x : values) x = gen() & mask;
+
+        std::vector<Pack> packs(Padded::num_packs<Pack>(num, w), 0);
+        CHECK(packs.size() == internal::idiv_ceil(num, MAX_WIDTH / w));
+        auto acc = word_packing::accessor<Padded>(packs.data(), w);
+        for(size_t i = 0; i < num; i++) acc[i] = values[i];
+        check_padded(packs.data(), values, w);
+
+        auto const_acc = word_packing::accessor<Padded>((Pack const*)packs.data(), w);
+        for(size_t i = 0; i < num; i++) CHECK(const_acc[i] == values[i]);
+
+        for(size_t i = 0; i < num; i += 2) {
+            acc.template add<overflow::Saturate>(i, 3 * i);
+            values[i] = (3 * i <= mask - values[i]) ? values[i] + 3 * i : mask;
+        }
+        check_padded(packs.data(), values, w);
+    }
+}
+
+template<size_t width, WordPackEligible Pack>
+void test_padded_fixed_width() {
+    size_t const num = 999;
+    constexpr auto mask = internal::low_mask(width);
+    std::mt19937_64 gen(width);
+
+    std::vector<uintmax_t> values(num);
+    for(auto& x : values) x = gen() & mask;
+
+    std::vector<Pack> packs(Padded::num_packs<Pack>(num, width), 0);
+    auto acc = word_packing::accessor<width, Padded>(packs.data());
+    for(size_t i = 0; i < num; i++) acc[i] = values[i];
+    check_padded(packs.data(), values, width);
+    for(size_t i = 0; i < num; i++) CHECK(acc[i] == values[i]);
+
+    for(size_t i = 1; i < num; i += 2) {
+        acc.increment(i);
+        values[i] = (values[i] + 1) & mask;
+    }
+    check_padded(packs.data(), values, width);
+}
+
+template<WordPackEligible Pack, size_t... widths>
+void test_padded_fixed_widths(std::index_sequence<widths...>) {
+    (test_padded_fixed_width<widths + 1, Pack>(), ...);
+}
+
+template<WordPackEligible Pack>
+void test_dynamic_width() {
+    constexpr size_t MAX_WIDTH = std::numeric_limits<Pack>::digits;
+    std::mt19937_64 gen(MAX_WIDTH);
+
+    for(size_t w = 1; w <= MAX_WIDTH; w++) {
+        size_t const num = 999;
+        auto const mask = internal::low_mask(w);
+
+        std::vector<uintmax_t> values(num);
+        for(auto& x : values) x = gen() & mask;
+
+        std::vector<Pack> packs(num_packs_required<Pack>(num, w));
+        auto acc = word_packing::accessor<MsbFirst>(packs.data(), w);
+        for(size_t i = 0; i < num; i++) acc[i] = values[i];
+        check_stream(packs.data(), values, w);
+
+        auto const_acc = word_packing::accessor<MsbFirst>((Pack const*)packs.data(), w);
+        for(size_t i = 0; i < num; i++) CHECK(const_acc[i] == values[i]);
+
+        // add to every other integer, so that neighbours must remain unchanged
+        for(size_t i = 0; i < num; i += 2) {
+            acc.template add<overflow::Saturate>(i, 3 * i);
+            values[i] = (3 * i <= mask - values[i]) ? values[i] + 3 * i : mask;
+        }
+        check_stream(packs.data(), values, w);
+    }
+}
+
+template<size_t width, WordPackEligible Pack>
+void test_fixed_width() {
+    size_t const num = 999;
+    constexpr auto mask = internal::low_mask(width);
+    std::mt19937_64 gen(width);
+
+    std::vector<uintmax_t> values(num);
+    for(auto& x : values) x = gen() & mask;
+
+    std::vector<Pack> packs(num_packs_required<Pack>(num, width));
+    auto acc = word_packing::accessor<width, MsbFirst>(packs.data());
+    for(size_t i = 0; i < num; i++) acc[i] = values[i];
+    check_stream(packs.data(), values, width);
+    for(size_t i = 0; i < num; i++) CHECK(acc[i] == values[i]);
+
+    for(size_t i = 1; i < num; i += 2) {
+        acc.increment(i);
+        values[i] = (values[i] + 1) & mask;
+    }
+    check_stream(packs.data(), values, width);
+}
+
+template<WordPackEligible Pack, size_t... widths>
+void test_fixed_widths(std::index_sequence<widths...>) {
+    (test_fixed_width<widths + 1, Pack>(), ...);
+}
+
+TEST_SUITE("bit_order") {
+    TEST_CASE("dynamic width") {
+        test_dynamic_width<uint8_t>();
+        test_dynamic_width<uint16_t>();
+        test_dynamic_width<uint32_t>();
+        test_dynamic_width<uint64_t>();
+    }
+
+    TEST_CASE("fixed width") {
+        test_fixed_widths<uint8_t>(std::make_index_sequence<8>());
+        test_fixed_widths<uint64_t>(std::make_index_sequence<64>());
+    }
+
+    TEST_CASE("bit ranges") {
+        size_t const num_bits = 1'000;
+        std::vector<uint64_t> packs(num_packs_required<uint64_t>(num_bits, 1), 0);
+        auto acc = word_packing::accessor<MsbFirst>(packs.data(), 1);
+
+        std::mt19937_64 gen(1);
+        std::vector<uintmax_t> ranges;
+        for(size_t off = 0, nbits = 1; off + nbits <= num_bits; off += nbits, nbits = nbits % 64 + 1) {
+            uintmax_t const x = gen() & internal::low_mask(nbits);
+            acc.set_bits(off, nbits, x);
+            CHECK(acc.get_bits(off, nbits) == x);
+            ranges.push_back(x);
+        }
+
+        // the ranges must not have affected each other
+        size_t k = 0;
+        for(size_t off = 0, nbits = 1; off + nbits <= num_bits; off += nbits, nbits = nbits % 64 + 1) {
+            CHECK(acc.get_bits(off, nbits) == ranges[k++]);
+        }
+    }
+
+    TEST_CASE("vectors") {
+        size_t const num = 1'000;
+        for(size_t w = 1; w <= 64; w++) {
+            auto const mask = internal::low_mask(w);
+            PackedIntVector<uintmax_t, MsbFirst> v(0, w);
+            for(size_t i = 0; i < num; i++) v.push_back(i * 0x9E3779B97F4A7C15ULL);
+            for(size_t i = 0; i < num; i++) v.template add<overflow::Saturate>(i, i);
+
+            std::vector<uintmax_t> values(num);
+            for(size_t i = 0; i < num; i++) {
+                uintmax_t const x = (i * 0x9E3779B97F4A7C15ULL) & mask;
+                values[i] = (i <= mask - x) ? x + i : mask;
+            }
+            check_stream(v.data(), values, w);
+
+            v.resize(num, w < 64 ? w + 1 : w);
+            for(size_t i = 0; i < num; i++) CHECK(v[i] == values[i]);
+        }
+
+        PackedFixedWidthIntVector<3, uint16_t, MsbFirst> fv(10);
+        for(size_t i = 0; i < 10; i++) fv[i] = i;
+        std::vector<uintmax_t> values(10);
+        for(size_t i = 0; i < 10; i++) values[i] = i & 7;
+        check_stream(fv.data(), values, 3);
+    }
+
+    TEST_CASE("padded") {
+        test_padded_dynamic_width<uint8_t>();
+        test_padded_dynamic_width<uint16_t>();
+        test_padded_dynamic_width<uint32_t>();
+        test_padded_dynamic_width<uint64_t>();
+        test_padded_fixed_widths<uint8_t>(std::make_index_sequence<8>());
+        test_padded_fixed_widths<uint64_t>(std::make_index_sequence<64>());
+
+        // indices far beyond the allocated memory are located correctly
+        for(size_t w = 1; w <= 32; w++) {
+            size_t const num_per_pack = 64 / w;
+            for(size_t const i : { size_t(1) << 40, (size_t(1) << 58) - 1, size_t(0x2D5A4B3C2D1E0F) }) {
+                size_t shift;
+                CHECK(internal::padded::locate<uint64_t>(i, w, shift) == i / num_per_pack);
+                CHECK(shift == (i % num_per_pack) * w);
+            }
+        }
+    }
+
+    TEST_CASE("padded vectors") {
+        size_t const num = 1'000;
+        for(size_t w = 1; w <= 64; w++) {
+            PackedIntVector<uintmax_t, Padded> v(0, w);
+            std::vector<uintmax_t> values;
+            for(size_t i = 0; i < num; i++) {
+                v.push_back(i * 0x9E3779B97F4A7C15ULL);
+                values.push_back((i * 0x9E3779B97F4A7C15ULL) & internal::low_mask(w));
+            }
+            check_padded(v.data(), values, w);
+            CHECK(v.capacity_bytes() == internal::idiv_ceil(v.capacity(), 64 / w) * sizeof(uintmax_t));
+            CHECK(v.wasted_bits() == 8 * v.capacity_bytes() - num * w);
+
+            auto copy = v;
+            CHECK(copy == v);
+            CHECK(copy.hash() == v.hash());
+            copy[num - 1] = copy[num - 1] ^ 1;
+            CHECK(copy != v);
+            CHECK((copy < v) == (uintmax_t(copy[num - 1]) < uintmax_t(v[num - 1])));
+
+            v.resize(num, w < 64 ? w + 1 : w);
+            for(size_t i = 0; i < num; i++) CHECK(v[i] == values[i]);
+        }
+
+        PackedFixedWidthIntVector<21, uint64_t, Padded> fv(10);
+        for(size_t i = 0; i < 10; i++) fv[i] = i << 16;
+        CHECK(fv.capacity_bytes() == 4 * sizeof(uint64_t));
+        std::vector<uintmax_t> values(10);
+        for(size_t i = 0; i < 10; i++) values[i] = i << 16;
+        check_padded(fv.data(), values, 21);
+    }
+
+    TEST_CASE("unpack") {
+        auto test = [](auto& v, std::mt19937_64& gen){
+            for(size_t i = 0; i < v.size(); i++) v[i] = gen();
+            std::vector<uintmax_t> out(v.size());
+            for(size_t const i : { size_t(0), size_t(1), size_t(7), size_t(100) }) {
+                for(size_t const num : { size_t(0), size_t(1), size_t(63), v.size() - i }) {
+                    v.unpack(i, num, out.data());
+                    for(size_t k = 0; k < num; k++) CHECK(out[k] == uintmax_t(v[i + k]));
+                }
+            }
+        };
+
+        std::mt19937_64 gen(1);
+        for(size_t w = 1; w <= 64; w++) {
+            PackedIntVector<uint64_t, LsbFirst> lsb(500, w);
+            PackedIntVector<uint64_t, MsbFirst> msb(500, w);
+            PackedIntVector<uint64_t, Padded> padded(500, w);
+            test(lsb, gen);
+            test(msb, gen);
+            test(padded, gen);
+        }
+        for(size_t w = 1; w <= 8; w++) {
+            PackedIntVector<uint8_t, LsbFirst> lsb(500, w);
+            PackedIntVector<uint8_t, MsbFirst> msb(500, w);
+            PackedIntVector<uint8_t, Padded> padded(500, w);
+            test(lsb, gen);
+            test(msb, gen);
+            test(padded, gen);
+        }
+
+        PackedFixedWidthIntVector<13, uint32_t, MsbFirst> fv(500);
+        test(fv, gen);
+    }
+
+    TEST_CASE("direct mapping") {
+        // bit-packed integers as they appear in an Apache ORC file
+        uint8_t const bytes[] = { 0x5c, 0xa1, 0xab, 0x1e, 0xde, 0xad, 0xbe, 0xef };
+        uintmax_t const expected[] = { 23713, 43806, 57005, 48879 };
+
+        uint32_t packs[2];
+        std::memcpy(packs, bytes, sizeof(bytes));
+        auto acc = word_packing::accessor<16, MsbFirst>((uint32_t const*)packs);
+        for(size_t i = 0; i < 4; i++) CHECK(acc[i] == expected[i]);
+    }
+}
+
+}
@@ -0,0 +1,115 @@
+/**
+ * test_bit_ranges.cpp
+ * part of pdinklag/word-packing
+ * 
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include <random>
+#include <vector>
+
+#include <word_packing.hpp>
+
+namespace word_packing::test::bit_ranges {
+
+template<typename Pack, typename BitOrder>
+void test_ranges() {
+    size_t const n = 1'000;
+    std::mt19937_64 gen(98);
+
+    PackedFixedWidthIntVector<1, Pack, BitOrder> bv(n);
+    std::vector<bool> naive(n);
+    for(size_t i = 0; i < n; i++) {
+        bool const b = gen() & 1;
+        bv[i] = b;
+        naive[i] = b;
+    }
+
+    for(size_t k = 0; k < 500; k++) {
+        size_t l = gen() % (n + 1), r = gen() % (n + 1);
+        if(l > r) std::swap(l, r);
+        if(k % 5 == 0) r = std::min(n, l + gen() % 8); // short ranges within a single word pack
+
+        size_t expected = 0;
+        for(size_t i = l; i < r; i++) expected += naive[i];
+        CHECK(bv.count_range(l, r) == expected);
+
+        switch(k % 3) {
+            case 0:
+                bv.set_range(l, r);
+                for(size_t i = l; i < r; i++) naive[i] = true;
+                break;
+            case 1:
+                bv.reset_range(l, r);
+                for(size_t i = l; i < r; i++) naive[i] = false;
+                break;
+            case 2:
+                bv.flip_range(l, r);
+                for(size_t i = l; i < r; i++) naive[i] = !naive[i];
+                break;
+        }
+        for(size_t i = 0; i < n; i++) REQUIRE(bv[i] == naive[i]);
+    }
+}
+
+template<typename BitOrder>
+void test_ranges() {
+    test_ranges<uint8_t, BitOrder>();
+    test_ranges<uint16_t, BitOrder>();
+    test_ranges<uint32_t, BitOrder>();
+    test_ranges<uint64_t, BitOrder>();
+}
+
+TEST_SUITE("bit_ranges") {
+    TEST_CASE("lsb_first") { test_ranges<bit_order::LsbFirst>(); }
+    TEST_CASE("msb_first") { test_ranges<bit_order::MsbFirst>(); }
+    TEST_CASE("padded") { test_ranges<bit_order::Padded>(); }
+
+    TEST_CASE("full") {
+        BitVector bv(4'096);
+        bv.reset_range(0, bv.size());
+        CHECK(bv.count_range(0, bv.size()) == 0);
+        bv.set_range(0, bv.size());
+        CHECK(bv.count_range(0, bv.size()) == 4'096);
+        bv.flip_range(64, 128);
+        CHECK(bv.count_range(0, bv.size()) == 4'032);
+        CHECK(bv.count_range(64, 128) == 0);
+        CHECK(bv.count_range(10, 10) == 0);
+    }
+
+    TEST_CASE("stats") {
+        struct Tag;
+        using Stats = word_packing::stats::Counting<Tag>;
+        PackedFixedWidthIntVector<1, uint64_t, bit_order::LsbFirst, Stats> bv(1'000);
+        bv.set_range(10, 500);
+        CHECK(bv.count_range(0, 1'000) == 490);
+        auto const c = Stats::aggregate();
+        CHECK(c.bulk_calls == 2);
+        CHECK(c.bulk_elements == 1'490);
+    }
+}
+
+}
@@ -0,0 +1,116 @@
+/**
+ * test_blocked_bloom_filter.cpp
+ * part of pdinklag/word-packing
+ * 
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include <memory>
+#include <vector>
+
+#include <word_packing.hpp>
+#include <word_packing/blocked_bloom_filter.hpp>
+
+namespace word_packing::test::blocked_bloom_filter {
+
+TEST_SUITE("blocked_bloom_filter") {
+    TEST_CASE("insert and contains") {
+        size_t const num = 100'000;
+        BlockedBloomFilter filter(10 * num, 7);
+        CHECK(filter.num_bits() >= 10 * num);
+        CHECK(filter.num_hashes() == 7);
+
+        for(uint64_t i = 0; i < num; i++) filter.insert(i * 2);
+        for(uint64_t i = 0; i < num; i++) CHECK(filter.contains(i * 2));
+
+        size_t false_positives = 0;
+        for(uint64_t i = 0; i < num; i++) false_positives += filter.contains(i * 2 + 1);
+        CHECK(false_positives < num / 50); // nb: the expected rate is around 1%
+    }
+
+    TEST_CASE("contains_many") {
+        size_t const num = 10'000;
+        BlockedBloomFilter filter(16 * num);
+        std::unique_ptr<uint64_t[]> keys = std::make_unique<uint64_t[]>(num);
+        for(uint64_t i = 0; i < num; i++) {
+            keys[i] = i * 0x12345;
+            filter.insert(keys[i]);
+        }
+
+        std::unique_ptr<bool[]> out = std::make_unique<bool[]>(num);
+        filter.contains_many(keys.get(), num, out.get());
+        for(size_t i = 0; i < num; i++) CHECK(out[i]);
+    }
+
+    TEST_CASE("kernels") {
+        // the kernel variants that the CPU supports must set the same bits
+        size_t const num = 10'000;
+        auto const detected = internal::cpu::features();
+        std::vector<BlockedBloomFilter> filters;
+        for(size_t level = 0; level < 3; level++) {
+            internal::cpu::features().avx2 = (level >= 1) && detected.avx2;
+            internal::cpu::features().avx512bw = (level >= 2) && detected.avx512bw;
+            for(size_t const k : {1, 7, 16}) {
+                BlockedBloomFilter filter(8 * num, k);
+                for(uint64_t i = 0; i < num; i++) filter.insert(i * 3);
+                filters.push_back(std::move(filter));
+            }
+        }
+
+        // the kernel is selected when a filter is constructed
+        internal::cpu::features() = detected;
+        std::vector<uint64_t> keys(3 * num);
+        for(uint64_t x = 0; x < 3 * num; x++) keys[x] = x;
+        for(size_t i = 3; i < filters.size(); i++) {
+            for(uint64_t x = 0; x < 3 * num; x++) CHECK(filters[i].contains(x) == filters[i % 3].contains(x));
+
+            std::unique_ptr<bool[]> out = std::make_unique<bool[]>(keys.size());
+            filters[i].contains_many(keys.data(), keys.size(), out.get());
+            for(uint64_t x = 0; x < 3 * num; x++) CHECK(out[x] == filters[i % 3].contains(x));
+        }
+    }
+
+    TEST_CASE("merge, copy and clear") {
+        size_t const num = 10'000;
+        BlockedBloomFilter a(16 * num), b(16 * num);
+        for(uint64_t i = 0; i < num; i++) {
+            a.insert(i);
+            b.insert(num + i);
+        }
+
+        BlockedBloomFilter c = a;
+        c.merge(b);
+        for(uint64_t i = 0; i < 2 * num; i++) CHECK(c.contains(i));
+        for(uint64_t i = 0; i < num; i++) CHECK(a.contains(i));
+
+        c.clear();
+        size_t positives = 0;
+        for(uint64_t i = 0; i < 2 * num; i++) positives += c.contains(i);
+        CHECK(positives == 0);
+    }
+}
+
+}
@@ -0,0 +1,122 @@
+/**
+ * test_bool_conversion.cpp
+ * part of pdinklag/word-packing
+ * 
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include <random>
+#include <vector>
+
+#include <word_packing.hpp>
+#include <word_packing/bool_conversion.hpp>
+
+namespace word_packing::test::bool_conversion {
+
+constexpr size_t SIZES[] = { 0, 1, 63, 64, 65, 200, 1'000 };
+
+std::vector<uint8_t> random_bytes(size_t const n, uint64_t const seed) {
+    std::mt19937_64 gen(seed);
+    std::vector<uint8_t> bytes(n);
+    for(auto& b : bytes) b = (gen() % 2) ? uint8_t(gen()) | 1 : 0; // nb: arbitrary nonzero values must count as true
+    return bytes;
+}
+
+template<WordPackEligible Pack>
+void test_packs() {
+    constexpr size_t PACK_BITS = std::numeric_limits<Pack>::digits;
+
+    for(size_t const n : SIZES) {
+        auto const bytes = random_bytes(n, n);
+
+        std::vector<Pack> packs(num_packs_required<Pack>(n, 1), Pack(~Pack(0)));
+        pack_bools(bytes.data(), n, packs.data());
+        for(size_t i = 0; i < n; i++) CHECK(((packs[i / PACK_BITS] >> (i % PACK_BITS)) & 1) == (bytes[i] != 0));
+        if(n % PACK_BITS) CHECK((packs.back() >> (n % PACK_BITS)) == 0);
+
+        std::vector<uint8_t> unpacked(n, 0xFF);
+        unpack_bools(packs.data(), n, unpacked.data());
+        for(size_t i = 0; i < n; i++) CHECK(unpacked[i] == (bytes[i] != 0));
+    }
+}
+
+TEST_SUITE("bool_conversion") {
+    TEST_CASE("packs") {
+        test_packs<uint8_t>();
+        test_packs<uint16_t>();
+        test_packs<uint32_t>();
+        test_packs<uint64_t>();
+    }
+
+    TEST_CASE("kernels") {
+        // convert using each kernel variant that the CPU supports
+        auto const detected = internal::cpu::features();
+        for(size_t level = 0; level < 3; level++) {
+            internal::cpu::features().avx2 = (level >= 1) && detected.avx2;
+            internal::cpu::features().bmi2 = (level >= 1) && detected.bmi2;
+            internal::cpu::features().avx512bw = (level >= 2) && detected.avx512bw;
+            test_packs<uint8_t>();
+            test_packs<uint64_t>();
+        }
+        internal::cpu::features() = detected;
+    }
+
+    TEST_CASE("bool arrays") {
+        for(size_t const n : SIZES) {
+            auto const bytes = random_bytes(n, n + 1);
+            std::unique_ptr<bool[]> bools = std::make_unique<bool[]>(n);
+            for(size_t i = 0; i < n; i++) bools[i] = bytes[i];
+
+            auto const bv = to_bit_vector(bools.get(), n);
+            REQUIRE(bv.size() == n);
+            for(size_t i = 0; i < n; i++) CHECK(bv[i] == bools[i]);
+
+            auto const bv2 = to_bit_vector(bytes.data(), n);
+            for(size_t i = 0; i < n; i++) CHECK(bv2[i] == bools[i]);
+
+            std::unique_ptr<bool[]> unpacked = std::make_unique<bool[]>(n);
+            unpack_bools(bv.data(), n, unpacked.get());
+            for(size_t i = 0; i < n; i++) CHECK(unpacked[i] == bools[i]);
+        }
+    }
+
+    TEST_CASE("vector of bools") {
+        for(size_t const n : SIZES) {
+            auto const bytes = random_bytes(n, n + 2);
+            std::vector<bool> v(n);
+            for(size_t i = 0; i < n; i++) v[i] = bytes[i];
+
+            auto const bv = to_bit_vector(v);
+            REQUIRE(bv.size() == n);
+            for(size_t i = 0; i < n; i++) CHECK(bv[i] == v[i]);
+
+            auto const v2 = to_vector_bool(bv);
+            CHECK(v2 == v);
+        }
+    }
+}
+
+}
@@ -0,0 +1,109 @@
+/**
+ * test_compact_hash_set.cpp
+ * part of pdinklag/word-packing
+ * 
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include <random>
+#include <unordered_set>
+#include <vector>
+
+#include <word_packing.hpp>
+#include <word_packing/compact_hash_set.hpp>
+
+namespace word_packing::test::compact_hash_set {
+
+TEST_SUITE("compact_hash_set") {
+    TEST_CASE("insert and contains") {
+        auto test = [](size_t const key_width, size_t const num){
+            std::mt19937_64 gen(key_width);
+            std::uniform_int_distribution<uintmax_t> dist(0, internal::low_mask(key_width));
+
+            CompactHashSet<> set(key_width, 16);
+            std::unordered_set<uintmax_t> expect;
+            for(size_t i = 0; i < num; i++) {
+                uintmax_t const key = dist(gen);
+                CHECK(set.insert(key) == expect.insert(key).second);
+            }
+
+            CHECK(set.size() == expect.size());
+            if(size_t(std::bit_width(set.capacity() - 1)) < key_width) CHECK(set.capacity() * 9 >= set.size() * 10);
+            CHECK(set.slot_width() == 3 + key_width - std::bit_width(set.capacity() - 1));
+            for(auto const key : expect) CHECK(set.contains(key));
+
+            size_t false_positives = 0;
+            for(size_t i = 0; i < num; i++) {
+                uintmax_t const key = dist(gen);
+                false_positives += (set.contains(key) && !expect.contains(key));
+            }
+            CHECK(false_positives == 0);
+
+            std::unordered_set<uintmax_t> reported;
+            set.for_each([&](uintmax_t const key){ CHECK(reported.insert(key).second); });
+            CHECK(reported == expect);
+        };
+
+        test(40, 100'000);
+        test(20, 50'000);
+        test(64, 10'000);
+        test(8, 1'000); // saturates the universe
+    }
+
+    TEST_CASE("wide keys") {
+        for(size_t key_width = 61; key_width <= 64; key_width++) {
+            for(size_t const capacity : {1, 2, 4, 16}) {
+                CompactHashSet<> set(key_width, capacity);
+                CHECK(set.slot_width() <= 64);
+
+                std::mt19937_64 gen(key_width * capacity);
+                std::uniform_int_distribution<uintmax_t> dist(0, internal::low_mask(key_width));
+                std::vector<uintmax_t> keys;
+                for(size_t i = 0; i < 1'000; i++) {
+                    keys.push_back(dist(gen));
+                    CHECK(set.insert(keys.back()));
+                }
+                CHECK(set.slot_width() <= 64);
+                for(auto const key : keys) CHECK(set.contains(key));
+            }
+        }
+    }
+
+    TEST_CASE("contains_many") {
+        CompactHashSet<> set(40);
+        std::vector<uintmax_t> keys;
+        for(uintmax_t i = 0; i < 10'000; i++) {
+            keys.push_back(i * 3);
+            if(i % 2 == 0) set.insert(i * 3);
+        }
+
+        std::unique_ptr<bool[]> out = std::make_unique<bool[]>(keys.size());
+        set.contains_many(keys.data(), keys.size(), out.get());
+        for(size_t i = 0; i < keys.size(); i++) CHECK(out[i] == (i % 2 == 0));
+    }
+}
+
+}
@@ -0,0 +1,156 @@
+/**
+ * test_encoding_advisor.cpp
+ * part of pdinklag/word-packing
+ * 
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include <sstream>
+#include <vector>
+
+#include <word_packing.hpp>
+#include <word_packing/encoding_advisor.hpp>
+
+namespace word_packing::test::encoding_advisor {
+
+void check_equal(DataAnalysis const& a, DataAnalysis const& b) {
+    CHECK(a.size == b.size);
+    CHECK(a.min == b.min);
+    CHECK(a.max == b.max);
+    CHECK(a.max_width == b.max_width);
+    CHECK(a.distinct == b.distinct);
+    CHECK(a.runs == b.runs);
+    CHECK(a.non_decreasing_pairs == b.non_decreasing_pairs);
+    CHECK(a.max_delta_width == b.max_delta_width);
+    CHECK(a.for_block_bits == b.for_block_bits);
+    CHECK(a.delta_block_bits == b.delta_block_bits);
+    CHECK(a.width_histogram == b.width_histogram);
+    CHECK(a.delta_histogram == b.delta_histogram);
+}
+
+TEST_SUITE("encoding_advisor") {
+    TEST_CASE("constant") {
+        std::vector<uint64_t> v(10'000, 5);
+        auto const a = analyze(v);
+        CHECK(a.size == 10'000);
+        CHECK(a.max_width == 3);
+        CHECK(a.distinct == 1);
+        CHECK(a.runs == 1);
+        CHECK(a.sorted());
+        CHECK(a.max_delta_width == 0);
+        CHECK(a.estimate(Encoding::PLAIN).bits_per_element == 3.0);
+        CHECK(a.estimate(Encoding::RLE).bits_per_element < 0.01);
+        CHECK(a.best().encoding == Encoding::DICTIONARY); // a single entry, the indices take no bits
+    }
+
+    TEST_CASE("sorted") {
+        size_t const n = 100'000;
+        std::vector<uint64_t> v(n);
+        for(size_t i = 0; i < n; i++) v[i] = 3 * i;
+
+        auto const a = analyze(v);
+        CHECK(a.sorted());
+        CHECK(a.sortedness() == 1.0);
+        CHECK(a.runs == n);
+        CHECK(a.max_delta_width == 3);
+        CHECK(a.distinct > 95'000);
+        CHECK(a.distinct <= n);
+
+        auto const ef = a.estimate(Encoding::ELIAS_FANO);
+        CHECK(ef.applicable);
+        CHECK(ef.bits_per_element == 3.0);
+        CHECK(a.estimate(Encoding::DELTA).bits_per_element < 4.0);
+        CHECK(a.estimate(Encoding::FOR).bits_per_element > 9.0);
+        CHECK(a.best().encoding == Encoding::ELIAS_FANO);
+        CHECK(a.best(1.5).encoding == Encoding::DELTA);
+        CHECK(a.best(1.0).encoding == Encoding::PLAIN);
+        CHECK(a.best_of({ Encoding::FOR, Encoding::DELTA }).encoding == Encoding::DELTA);
+        CHECK(a.best_of({}).encoding == Encoding::PLAIN);
+
+        // reversed, Elias-Fano is not applicable
+        std::reverse(v.begin(), v.end());
+        auto const r = analyze(v);
+        CHECK(!r.sorted());
+        CHECK(r.sortedness() == 0.0);
+        CHECK(!r.estimate(Encoding::ELIAS_FANO).applicable);
+        CHECK(r.best().encoding == Encoding::DELTA);
+        CHECK(r.best_of({ Encoding::ELIAS_FANO }).encoding == Encoding::PLAIN);
+    }
+
+    TEST_CASE("dictionary") {
+        size_t const n = 100'000;
+        std::vector<uint64_t> v(n);
+        for(size_t i = 0; i < n; i++) v[i] = (internal::hash64(i) % 7) * 1'000'003;
+
+        auto const a = analyze(v);
+        CHECK(a.distinct == 7);
+        CHECK(a.max_width == 23);
+        CHECK(a.best().encoding == Encoding::DICTIONARY);
+    }
+
+    TEST_CASE("pfor") {
+        size_t const n = 100'000;
+        std::vector<uint64_t> v(n);
+        for(size_t i = 0; i < n; i++) v[i] = (i % 100 == 0) ? (1ULL << 40) + i : internal::hash64(i) % 16;
+
+        auto const a = analyze(v);
+        CHECK(a.max_width == 41);
+        CHECK(a.pfor_width() == 4);
+        CHECK(a.estimate(Encoding::PFOR).bits_per_element < 5.0);
+        CHECK(a.best().encoding == Encoding::PFOR);
+    }
+
+    TEST_CASE("parallel") {
+        size_t const n = 100'000;
+        PackedIntVector v(n, 17);
+        for(size_t i = 0; i < n; i++) v[i] = (i / 10) % 1'000 + (internal::hash64(i) % 3);
+
+        auto const a = analyze(v);
+        for(size_t num_threads : { 2, 3, 4, 8 }) {
+            check_equal(a, analyze(v, num_threads));
+        }
+    }
+
+    TEST_CASE("empty") {
+        std::vector<uint64_t> v;
+        auto const a = analyze(v, 4);
+        CHECK(a.size == 0);
+        CHECK(a.distinct == 0);
+        CHECK(a.runs == 0);
+        CHECK(a.sorted());
+        CHECK(a.best().encoding == Encoding::PLAIN);
+    }
+
+    TEST_CASE("print") {
+        std::vector<uint64_t> v(1'000, 5);
+        std::ostringstream out;
+        analyze(v).print(out, "column");
+        CHECK(out.str().starts_with("ANALYSIS name=column size=1000 max_width=3 distinct=1 runs=1 "));
+        CHECK(out.str().ends_with(" best=dictionary\n"));
+    }
+}
+
+}
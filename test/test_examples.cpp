@@ -28,7 +28,18 @@
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 #include "doctest.h"
 
+#include <sstream>
+#include <unordered_set>
+
 #include <word_packing.hpp>
+#include <word_packing/adaptive_packed_vector.hpp>
+#include <word_packing/bit_expressions.hpp>
+#include <word_packing/encoding_advisor.hpp>
+#include <word_packing/hierarchical_bit_vector.hpp>
+#include <word_packing/memory.hpp>
+#include <word_packing/packed_sequence.hpp>
+#include <word_packing/profiler.hpp>
+#include <word_packing/selection.hpp>
 #include <word_packing/uint_min.hpp>
 
 namespace word_packing::test::examples {
@@ -67,6 +78,17 @@ TEST_SUITE("word_packing_examples") {
         }
     }
 
+    TEST_CASE("bit_ranges") {
+        using Pack = uint64_t;
+        Pack buffer[word_packing::num_packs_required<Pack>(100, 4)];
+
+        auto nibbles = word_packing::accessor<4>(buffer);
+        for(int i = 0; i < 100; i++) nibbles[i] = i % 16;
+
+        auto x = nibbles.get_bits(4 * 42, 32); // the eight integers at positions 42 to 49, the first in the lowest bits
+        CHECK(x == 0x10FEDCBAULL);
+    }
+
     TEST_CASE("packed_int_vector") {
         // we compute the first 20 Fibonacci numbers, which fit into 13 bits each
         word_packing::PackedIntVector fib(100, 13);
@@ -90,6 +112,85 @@ TEST_SUITE("word_packing_examples") {
         }
     }
 
+    TEST_CASE("padded_layout") {
+        word_packing::PackedFixedWidthIntVector<21, uint64_t, word_packing::bit_order::Padded> vec(1'000); // 334 packs instead of 329
+        auto acc = word_packing::accessor<21, word_packing::bit_order::Padded>(vec.data());
+        acc[999] = 12345;
+        CHECK(vec.capacity_bytes() == 334 * sizeof(uint64_t));
+        CHECK(vec[999] == 12345);
+    }
+
+    TEST_CASE("comparison_and_hashing") {
+        word_packing::PackedIntVector a(100, 9);
+        word_packing::PackedIntVector b(100, 9);
+        for(size_t i = 0; i < 100; i++) { a[i] = i; b[i] = i; }
+
+        bool equal = (a == b); // true
+        std::unordered_set<word_packing::PackedIntVector<>> distinct = { a, b }; // contains a single vector
+        CHECK(equal);
+        CHECK(distinct.size() == 1);
+    }
+
+    TEST_CASE("memory_accounting") {
+        word_packing::AllocationCounter counter;
+        word_packing::set_allocation_counter(&counter);
+
+        word_packing::PackedIntVector v(0, 7);
+        for(size_t i = 0; i < 100; i++) v.push_back(i);
+
+        auto const wasted = v.wasted_bits();       // 196, the capacity has grown to 128
+        auto const peak = counter.peak_bytes();    // 168, the bytes used by both vectors while growing from 64 to 128
+
+        word_packing::set_allocation_counter(nullptr);
+        CHECK(wasted == 196);
+        CHECK(peak == 168);
+    }
+
+    TEST_CASE("counting") {
+        word_packing::PackedFixedWidthIntVector<4> counters(1'000);
+        counters[7] = 0;
+        counters[8] = 0;
+        for(int i = 0; i < 20; i++) counters.increment<word_packing::overflow::Saturate>(7); // stops at 15
+        CHECK(counters[7] == 15);
+
+        word_packing::overflow::Escape escape;
+        counters.add(8, 100, escape);               // stores 15, records an excess of 85
+        auto const count = escape.get(counters, 8); // 100
+        CHECK(counters[8] == 15);
+        CHECK(count == 100);
+    }
+
+    TEST_CASE("instrumentation") {
+        struct ColumnA; // a tag
+        using Stats = word_packing::stats::Counting<ColumnA>;
+
+        word_packing::PackedIntVector<uint64_t, word_packing::bit_order::LsbFirst, Stats> column(1'000, 21);
+        for(size_t i = 0; i < column.size(); i++) column[i] = i;
+
+        auto const counters = Stats::aggregate(); // 1'000 sets, 313 of which straddle two word packs
+        std::ostringstream out;
+        Stats::dump(out, "column_a");             // prints all counters in a single line
+        CHECK(counters.sets == 1'000);
+        CHECK(counters.straddling_sets == 313);
+        CHECK(out.str().starts_with("STATS name=column_a"));
+    }
+
+    TEST_CASE("access_profiling") {
+        word_packing::PackedIntVector v(100'000, 21);
+        word_packing::Profiled p(v, 1); // sample every access
+        for(size_t k = 0; k < v.size(); k++) p[(k * 7'919) % v.size()] = k;
+
+        auto const r = p.recommend();       // fixed_width and padded, the accesses are random and a third of them straddle
+        std::ostringstream out;
+        p.profile().print(out, "v");        // prints the profile in a single line
+        r.print(out, "v");                  // prints the recommendation in a single line
+        CHECK(r.fixed_width);
+        CHECK(r.padded);
+        CHECK(!r.huge_pages);
+        CHECK(!r.block_compression);
+        CHECK(out.str().starts_with("PROFILE name=v"));
+    }
+
     TEST_CASE("uint_min") {
         using uint7 =  word_packing::UintMin<7>;  // resolves to uint8_t
         static_assert(std::is_same_v<uint7, uint8_t>);
@@ -98,6 +199,99 @@ TEST_SUITE("word_packing_examples") {
         using uint32 = word_packing::UintMin<32>; // resolves to uint32_t
         static_assert(std::is_same_v<uint32, uint32_t>);
     }
+
+    TEST_CASE("packed_sequence") {
+        word_packing::PackedSequence<2> seq;
+        seq.assign_ascii("ACGTTGCA", word_packing::alphabet::DNA);
+
+        auto kmer = seq.extract(2, 3); // G, T and T as a single integer, the first symbol in the lowest bits
+        CHECK(kmer == (2 | (3 << 2) | (3 << 4)));
+
+        size_t num_kmers = 0;
+        seq.for_each_kmer(4, [&](size_t i, uintmax_t kmer){
+            CHECK(kmer == seq.extract(i, 4));
+            ++num_kmers;
+        });
+        CHECK(num_kmers == 5);
+    }
+
+    TEST_CASE("encoding_advisor") {
+        std::vector<uint64_t> column(100'000);
+        for(size_t i = 0; i < column.size(); i++) column[i] = 3 * i;
+
+        auto const analysis = word_packing::analyze(column, 4);     // scan using four threads
+        auto const best = analysis.best();                           // Elias-Fano at three bits per integer, the column is sorted
+        auto const fast = analysis.best(1.5);                        // delta encoding, the best with at most 1.5 times the decoding cost of plain packing
+        std::ostringstream out;
+        analysis.print(out, "column");                               // prints the statistics and estimates in a single line
+        CHECK(best.encoding == word_packing::Encoding::ELIAS_FANO);
+        CHECK(best.bits_per_element == 3.0);
+        CHECK(fast.encoding == word_packing::Encoding::DELTA);
+        CHECK(out.str().starts_with("ANALYSIS name=column"));
+    }
+
+    TEST_CASE("adaptive_packed_vector") {
+        std::vector<uint64_t> column(200'000);
+        for(size_t i = 0; i < column.size(); i++) column[i] = (i < 100'000) ? 7 : 1'000'000 + i / 4;
+
+        word_packing::AdaptivePackedVector<> v(column);
+        auto const e0 = v.chunk_encoding(0); // Encoding::RLE, a single run
+        auto const e2 = v.chunk_encoding(2); // Encoding::FOR, five bits per integer and a frame per block
+        CHECK(e0 == word_packing::Encoding::RLE);
+        CHECK(e2 == word_packing::Encoding::FOR);
+
+        v[5] = 8;                            // chunk 0 is decoded into plain packing and marked dirty
+        CHECK(v.chunk_encoding(0) == word_packing::Encoding::PLAIN);
+        v.optimize();                        // chunk 0 is re-encoded using run-length encoding
+        CHECK(v.chunk_encoding(0) == word_packing::Encoding::RLE);
+        CHECK(v[5] == 8);
+    }
+
+    TEST_CASE("successor_queries") {
+        word_packing::HierarchicalBitVector free_slots(1ULL << 30); // four summary levels
+        free_slots.set(17);
+        free_slots.set(1'000'000'000);
+
+        auto const a = free_slots.next_set(18);          // 1'000'000'000, found without scanning the bits in between
+        auto const b = free_slots.prev_set(999'999'999); // 17
+        CHECK(free_slots.num_summary_levels() == 4);
+        CHECK(a == 1'000'000'000);
+        CHECK(b == 17);
+    }
+
+    TEST_CASE("bit_vector_ranges") {
+        word_packing::BitVector deleted(1'000'000);
+        deleted.reset_range(0, deleted.size());
+        deleted.set_range(1'000, 250'000);                 // a single memset, apart from two masked word packs
+        deleted.flip_range(100'000, 100'100);
+        auto const num_deleted = deleted.count_range(0, deleted.size()); // 248'900
+        CHECK(num_deleted == 248'900);
+    }
+
+    TEST_CASE("bit_expressions") {
+        word_packing::BitVector a(1'000), b(1'000), c(1'000);
+        for(size_t i = 0; i < 1'000; i++) { a[i] = (i % 2 == 0); b[i] = (i % 3 == 0); c[i] = (i % 5 != 0); }
+
+        auto const expr = (a & b) | ~c;                           // nothing is evaluated yet
+        auto const num = word_packing::count_ones(expr);          // a single pass over a, b and c
+        size_t num_enumerated = 0;
+        word_packing::for_each_set(expr, [&](size_t i){ CHECK((i % 6 == 0 || i % 5 == 0)); ++num_enumerated; });
+        word_packing::BitVector result = word_packing::evaluate(expr);
+        CHECK(num == 167 + 200 - 34);
+        CHECK(num_enumerated == num);
+        CHECK(word_packing::count_ones(result) == num);
+    }
+
+    TEST_CASE("filtered_decoding") {
+        word_packing::PackedIntVector column(1'000, 10);
+        word_packing::BitVector mask(1'000);
+        for(size_t i = 0; i < 1'000; i++) { column[i] = i; mask[i] = (i % 10 == 0); }
+
+        std::vector<uintmax_t> out(100);
+        auto const num = word_packing::decode_selected(column, mask, out.data()); // 100 integers, read individually
+        CHECK(num == 100);
+        for(size_t k = 0; k < num; k++) CHECK(out[k] == 10 * k);
+    }
 }
 
 }
@@ -0,0 +1,129 @@
+/**
+ * test_hierarchical_bit_vector.cpp
+ * part of pdinklag/word-packing
+ * 
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include <random>
+#include <vector>
+
+#include <word_packing.hpp>
+#include <word_packing/hierarchical_bit_vector.hpp>
+
+namespace word_packing::test::hierarchical_bit_vector {
+
+size_t naive_next(std::vector<bool> const& bits, size_t i) {
+    for(; i < bits.size(); i++) if(bits[i]) return i;
+    return bits.size();
+}
+
+size_t naive_prev(std::vector<bool> const& bits, size_t i) {
+    if(bits.empty()) return 0;
+    for(size_t j = std::min(i, bits.size() - 1) + 1; j-- > 0;) if(bits[j]) return j;
+    return bits.size();
+}
+
+void check_queries(HierarchicalBitVector const& hbv, std::vector<bool> const& bits, std::mt19937_64& gen) {
+    size_t const n = bits.size();
+    CHECK(hbv.first_set() == naive_next(bits, 0));
+    CHECK(hbv.last_set() == naive_prev(bits, n));
+    CHECK(hbv.any() == (naive_next(bits, 0) < n));
+    for(size_t q = 0; q < 200 && n > 0; q++) {
+        size_t const i = gen() % n;
+        CHECK(hbv.next_set(i) == naive_next(bits, i));
+        CHECK(hbv.prev_set(i) == naive_prev(bits, i));
+    }
+}
+
+TEST_SUITE("hierarchical_bit_vector") {
+    TEST_CASE("random") {
+        std::mt19937_64 gen(97);
+        for(size_t n : { 0, 1, 63, 64, 65, 4'095, 4'096, 4'097, 300'000 }) {
+            HierarchicalBitVector hbv(n);
+            std::vector<bool> bits(n);
+            check_queries(hbv, bits, gen);
+            if(n == 0) continue;
+
+            // sparse
+            for(size_t k = 0; k < 10; k++) {
+                size_t const i = gen() % n;
+                hbv.set(i);
+                bits[i] = true;
+            }
+            check_queries(hbv, bits, gen);
+
+            // dense, then reset most bits again
+            for(size_t k = 0; k < n / 2; k++) {
+                size_t const i = gen() % n;
+                hbv.set(i);
+                bits[i] = true;
+            }
+            check_queries(hbv, bits, gen);
+            for(size_t i = 0; i < n; i++) {
+                if(i % 1'000 != 7) {
+                    hbv.reset(i);
+                    bits[i] = false;
+                }
+            }
+            check_queries(hbv, bits, gen);
+            for(size_t i = 0; i < n; i++) CHECK(hbv[i] == bits[i]);
+        }
+    }
+
+    TEST_CASE("edges") {
+        HierarchicalBitVector hbv(1ULL << 24);
+        CHECK(hbv.num_summary_levels() == 3);
+        CHECK(hbv.first_set() == hbv.size());
+        CHECK(hbv.prev_set(hbv.size()) == hbv.size());
+
+        hbv.set(0);
+        hbv.set(hbv.size() - 1);
+        CHECK(hbv.next_set(1) == hbv.size() - 1);
+        CHECK(hbv.prev_set(hbv.size() - 2) == 0);
+
+        hbv.reset(0);
+        CHECK(hbv.first_set() == hbv.size() - 1);
+        CHECK(hbv.prev_set(hbv.size() - 2) == hbv.size());
+        hbv.reset(hbv.size() - 1);
+        CHECK(!hbv.any());
+    }
+
+    TEST_CASE("from_bit_vector") {
+        BitVector bv(1'000);
+        for(size_t i = 0; i < bv.size(); i++) bv[i] = (i % 97 == 3);
+        HierarchicalBitVector hbv(bv);
+        CHECK(hbv.num_summary_levels() == 1);
+        CHECK(hbv.first_set() == 3);
+        CHECK(hbv.next_set(4) == 100);
+        CHECK(hbv.prev_set(99) == 3);
+        CHECK(hbv.last_set() == 973);
+        for(size_t i = 0; i < bv.size(); i++) CHECK(hbv.bits()[i] == bv[i]);
+        CHECK(hbv.memory_usage() > bv.memory_usage());
+    }
+}
+
+}
@@ -0,0 +1,134 @@
+/**
+ * test_memory.cpp
+ * part of pdinklag/word-packing
+ * 
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include <word_packing.hpp>
+#include <word_packing/compact_hash_set.hpp>
+#include <word_packing/memory.hpp>
+#include <word_packing/rank_select.hpp>
+#include <word_packing/wavelet_matrix.hpp>
+
+namespace word_packing::test::memory {
+
+template<typename Vector>
+void check_accounting(Vector const& v) {
+    using Pack = std::remove_const_t<std::remove_pointer_t<decltype(v.data())>>;
+    size_t const bytes = num_packs_required<Pack>(v.capacity(), v.width()) * sizeof(Pack);
+    CHECK(v.capacity_bytes() == bytes);
+    CHECK(v.memory_usage() == bytes);
+    CHECK(v.payload_bits() == v.size() * v.width());
+    CHECK(v.wasted_bits() == 8 * bytes - v.size() * v.width());
+}
+
+TEST_SUITE("memory") {
+    TEST_CASE("vectors") {
+        PackedIntVector<uint32_t> v(0, 7);
+        check_accounting(v);
+        CHECK(v.memory_usage() == 0);
+
+        for(size_t i = 0; i < 100; i++) {
+            v.push_back(i);
+            check_accounting(v);
+        }
+        CHECK(v.capacity() == 128);
+        CHECK(v.capacity_bytes() == 28 * sizeof(uint32_t));
+        CHECK(v.wasted_bits() == 28 * 32 - 700); // unused capacity
+
+        v.shrink_to_fit();
+        check_accounting(v);
+        CHECK(v.capacity_bytes() == 22 * sizeof(uint32_t));
+        CHECK(v.wasted_bits() == 22 * 32 - 700); // slack in the last pack
+
+        auto const copy = v;
+        check_accounting(copy);
+        CHECK(copy.memory_usage() == v.memory_usage());
+
+        PackedFixedWidthIntVector<5, uint8_t> f(10);
+        f.reserve(30);
+        check_accounting(f);
+        CHECK(f.capacity_bytes() == 19);
+        CHECK(f.payload_bits() == 50);
+    }
+
+    TEST_CASE("structures") {
+        BitVector bv(10'000);
+        std::fill(bv.data(), bv.data() + num_packs_required<uintmax_t>(10'000, 1), uintmax_t(0x5555555555555555ULL));
+        RankSelect<> rs(bv);
+        CHECK(rs.memory_usage() == (internal::idiv_ceil(10'000, 512) + 1) * sizeof(size_t));
+        CHECK(RankSelect<>().memory_usage() == 0);
+
+        CompactHashSet<> set(20, 64);
+        CHECK(set.memory_usage() > 0);
+        size_t const before = set.memory_usage();
+        for(uintmax_t x = 0; x < 1'000; x++) set.insert(x);
+        CHECK(set.memory_usage() > before);
+
+        PackedIntVector<> seq(1'000, 6);
+        for(size_t i = 0; i < seq.size(); i++) seq[i] = (i * 7) % 64;
+        WaveletMatrix wm(seq);
+        CHECK(wm.memory_usage() >= 6 * num_packs_required<uintmax_t>(1'000, 1) * sizeof(uintmax_t));
+    }
+
+    TEST_CASE("allocation counter") {
+        size_t const bytes_1k = num_packs_required<uintmax_t>(1'000, 10) * sizeof(uintmax_t);
+        size_t const bytes_2k = num_packs_required<uintmax_t>(2'000, 10) * sizeof(uintmax_t);
+
+        CHECK(allocation_counter() == nullptr);
+        {
+            PackedIntVector<> uncounted(1'000, 10); // allocated before the counter is installed
+
+            AllocationCounter counter;
+            set_allocation_counter(&counter);
+            CHECK(allocation_counter() == &counter);
+            {
+                PackedIntVector<> v(1'000, 10);
+                CHECK(counter.current_bytes() == v.memory_usage());
+                CHECK(counter.num_allocations() == 1);
+
+                BitVector bv(64);
+                CHECK(counter.current_bytes() == v.memory_usage() + bv.memory_usage());
+                CHECK(counter.num_allocations() == 2);
+
+                v.resize(2'000);
+                CHECK(counter.current_bytes() == v.memory_usage() + bv.memory_usage());
+                CHECK(counter.num_allocations() == 3);
+                CHECK(counter.peak_bytes() == bytes_1k + bytes_2k + 8); // both vectors exist while copying
+            }
+            uncounted = PackedIntVector<>(); // frees memory that was not counted
+            CHECK(counter.current_bytes() == 0);
+            CHECK(counter.total_bytes() == bytes_1k + bytes_2k + 8);
+
+            set_allocation_counter(nullptr);
+            PackedIntVector<> after(1'000, 10);
+            CHECK(counter.num_allocations() == 3);
+        }
+    }
+}
+
+}
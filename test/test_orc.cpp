@@ -0,0 +1,105 @@
+/**
+ * test_orc.cpp
+ * part of pdinklag/word-packing
+ * 
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include <random>
+#include <vector>
+
+#include <word_packing.hpp>
+#include <word_packing/orc.hpp>
+
+namespace word_packing::test::orc {
+
+PackedIntVector<> random_runs(size_t const n, size_t const width, uint64_t const seed) {
+    std::mt19937_64 gen(seed);
+    std::uniform_int_distribution<size_t> run_dist(1, 15);
+    auto const mask = internal::low_mask(width);
+
+    PackedIntVector<> v(n, width);
+    for(size_t i = 0; i < n;) {
+        uintmax_t const x = gen() & mask;
+        size_t const r = run_dist(gen);
+        for(size_t j = 0; j < r && i < n; j++) v[i++] = x;
+    }
+    return v;
+}
+
+TEST_SUITE("orc") {
+    TEST_CASE("specification examples") {
+        {
+            // short repeat
+            uint8_t const encoded[] = { 0x0a, 0x27, 0x10 };
+            PackedIntVector<> v(5, 14);
+            CHECK(word_packing::orc::decode_rle_v2(encoded, sizeof(encoded), 5, v));
+            for(size_t i = 0; i < 5; i++) CHECK(v[i] == 10000);
+
+            std::vector<uint8_t> reencoded;
+            word_packing::orc::encode_rle_v2(v, reencoded);
+            CHECK(reencoded == std::vector<uint8_t>(encoded, encoded + sizeof(encoded)));
+        }
+        {
+            // direct
+            uint8_t const encoded[] = { 0x5e, 0x03, 0x5c, 0xa1, 0xab, 0x1e, 0xde, 0xad, 0xbe, 0xef };
+            uintmax_t const expected[] = { 23713, 43806, 57005, 48879 };
+            PackedIntVector<> v(4, 16);
+            CHECK(word_packing::orc::decode_rle_v2(encoded, sizeof(encoded), 4, v));
+            for(size_t i = 0; i < 4; i++) CHECK(v[i] == expected[i]);
+
+            std::vector<uint8_t> reencoded;
+            word_packing::orc::encode_rle_v2(v, reencoded);
+            CHECK(reencoded == std::vector<uint8_t>(encoded, encoded + sizeof(encoded)));
+        }
+    }
+
+    TEST_CASE("roundtrip") {
+        for(size_t w = 1; w <= 64; w++) {
+            auto const v = random_runs(2'000, w, w);
+
+            std::vector<uint8_t> encoded;
+            word_packing::orc::encode_rle_v2(v, encoded);
+
+            PackedIntVector<> decoded(2'001, w);
+            CHECK(word_packing::orc::decode_rle_v2(encoded.data(), encoded.size(), v.size(), decoded, 1));
+            for(size_t i = 0; i < v.size(); i++) CHECK(decoded[1 + i] == v[i]);
+        }
+    }
+
+    TEST_CASE("errors") {
+        PackedIntVector<> v(5, 8);
+
+        uint8_t const short_repeat[] = { 0x0a, 0x27, 0x10 };
+        CHECK(!word_packing::orc::decode_rle_v2(short_repeat, 2, 5, v));   // truncated
+        CHECK(!word_packing::orc::decode_rle_v2(short_repeat, 3, 5, v));   // exceeds width
+
+        uint8_t const delta[] = { 0xc6, 0x09, 0x02, 0x02 };
+        CHECK(!word_packing::orc::decode_rle_v2(delta, sizeof(delta), 5, v)); // unsupported
+    }
+}
+
+}
@@ -0,0 +1,111 @@
+/**
+ * test_packed_count_min_sketch.cpp
+ * part of pdinklag/word-packing
+ * 
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include <random>
+#include <vector>
+
+#include <word_packing.hpp>
+#include <word_packing/packed_count_min_sketch.hpp>
+
+namespace word_packing::test::packed_count_min_sketch {
+
+TEST_SUITE("packed_count_min_sketch") {
+    template<size_t width>
+    void sketch_test(bool const conservative) {
+        constexpr uintmax_t max = internal::low_mask(width);
+        size_t const num_keys = 1'000;
+
+        // generate a skewed stream
+        std::mt19937_64 gen(width);
+        std::geometric_distribution<uint64_t> dist(0.01);
+        std::vector<uint64_t> stream;
+        std::vector<uintmax_t> freq(num_keys, 0);
+        for(size_t i = 0; i < 20'000; i++) {
+            uint64_t const key = dist(gen) % num_keys;
+            stream.push_back(key);
+            ++freq[key];
+        }
+
+        PackedCountMinSketch<width> sketch(4, 2'048, conservative);
+        CHECK(sketch.num_rows() == 4);
+        CHECK(sketch.num_columns() == 2'048);
+        CHECK(sketch.counter_width() == width);
+
+        sketch.add_many(stream.data(), stream.size() / 2);
+        for(size_t i = stream.size() / 2; i < stream.size(); i++) sketch.add(stream[i]);
+
+        std::vector<uint64_t> keys(num_keys);
+        for(size_t k = 0; k < num_keys; k++) keys[k] = k;
+        std::vector<uintmax_t> estimates(num_keys);
+        sketch.estimate_many(keys.data(), num_keys, estimates.data());
+
+        size_t exact = 0;
+        for(size_t k = 0; k < num_keys; k++) {
+            // never underestimate, up to saturation
+            CHECK(estimates[k] >= std::min(freq[k], max));
+            CHECK(estimates[k] <= max);
+            CHECK(estimates[k] == sketch.estimate(k));
+            exact += (estimates[k] == std::min(freq[k], max));
+        }
+        CHECK(exact > num_keys / 2);
+    }
+
+    TEST_CASE("estimate") {
+        for(bool conservative : { false, true }) {
+            sketch_test<4>(conservative);
+            sketch_test<8>(conservative);
+            sketch_test<13>(conservative);
+        }
+    }
+
+    TEST_CASE("add counts") {
+        PackedCountMinSketch<8> sketch(3, 64, true);
+        sketch.add(42, 100);
+        sketch.add(42, 100);
+        CHECK(sketch.estimate(42) == 200);
+        sketch.add(42, 100);
+        CHECK(sketch.estimate(42) == 255);
+        sketch.clear();
+        CHECK(sketch.estimate(42) == 0);
+
+        // full-width counters saturate instead of wrapping
+        for(bool conservative : { false, true }) {
+            PackedCountMinSketch<64> wide(3, 64, conservative);
+            wide.add(42, UINT64_MAX - 1);
+            CHECK(wide.estimate(42) == UINT64_MAX - 1);
+            wide.add(42, 5);
+            CHECK(wide.estimate(42) == UINT64_MAX);
+            wide.add(42, UINT64_MAX);
+            CHECK(wide.estimate(42) == UINT64_MAX);
+        }
+    }
+}
+
+}
@@ -0,0 +1,142 @@
+/**
+ * test_packed_fenwick_tree.cpp
+ * part of pdinklag/word-packing
+ * 
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include <random>
+#include <vector>
+
+#include <word_packing.hpp>
+#include <word_packing/packed_fenwick_tree.hpp>
+
+namespace word_packing::test::packed_fenwick_tree {
+
+TEST_SUITE("packed_fenwick_tree") {
+    TEST_CASE("add and prefix_sum") {
+        auto test = [](size_t const num, size_t const counter_width){
+            auto const max = internal::low_mask(counter_width);
+
+            PackedFenwickTree<> tree(num, counter_width);
+            CHECK(tree.size() == num);
+            CHECK(tree.counter_width() == counter_width);
+
+            std::vector<uintmax_t> counters(num, 0);
+            std::mt19937_64 gen(num);
+            std::uniform_int_distribution<size_t> index_dist(0, num - 1);
+            for(size_t q = 0; q < 2 * num; q++) {
+                size_t const i = index_dist(gen);
+                uintmax_t const delta = std::uniform_int_distribution<uintmax_t>(0, max - counters[i])(gen);
+                CHECK(tree.add(i, delta));
+                counters[i] += delta;
+            }
+
+            // decrease some counters again
+            for(size_t q = 0; q < num; q++) {
+                size_t const i = index_dist(gen);
+                uintmax_t const delta = std::uniform_int_distribution<uintmax_t>(0, counters[i])(gen);
+                CHECK(tree.add(i, -intmax_t(delta)));
+                counters[i] -= delta;
+            }
+
+            uintmax_t sum = 0;
+            for(size_t i = 0; i < num; i++) {
+                CHECK(tree.prefix_sum(i) == sum);
+                CHECK(tree.get(i) == counters[i]);
+                sum += counters[i];
+            }
+            CHECK(tree.prefix_sum(num) == sum);
+        };
+
+        for(size_t w : { 1, 4, 7, 16 }) {
+            test(1, w);
+            test(1'000, w);
+            test(1'024, w);
+        }
+    }
+
+    TEST_CASE("overflow") {
+        // the levels of a tree over 8-bit counters are capped at the width of the word packs
+        PackedFenwickTree<uint8_t> tree(100, 8);
+        CHECK(tree.add(0, 255));
+        CHECK(!tree.add(1, 255)); // node 2 would hold 510
+        CHECK(tree.get(0) == 255);
+        CHECK(tree.get(1) == 0);
+        CHECK(!tree.add(1, 1)); // node 2 would hold 256
+        CHECK(!tree.add(2, 200)); // node 3 is rolled back, because node 4 would hold 455
+        CHECK(tree.get(2) == 0);
+        CHECK(tree.add(0, -100));
+        CHECK(tree.add(1, 100));
+        CHECK(tree.get(0) == 155);
+        CHECK(tree.get(1) == 100);
+        CHECK(tree.prefix_sum(100) == 255);
+
+        // node sums must not become negative
+        CHECK(!tree.add(5, -1));
+        CHECK(tree.get(5) == 0);
+        CHECK(tree.prefix_sum(100) == 255);
+
+        // node sums wrapping around full-width levels
+        PackedFenwickTree<> wide(4, 64);
+        CHECK(wide.add(0, INTMAX_MAX));
+        CHECK(wide.add(1, INTMAX_MAX));
+        CHECK(!wide.add(1, 2)); // node 2 would hold 2^64
+        CHECK(wide.get(1) == uintmax_t(INTMAX_MAX));
+        CHECK(wide.prefix_sum(2) == 2 * uintmax_t(INTMAX_MAX));
+        for(size_t i = 0; i <= 4; i++) CHECK(wide.prefix_sum(i) == std::min(i, size_t(2)) * uintmax_t(INTMAX_MAX));
+    }
+
+    TEST_CASE("construct from counters") {
+        size_t const num = 3'333;
+        PackedIntVector<> counters(num, 5);
+        for(size_t i = 0; i < num; i++) counters[i] = i % 32;
+
+        PackedFenwickTree<> tree(counters);
+        uintmax_t sum = 0;
+        for(size_t i = 0; i < num; i++) {
+            CHECK(tree.prefix_sum(i) == sum);
+            sum += counters[i];
+        }
+        CHECK(tree.prefix_sum(num) == sum);
+    }
+
+    TEST_CASE("find") {
+        size_t const num = 777;
+        PackedIntVector<> counters(num, 3);
+        for(size_t i = 0; i < num; i++) counters[i] = (i * 7) % 5; // nb: contains zeros
+
+        PackedFenwickTree<> tree(counters);
+        uintmax_t const total = tree.prefix_sum(num);
+        for(uintmax_t s = 0; s <= total + 1; s++) {
+            size_t const i = tree.find(s);
+            CHECK(tree.prefix_sum(i) <= s);
+            if(i < num) CHECK(tree.prefix_sum(i + 1) > s);
+        }
+    }
+}
+
+}
@@ -28,6 +28,8 @@
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 #include "doctest.h"
 
+#include <vector>
+
 #include <word_packing.hpp>
 
 namespace word_packing::test::packed_int_vector {
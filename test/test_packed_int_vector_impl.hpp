@@ -277,4 +277,104 @@ TEST_SUITE("packed_int_vector") {
 
         for(size_t w = 1; w <= MAX_WIDTH; w++) const_iterator_test(w);
     }
+
+    TEST_CASE("add and increment") {
+        auto add_test = [](size_t width){
+            size_t const num = 333;
+            auto const mask = word_packing::internal::low_mask(width);
+
+            PackedIntVector v(num, width);
+            for(size_t i = 0; i < num; i++) v[i] = 0;
+
+            // increment each integer i times with saturation
+            std::vector<size_t> indices;
+            for(size_t i = 0; i < num; i++) {
+                for(size_t j = 0; j < i; j++) indices.push_back(i);
+            }
+            v.template increment_many<overflow::Saturate>(indices.data(), indices.size());
+            for(size_t i = 0; i < num; i++) CHECK(v[i] == std::min(uintmax_t(i), mask));
+
+            // wrap around
+            for(size_t i = 0; i < num; i++) {
+                v.add(i, mask);
+                CHECK(v[i] == ((std::min(uintmax_t(i), mask) + mask) & mask));
+            }
+
+            // record overflows in an escape map
+            overflow::Escape escape;
+            for(size_t i = 0; i < num; i++) v[i] = 0;
+            v.increment_many(indices.data(), indices.size(), escape);
+            for(size_t i = 0; i < num; i++) {
+                CHECK(v[i] == std::min(uintmax_t(i), mask));
+                CHECK(escape.get(v, i) == i);
+            }
+            for(size_t i = 0; i < num; i++) {
+                v.add(i, 2 * i, escape);
+                v.increment(i, escape);
+                CHECK(escape.get(v, i) == 3 * i + 1);
+            }
+        };
+
+        for(size_t w = 1; w <= MAX_WIDTH; w++) add_test(w);
+
+        // the word packs to prefetch are located according to the bit order
+        size_t const width = MAX_WIDTH / 2 + 1;
+        word_packing::PackedIntVector<internal::pack_of<PackedIntVector>, bit_order::Padded> padded(1'000, width);
+        for(size_t i = 0; i < padded.size(); i++) padded[i] = 0;
+        std::vector<size_t> indices;
+        for(size_t i = 0; i < padded.size(); i++) indices.push_back((i * 7) % padded.size());
+        padded.increment_many(indices.data(), indices.size());
+        for(size_t i = 0; i < padded.size(); i++) CHECK(padded[i] == 1);
+    }
+
+    TEST_CASE("compare and hash") {
+        auto compare_test = [](size_t width){
+            size_t const num = 333;
+            auto const mask = word_packing::internal::low_mask(width);
+
+            // the second vector contains garbage beyond its size, which must be ignored
+            PackedIntVector a(num, width);
+            PackedIntVector b(num + 5, width);
+            for(size_t i = 0; i < num + 5; i++) b[i] = mask;
+            b.resize(num);
+            for(size_t i = 0; i < num; i++) {
+                a[i] = (i * 7) & mask;
+                b[i] = (i * 7) & mask;
+            }
+
+            CHECK(a == b);
+            CHECK((a <=> b) == std::strong_ordering::equal);
+            CHECK(a.hash() == b.hash());
+            CHECK(a.hash(1) != a.hash(2));
+
+            // modify a single integer
+            for(size_t j : { size_t(0), num / 2, num - 1 }) {
+                uintmax_t const x = b[j];
+                b[j] = (x + 1) & mask;
+                CHECK(a != b);
+                CHECK((a < b) == (uintmax_t(b[j]) > x));
+                CHECK(a.hash() != b.hash());
+                b[j] = x;
+            }
+
+            // prefixes are less
+            b.pop_back();
+            CHECK(a != b);
+            CHECK(b < a);
+
+            // equal integers of different widths are ordered by width
+            if(width < MAX_WIDTH) {
+                PackedIntVector c(num, width + 1);
+                for(size_t i = 0; i < num; i++) c[i] = uintmax_t(a[i]);
+                CHECK(a != c);
+                CHECK(a < c);
+            }
+        };
+
+        for(size_t w = 1; w <= MAX_WIDTH; w++) compare_test(w);
+
+        PackedIntVector empty1, empty2;
+        CHECK(empty1 == empty2);
+        CHECK(empty1.hash() == empty2.hash());
+    }
 }
@@ -0,0 +1,120 @@
+/**
+ * test_packed_permutation.cpp
+ * part of pdinklag/word-packing
+ * 
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include <algorithm>
+#include <bit>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include <word_packing.hpp>
+#include <word_packing/packed_permutation.hpp>
+
+namespace word_packing::test::packed_permutation {
+
+TEST_SUITE("packed_permutation") {
+    PackedIntVector<> to_packed(std::vector<size_t> const& perm) {
+        size_t const width = std::max<size_t>(1, std::bit_width(perm.size() - 1));
+        PackedIntVector<> pi(perm.size(), width);
+        for(size_t i = 0; i < perm.size(); i++) pi[i] = perm[i];
+        return pi;
+    }
+
+    void inverse_test(std::vector<size_t> const& perm, size_t const t, size_t const num_threads) {
+        size_t const n = perm.size();
+        PackedPermutation<> pi(to_packed(perm), t, num_threads);
+        CHECK(pi.size() == n);
+        CHECK(pi.shortcut_interval() == t);
+
+        std::vector<size_t> inv(n);
+        for(size_t i = 0; i < n; i++) inv[perm[i]] = i;
+
+        for(size_t i = 0; i < n; i++) {
+            CHECK(pi[i] == perm[i]);
+            CHECK(pi.inverse(i) == inv[i]);
+        }
+    }
+
+    TEST_CASE("inverse") {
+        std::mt19937_64 gen(0);
+        for(size_t n : { 1, 2, 100, 10'000 }) {
+            std::vector<size_t> perm(n);
+            std::iota(perm.begin(), perm.end(), 0);
+
+            // identity
+            inverse_test(perm, 4, 1);
+
+            // one large cycle
+            std::vector<size_t> cycle(n);
+            for(size_t i = 0; i < n; i++) cycle[i] = (i + 1) % n;
+            for(size_t t : { 1, 3, 16 }) {
+                inverse_test(cycle, t, 1);
+                inverse_test(cycle, t, 4);
+            }
+
+            // random
+            std::shuffle(perm.begin(), perm.end(), gen);
+            for(size_t t : { 1, 3, 16 }) {
+                inverse_test(perm, t, 1);
+                inverse_test(perm, t, 4);
+            }
+        }
+    }
+
+    TEST_CASE("shortcuts") {
+        size_t const n = 10'000;
+        std::vector<size_t> cycle(n);
+        for(size_t i = 0; i < n; i++) cycle[i] = (i + 1) % n;
+
+        PackedPermutation<> pi(to_packed(cycle), 10);
+        CHECK(pi.num_shortcuts() == n / 10);
+    }
+
+    TEST_CASE("apply") {
+        size_t const n = 5'000;
+        std::vector<size_t> perm(n);
+        std::iota(perm.begin(), perm.end(), 0);
+        std::shuffle(perm.begin(), perm.end(), std::mt19937_64(1));
+        PackedPermutation<> pi(to_packed(perm));
+
+        PackedFixedWidthIntVector<11> src(n);
+        PackedIntVector<> dst(n, 11);
+        for(size_t i = 0; i < n; i++) src[i] = i;
+        pi.apply(src, dst);
+        for(size_t i = 0; i < n; i++) CHECK(dst[i] == (perm[i] & internal::low_mask(11)));
+
+        PackedIntVector<uintmax_t, bit_order::Padded> padded(n, 22);
+        for(size_t i = 0; i < n; i++) padded[i] = i;
+        pi.apply(padded, dst);
+        for(size_t i = 0; i < n; i++) CHECK(dst[i] == (perm[i] & internal::low_mask(11)));
+    }
+}
+
+}
@@ -0,0 +1,204 @@
+/**
+ * test_packed_sequence.cpp
+ * part of pdinklag/word-packing
+ * 
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include <word_packing.hpp>
+#include <word_packing/packed_sequence.hpp>
+
+namespace word_packing::test::packed_sequence {
+
+template<size_t w>
+std::vector<uintmax_t> random_symbols(size_t const n, uintmax_t const sigma) {
+    std::mt19937 gen(w);
+    std::uniform_int_distribution<uintmax_t> dist(0, sigma - 1);
+
+    std::vector<uintmax_t> v(n);
+    for(auto& x : v) x = dist(gen);
+    return v;
+}
+
+template<size_t w>
+uintmax_t naive_extract(std::vector<uintmax_t> const& v, size_t const i, size_t const k) {
+    uintmax_t x = 0;
+    for(size_t j = 0; j < k; j++) x |= v[i + j] << (j * w);
+    return x;
+}
+
+template<size_t w>
+void test_extract() {
+    size_t const n = 1000;
+    auto const v = random_symbols<w>(n, 1ULL << w);
+
+    PackedSequence<w> seq(n);
+    for(size_t i = 0; i < n; i++) seq.set(i, v[i]);
+
+    for(size_t k = 0; k <= PackedSequence<w>::MAX_K; k++) {
+        for(size_t i = 0; i + k <= n; i++) {
+            CHECK(seq.extract(i, k) == naive_extract<w>(v, i, k));
+        }
+    }
+}
+
+template<size_t w>
+void test_kmers() {
+    size_t const n = 500;
+    auto const v = random_symbols<w>(n, 1ULL << w);
+
+    PackedSequence<w> seq(n);
+    for(size_t i = 0; i < n; i++) seq.set(i, v[i]);
+
+    for(size_t k = 1; k <= PackedSequence<w>::MAX_K; k++) {
+        size_t count = 0;
+        seq.for_each_kmer(k, [&](size_t const i, uintmax_t const kmer){
+            CHECK(i == count);
+            CHECK(kmer == naive_extract<w>(v, i, k));
+            ++count;
+        });
+        CHECK(count == n - k + 1);
+    }
+}
+
+TEST_SUITE("packed_sequence") {
+    TEST_CASE("extract") {
+        test_extract<1>();
+        test_extract<2>();
+        test_extract<3>();
+        test_extract<5>();
+        test_extract<7>();
+        test_extract<8>();
+    }
+
+    TEST_CASE("kmers") {
+        test_kmers<2>();
+        test_kmers<5>();
+
+        PackedSequence<2> seq(3);
+        size_t count = 0;
+        seq.for_each_kmer(4, [&](size_t, uintmax_t){ ++count; });
+        CHECK(count == 0);
+    }
+
+    TEST_CASE("dna") {
+        std::string const text = "ACGTacgtTTGCA";
+        PackedSequence<2> seq;
+        CHECK(seq.assign_ascii(text, alphabet::DNA));
+        REQUIRE(seq.size() == text.size());
+
+        uintmax_t const expected[] = { 0, 1, 2, 3, 0, 1, 2, 3, 3, 3, 2, 1, 0 };
+        for(size_t i = 0; i < seq.size(); i++) CHECK(seq[i] == expected[i]);
+
+        CHECK(!seq.assign_ascii("ACGN", alphabet::DNA));
+    }
+
+    TEST_CASE("protein") {
+        std::string_view const letters = "ACDEFGHIKLMNPQRSTVWY";
+
+        // long enough for symbols to straddle word packs
+        std::mt19937 gen(5);
+        std::uniform_int_distribution<size_t> dist(0, letters.size() - 1);
+        std::vector<uintmax_t> codes(1000);
+        std::string text;
+        for(auto& c : codes) {
+            c = dist(gen);
+            text.push_back(letters[c]);
+        }
+
+        PackedSequence<5> seq;
+        CHECK(seq.assign_ascii(text, alphabet::PROTEIN));
+        REQUIRE(seq.size() == text.size());
+        for(size_t i = 0; i < seq.size(); i++) CHECK(seq[i] == codes[i]);
+
+        CHECK(!seq.assign_ascii("ACDB", alphabet::PROTEIN));
+    }
+
+    TEST_CASE("wide") {
+        // codes of at least eight bits cannot exceed the width, so only unmapped characters are invalid
+        PackedSequence<8> seq;
+        CHECK(seq.assign_ascii("ACGT", alphabet::DNA));
+        CHECK(seq[3] == 3);
+        CHECK(!seq.assign_ascii("ACGN", alphabet::DNA));
+        CHECK(!seq.assign_ascii(std::string(100, 'A') + "N", alphabet::DNA));
+
+        PackedSequence<9> seq9;
+        CHECK(seq9.assign_ascii(std::string(100, 'T'), alphabet::DNA));
+        CHECK(seq9[99] == 3);
+        CHECK(!seq9.assign_ascii(std::string(100, 'A') + "N", alphabet::DNA));
+    }
+
+    TEST_CASE("kernels") {
+        // forces the SSSE3 and portable kernels
+        auto& features = internal::cpu::features();
+        auto const detected = features;
+
+        // all characters, mapping every byte to a 5-bit code, which also makes them straddle word packs
+        AsciiTable table;
+        for(size_t c = 0; c < 256; c++) table[c] = (c * 7) % 32;
+
+        std::mt19937 gen(83);
+        auto check = [&](){
+            for(size_t n : { 0, 1, 7, 8, 15, 16, 31, 32, 33, 100, 1'000 }) {
+                std::string text(n, 0);
+                for(auto& c : text) c = char(gen());
+
+                PackedSequence<5> seq;
+                CHECK(seq.assign_ascii(text, table));
+                REQUIRE(seq.size() == n);
+                for(size_t i = 0; i < n; i++) CHECK(seq[i] == table[uint8_t(text[i])]);
+
+                PackedSequence<2> dna;
+                std::string dna_text(n, 0);
+                for(auto& c : dna_text) c = "ACGTacgt"[gen() % 8];
+                CHECK(dna.assign_ascii(dna_text, alphabet::DNA));
+                for(size_t i = 0; i < n; i++) CHECK(dna[i] == alphabet::DNA[uint8_t(dna_text[i])]);
+
+                // an invalid character or a code exceeding the width at any position
+                for(size_t i = 0; i < n; i += 7) {
+                    std::string bad = dna_text;
+                    bad[i] = 'N';
+                    CHECK(!dna.assign_ascii(bad, alphabet::DNA));
+                    bad[i] = 'W';
+                    CHECK(!dna.assign_ascii(bad, alphabet::PROTEIN));
+                }
+            }
+        };
+
+        check();
+        features.avx2 = false;
+        check();
+        features.ssse3 = false;
+        check();
+        features = detected;
+    }
+}
+
+}
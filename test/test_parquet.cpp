@@ -0,0 +1,108 @@
+/**
+ * test_parquet.cpp
+ * part of pdinklag/word-packing
+ * 
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include <random>
+#include <vector>
+
+#include <word_packing.hpp>
+#include <word_packing/parquet.hpp>
+
+namespace word_packing::test::parquet {
+
+PackedIntVector<> random_runs(size_t const n, size_t const width, uint64_t const seed) {
+    std::mt19937_64 gen(seed);
+    std::uniform_int_distribution<size_t> run_dist(1, 20);
+    auto const mask = internal::low_mask(width);
+
+    PackedIntVector<> v(n, width);
+    for(size_t i = 0; i < n;) {
+        uintmax_t const x = gen() & mask;
+        size_t const r = run_dist(gen);
+        for(size_t j = 0; j < r && i < n; j++) v[i++] = x;
+    }
+    return v;
+}
+
+TEST_SUITE("parquet") {
+    TEST_CASE("specification example") {
+        // bit-packed values 0 to 7 with bit width 3, followed by eight repetitions of 4
+        uint8_t const encoded[] = { 0x03, 0x88, 0xC6, 0xFA, 0x10, 0x04 };
+
+        PackedIntVector<> v(16, 3);
+        CHECK(word_packing::parquet::decode_rle_hybrid(encoded, sizeof(encoded), 3, 16, v));
+        for(size_t i = 0; i < 8; i++) CHECK(v[i] == i);
+        for(size_t i = 8; i < 16; i++) CHECK(v[i] == 4);
+
+        std::vector<uint8_t> reencoded;
+        word_packing::parquet::encode_rle_hybrid(v, reencoded);
+        CHECK(reencoded == std::vector<uint8_t>(encoded, encoded + sizeof(encoded)));
+    }
+
+    TEST_CASE("roundtrip") {
+        for(size_t w = 1; w <= 64; w++) {
+            auto const v = random_runs(1'000, w, w);
+
+            std::vector<uint8_t> encoded;
+            word_packing::parquet::encode_rle_hybrid(v, encoded);
+
+            // decode at an offset that is not byte-aligned
+            PackedIntVector<> decoded(1'003, w);
+            CHECK(word_packing::parquet::decode_rle_hybrid(encoded.data(), encoded.size(), w, v.size(), decoded, 3));
+            for(size_t i = 0; i < v.size(); i++) CHECK(decoded[3 + i] == v[i]);
+
+            // decode into a wider vector
+            if(w < 64) {
+                PackedIntVector<> wide(v.size(), w + 1);
+                CHECK(word_packing::parquet::decode_rle_hybrid(encoded.data(), encoded.size(), w, v.size(), wide));
+                for(size_t i = 0; i < v.size(); i++) CHECK(wide[i] == v[i]);
+            }
+        }
+    }
+
+    TEST_CASE("encode with larger width") {
+        auto const v = random_runs(100, 5, 1);
+
+        std::vector<uint8_t> encoded;
+        word_packing::parquet::encode_rle_hybrid(v, 8, encoded);
+
+        PackedIntVector<> decoded(v.size(), 8);
+        CHECK(word_packing::parquet::decode_rle_hybrid(encoded.data(), encoded.size(), 8, v.size(), decoded));
+        for(size_t i = 0; i < v.size(); i++) CHECK(decoded[i] == v[i]);
+    }
+
+    TEST_CASE("truncated") {
+        uint8_t const encoded[] = { 0x03, 0x88, 0xC6, 0xFA, 0x10, 0x04 };
+        PackedIntVector<> v(16, 3);
+        CHECK(!word_packing::parquet::decode_rle_hybrid(encoded, 3, 3, 8, v));
+        CHECK(!word_packing::parquet::decode_rle_hybrid(encoded, 5, 3, 16, v));
+    }
+}
+
+}
@@ -0,0 +1,155 @@
+/**
+ * test_profiler.cpp
+ * part of pdinklag/word-packing
+ * 
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include <sstream>
+
+#include <word_packing.hpp>
+#include <word_packing/profiler.hpp>
+
+namespace word_packing::test::profiler {
+
+TEST_SUITE("profiler") {
+    TEST_CASE("sequential") {
+        PackedIntVector v(10'000, 21);
+        Profiled p(v, 1);
+        for(size_t i = 0; i < v.size(); i++) p[i] = i;
+        uintmax_t sum = 0;
+        for(size_t i = 0; i < v.size(); i++) sum += p[i];
+        CHECK(sum == 49'995'000);
+
+        auto const prof = p.profile();
+        CHECK(prof.accesses == 20'000);
+        CHECK(prof.samples == 20'000);
+        CHECK(prof.reads == 10'000);
+        CHECK(prof.writes == 10'000);
+        CHECK(prof.sequential == 19'999); // all but the jump back to the start
+        CHECK(prof.backward == 1);
+        CHECK(prof.stride_histogram[0] == 1);
+        CHECK(prof.stride_histogram[1] == 19'998);
+        CHECK(prof.stride_histogram[14] == 1); // 9'999
+        CHECK(prof.working_set_bytes() == 7 * AccessProfile::PAGE_BYTES); // 26'250 bytes
+
+        // two integers per word pack when padded
+        PackedFixedWidthIntVector<22, uint64_t, bit_order::Padded> pv(10'000);
+        Profiled pp(pv, 1);
+        for(size_t i = 0; i < pv.size(); i++) pp[i] = i;
+        CHECK(pp.profile().working_set_bytes() == 10 * AccessProfile::PAGE_BYTES); // 40'000 bytes
+
+        auto const r = p.recommend();
+        CHECK(r.fixed_width);
+        CHECK(!r.padded);
+        CHECK(!r.huge_pages);
+        CHECK(!r.block_compression); // half of the accesses are writes
+
+        p.reset();
+        for(size_t i = 0; i < v.size(); i++) sum += p.get(i);
+        CHECK(p.recommend().block_compression);
+    }
+
+    TEST_CASE("random") {
+        size_t const n = 100'000;
+        PackedIntVector v(n, 21);
+        Profiled p(v, 1);
+        for(size_t k = 0; k < n; k++) p[(k * 7'919) % n] = k;
+
+        auto const prof = p.profile();
+        CHECK(prof.writes == n);
+        CHECK(prof.sequential_ratio() < 0.01);
+        CHECK(prof.straddling_ratio() > 0.1);
+
+        auto const r = p.recommend();
+        CHECK(r.fixed_width);
+        CHECK(r.padded);
+        CHECK(!r.huge_pages);
+        CHECK(!r.block_compression);
+
+        // padding would waste 31 bits per word pack
+        PackedIntVector w(n, 33);
+        Profiled q(w, 1);
+        for(size_t k = 0; k < n; k++) q[(k * 7'919) % n] = k;
+        CHECK(q.profile().straddling_ratio() > 0.1);
+        CHECK(!q.recommend().padded);
+
+        // a padded layout does not straddle
+        PackedFixedWidthIntVector<21, uint64_t, bit_order::Padded> pv(n);
+        Profiled pp(pv, 1);
+        for(size_t k = 0; k < n; k++) pp[(k * 7'919) % n] = k;
+        CHECK(pp.profile().straddling == 0);
+        CHECK(!pp.recommend().padded);
+        CHECK(!pp.recommend().fixed_width);
+    }
+
+    TEST_CASE("huge_pages") {
+        size_t const n = 2ULL << 20; // 16 MiB
+        PackedIntVector v(n, 64);
+        Profiled p(v, 1);
+        for(size_t k = 0; k < 100'000; k++) p[(k * 1'000'003) % n] = k;
+        CHECK(p.profile().working_set_bytes() > (8ULL << 20));
+        CHECK(p.recommend().huge_pages);
+    }
+
+    TEST_CASE("sampling") {
+        PackedIntVector v(1'000, 9);
+        Profiled p(v, 8);
+        for(size_t i = 0; i < 800; i++) p[i] = i % 512;
+        auto const prof = p.profile();
+        CHECK(prof.accesses == 800);
+        CHECK(prof.samples == 100);
+        CHECK(prof.stride_histogram[1] == 100); // strides are measured to the preceding access, sampled or not
+        for(size_t i = 0; i < 800; i++) CHECK(v[i] == i % 512);
+    }
+
+    TEST_CASE("growth") {
+        PackedIntVector v(0, 64);
+        Profiled p(v, 1);
+        for(size_t i = 0; i < 4'096; i++) {
+            v.push_back(0);
+            p[i] = i;
+        }
+        CHECK(p.profile().working_set_bytes() == 8 * AccessProfile::PAGE_BYTES);
+    }
+
+    TEST_CASE("print") {
+        PackedIntVector v(100, 7);
+        Profiled p(v, 1);
+        for(size_t i = 0; i < 100; i++) p[i] = i;
+
+        std::ostringstream out;
+        p.profile().print(out, "column");
+        CHECK(out.str().starts_with("PROFILE name=column accesses=100 samples=100 reads=0 writes=100 "));
+        CHECK(out.str().find(" stride_1=99") != std::string::npos);
+
+        out.str("");
+        p.recommend().print(out, "column");
+        CHECK(out.str() == "RECOMMEND name=column fixed_width=1 padded=0 huge_pages=0 block_compression=0\n");
+    }
+}
+
+}
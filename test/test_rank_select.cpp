@@ -0,0 +1,97 @@
+/**
+ * test_rank_select.cpp
+ * part of pdinklag/word-packing
+ * 
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include <random>
+
+#include <word_packing.hpp>
+#include <word_packing/rank_select.hpp>
+
+namespace word_packing::test::rank_select {
+
+TEST_SUITE("rank_select") {
+    template<typename Pack>
+    void rank_select_test(size_t const num, double const density) {
+        PackedFixedWidthIntVector<1, Pack> bv(num);
+
+        std::mt19937_64 gen(num);
+        std::bernoulli_distribution dist(density);
+        for(size_t i = 0; i < num; i++) bv[i] = dist(gen);
+
+        RankSelect<Pack> rs(bv);
+        CHECK(rs.size() == num);
+
+        size_t ones = 0;
+        for(size_t i = 0; i < num; i++) {
+            CHECK(rs.rank1(i) == ones);
+            CHECK(rs.rank0(i) == i - ones);
+            if(bv[i]) {
+                CHECK(rs.select1(ones) == i);
+                ++ones;
+            } else {
+                CHECK(rs.select0(i - ones) == i);
+            }
+        }
+        CHECK(rs.rank1(num) == ones);
+        CHECK(rs.num_ones() == ones);
+        CHECK(rs.select1(ones) == num);
+        CHECK(rs.select0(num - ones) == num);
+    }
+
+    TEST_CASE("rank and select") {
+        for(double d : { 0.0, 0.01, 0.5, 0.99, 1.0 }) {
+            rank_select_test<uint8_t>(3'333, d);
+            rank_select_test<uint16_t>(3'333, d);
+            rank_select_test<uint32_t>(3'333, d);
+            rank_select_test<uint64_t>(3'333, d);
+            rank_select_test<uint64_t>(4'096, d);
+        }
+    }
+
+    TEST_CASE("kernels") {
+        // construct using each kernel variant that the CPU supports
+        auto const detected = internal::cpu::features();
+        for(bool const popcnt : { false, true }) {
+            internal::cpu::features().popcnt = popcnt && detected.popcnt;
+            rank_select_test<uint8_t>(1'111, 0.5);
+            rank_select_test<uint64_t>(1'111, 0.5);
+        }
+        internal::cpu::features() = detected;
+    }
+
+    TEST_CASE("empty") {
+        PackedFixedWidthIntVector<1> bv;
+        RankSelect<> rs(bv);
+        CHECK(rs.rank1(0) == 0);
+        CHECK(rs.select1(0) == 0);
+        CHECK(rs.select0(0) == 0);
+    }
+}
+
+}
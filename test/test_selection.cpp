@@ -0,0 +1,110 @@
+/**
+ * test_selection.cpp
+ * part of pdinklag/word-packing
+ * 
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include <random>
+#include <vector>
+
+#include <word_packing.hpp>
+#include <word_packing/selection.hpp>
+
+namespace word_packing::test::selection {
+
+template<typename Column, typename Mask = BitVector>
+void test_column(Column const& column) {
+    size_t const n = column.size();
+    std::mt19937_64 gen(100);
+
+    // selectivities from none over sparse and dense to all
+    for(size_t per_mille : { 0, 1, 50, 125, 500, 900, 1'000 }) {
+        Mask mask(n);
+        std::vector<uintmax_t> expected;
+        for(size_t i = 0; i < n; i++) {
+            bool const b = (gen() % 1'000) < per_mille;
+            mask[i] = b;
+            if(b) expected.push_back(column.get(i));
+        }
+
+        for(auto strategy : { SelectionStrategy::AUTO, SelectionStrategy::DENSE, SelectionStrategy::SPARSE }) {
+            std::vector<uintmax_t> out(expected.size());
+            size_t const num = decode_selected(column, mask, out.data(), strategy);
+            CHECK(num == expected.size());
+            CHECK(out == expected);
+        }
+    }
+}
+
+TEST_SUITE("selection") {
+    TEST_CASE("runtime_width") {
+        for(size_t n : { 0, 1, 63, 64, 65, 10'000 }) {
+            PackedIntVector column(n, 13);
+            for(size_t i = 0; i < n; i++) column[i] = (i * 7'919) & 0x1FFF;
+            test_column(column);
+        }
+    }
+
+    TEST_CASE("fixed_width") {
+        PackedFixedWidthIntVector<37> column(5'000);
+        for(size_t i = 0; i < column.size(); i++) column[i] = internal::hash64(i) & internal::low_mask(37);
+        test_column(column);
+    }
+
+    TEST_CASE("narrow_mask") {
+        // the mask's last word pack ends before the last 64-bit word
+        for(size_t n : { 65, 100, 1'000 }) {
+            PackedIntVector column(n, 13);
+            for(size_t i = 0; i < n; i++) column[i] = (i * 7'919) & 0x1FFF;
+            test_column<decltype(column), PackedFixedWidthIntVector<1, uint8_t>>(column);
+            test_column<decltype(column), PackedFixedWidthIntVector<1, uint16_t>>(column);
+        }
+    }
+
+    TEST_CASE("padded") {
+        PackedIntVector<uintmax_t, bit_order::Padded> column(5'000, 21);
+        for(size_t i = 0; i < column.size(); i++) column[i] = internal::hash64(i) & internal::low_mask(21);
+        test_column(column);
+    }
+
+    TEST_CASE("kernels") {
+        // forces the portable and BMI2 kernels unless the instruction set extensions are enabled at compile time
+        auto& features = internal::cpu::features();
+        auto const detected = features;
+
+        PackedIntVector column(1'000, 20);
+        for(size_t i = 0; i < column.size(); i++) column[i] = i * 1'000;
+
+        features.avx512bw = false;
+        test_column(column);
+        features.bmi2 = false;
+        test_column(column);
+        features = detected;
+    }
+}
+
+}
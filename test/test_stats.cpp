@@ -0,0 +1,131 @@
+/**
+ * test_stats.cpp
+ * part of pdinklag/word-packing
+ * 
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include <word_packing.hpp>
+
+namespace word_packing::test::stats {
+
+using word_packing::stats::Counting;
+
+size_t num_straddling(size_t const num, size_t const width, size_t const pack_bits) {
+    size_t k = 0;
+    for(size_t i = 0; i < num; i++) k += ((i * width) % pack_bits + width > pack_bits);
+    return k;
+}
+
+TEST_SUITE("stats") {
+    TEST_CASE("vectors") {
+        struct Tag;
+        using Stats = Counting<Tag>;
+        Stats::reset();
+
+        PackedIntVector<uint64_t, bit_order::LsbFirst, Stats> v(100, 21);
+        for(size_t i = 0; i < 100; i++) v[i] = i;
+        uintmax_t sum = 0;
+        for(size_t i = 0; i < 100; i++) sum += v[i];
+        CHECK(sum == 4950);
+        v.increment(3);
+
+        auto c = Stats::aggregate();
+        CHECK(c.sets == 100);
+        CHECK(c.gets == 100);
+        CHECK(c.adds == 1);
+        CHECK(c.straddling_sets == num_straddling(100, 21, 64));
+        CHECK(c.straddling_gets == num_straddling(100, 21, 64));
+        CHECK(c.straddling_adds == 1); // bits 63 to 83
+
+        size_t const indices[] = { 1, 2, 3, 3 };
+        v.increment_many(indices, 4);
+        c = Stats::aggregate();
+        CHECK(c.bulk_calls == 1);
+        CHECK(c.bulk_elements == 4);
+        CHECK(c.adds == 5);
+
+        PackedFixedWidthIntVector<21, uint64_t, bit_order::Padded, Stats> pv(100);
+        for(size_t i = 0; i < 100; i++) pv[i] = i;
+        c = Stats::aggregate();
+        CHECK(c.sets == 200);
+        CHECK(c.straddling_sets == num_straddling(100, 21, 64)); // padded writes never straddle
+
+        Stats::reset();
+        CHECK(Stats::aggregate().sets == 0);
+    }
+
+    TEST_CASE("accessors") {
+        struct Tag;
+        using Stats = Counting<Tag>;
+
+        std::vector<uint32_t> packs(num_packs_required<uint32_t>(64, 5));
+        auto acc = accessor<bit_order::LsbFirst, Stats>(packs.data(), 5);
+        auto fixed_acc = accessor<5, bit_order::LsbFirst, Stats>((uint32_t const*)packs.data());
+        for(size_t i = 0; i < 64; i++) acc[i] = i % 32;
+        for(size_t i = 0; i < 64; i++) CHECK(fixed_acc[i] == i % 32);
+
+        auto const c = Stats::aggregate();
+        CHECK(c.sets == 64);
+        CHECK(c.gets == 64);
+        CHECK(c.straddling_sets == num_straddling(64, 5, 32));
+        CHECK(c.straddling_gets == num_straddling(64, 5, 32));
+    }
+
+    TEST_CASE("threads") {
+        struct Tag;
+        using Stats = Counting<Tag>;
+
+        PackedIntVector<uint64_t, bit_order::LsbFirst, Stats> v(1'000, 7);
+        std::vector<std::thread> threads;
+        for(size_t t = 0; t < 4; t++) {
+            threads.emplace_back([&](){
+                uintmax_t sum = 0;
+                for(size_t i = 0; i < v.size(); i++) sum += v.get(i);
+                (void)sum;
+            });
+        }
+        for(auto& thread : threads) thread.join();
+
+        // the counters of exited threads are retained
+        CHECK(Stats::aggregate().gets == 4'000);
+
+        std::ostringstream out;
+        Stats::dump(out, "column");
+        CHECK(out.str().starts_with("STATS name=column gets=4000 "));
+    }
+
+    TEST_CASE("none") {
+        static_assert(!word_packing::stats::None::enabled);
+        static_assert(std::is_same_v<PackedIntVector<>::StatsType, word_packing::stats::None>);
+    }
+}
+
+}
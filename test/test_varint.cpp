@@ -0,0 +1,157 @@
+/**
+ * test_varint.cpp
+ * part of pdinklag/word-packing
+ * 
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include <random>
+#include <vector>
+
+#include <word_packing.hpp>
+#include <word_packing/varint.hpp>
+
+namespace word_packing::test::varint {
+
+// generates integers of random bit widths up to the given width
+PackedIntVector<> random_values(size_t const n, size_t const width, uint64_t const seed) {
+    std::mt19937_64 gen(seed);
+    std::uniform_int_distribution<size_t> width_dist(1, width);
+
+    PackedIntVector<> v(n, width);
+    for(size_t i = 0; i < n; i++) v[i] = gen() & internal::low_mask(width_dist(gen));
+    return v;
+}
+
+TEST_SUITE("varint") {
+    TEST_CASE("leb128") {
+        uint8_t const encoded[] = { 0x00, 0x7F, 0x80, 0x01, 0xE5, 0x8E, 0x26 };
+        uintmax_t const expected[] = { 0, 127, 128, 624485 };
+
+        PackedIntVector<> v(4, 20);
+        CHECK(word_packing::varint::decode_leb128(encoded, sizeof(encoded), 4, v));
+        for(size_t i = 0; i < 4; i++) CHECK(v[i] == expected[i]);
+
+        std::vector<uint8_t> reencoded;
+        word_packing::varint::encode_leb128(v, reencoded);
+        CHECK(reencoded == std::vector<uint8_t>(encoded, encoded + sizeof(encoded)));
+
+        CHECK(!word_packing::varint::decode_leb128(encoded, sizeof(encoded) - 1, 4, v)); // truncated
+
+        PackedIntVector<> narrow(4, 8);
+        CHECK(!word_packing::varint::decode_leb128(encoded, sizeof(encoded), 4, narrow)); // exceeds width
+    }
+
+    TEST_CASE("leb128 roundtrip") {
+        for(size_t w : { 1, 7, 8, 13, 32, 56, 57, 63, 64 }) {
+            auto const v = random_values(10'000, w, w);
+
+            std::vector<uint8_t> encoded;
+            word_packing::varint::encode_leb128(v, encoded);
+
+            PackedIntVector<> decoded(v.size() + 1, w);
+            CHECK(word_packing::varint::decode_leb128(encoded.data(), encoded.size(), v.size(), decoded, 1));
+            for(size_t i = 0; i < v.size(); i++) CHECK(decoded[1 + i] == v[i]);
+        }
+    }
+
+    TEST_CASE("leb128 kernels") {
+        // decode using each kernel variant that the CPU supports
+        auto const detected = internal::cpu::features();
+        for(size_t level = 0; level < 3; level++) {
+            internal::cpu::features().bmi2 = (level >= 1) && detected.bmi2;
+            internal::cpu::features().avx512bw = (level >= 2) && detected.avx512bw;
+            for(size_t w : { 1, 7, 13, 64 }) {
+                auto const v = random_values(1'000, w, w + level);
+
+                std::vector<uint8_t> encoded;
+                word_packing::varint::encode_leb128(v, encoded);
+
+                PackedIntVector<> decoded(v.size(), w);
+                CHECK(word_packing::varint::decode_leb128(encoded.data(), encoded.size(), v.size(), decoded));
+                CHECK(decoded == v);
+
+                if(w > 1) {
+                    PackedIntVector<> narrow(v.size(), w - 1);
+                    CHECK(!word_packing::varint::decode_leb128(encoded.data(), encoded.size(), v.size(), narrow)); // exceeds width
+                }
+            }
+        }
+        internal::cpu::features() = detected;
+    }
+
+    TEST_CASE("group varint") {
+        uint8_t const encoded[] = { 0b00'10'00'01, 0x00, 0x01, 0xFF, 0x01, 0x02, 0x03, 0x2A, 0b00'00'00'01, 0x01, 0x01 };
+        uintmax_t const expected[] = { 256, 255, 0x030201, 42, 257 };
+
+        PackedIntVector<> v(5, 24);
+        CHECK(word_packing::varint::decode_group_varint(encoded, sizeof(encoded), 5, v));
+        for(size_t i = 0; i < 5; i++) CHECK(v[i] == expected[i]);
+
+        std::vector<uint8_t> reencoded;
+        word_packing::varint::encode_group_varint(v, reencoded);
+        CHECK(reencoded == std::vector<uint8_t>(encoded, encoded + sizeof(encoded)));
+
+        CHECK(!word_packing::varint::decode_group_varint(encoded, 5, 5, v)); // truncated
+    }
+
+    TEST_CASE("group varint roundtrip") {
+        for(size_t w : { 1, 8, 9, 17, 24, 31, 32 }) {
+            auto const v = random_values(10'001, w, w);
+
+            std::vector<uint8_t> encoded;
+            word_packing::varint::encode_group_varint(v, encoded);
+
+            PackedIntVector<> decoded(v.size() + 3, w);
+            CHECK(word_packing::varint::decode_group_varint(encoded.data(), encoded.size(), v.size(), decoded, 3));
+            for(size_t i = 0; i < v.size(); i++) CHECK(decoded[3 + i] == v[i]);
+        }
+    }
+
+    TEST_CASE("group varint kernels") {
+        // decode using each kernel variant that the CPU supports
+        auto const detected = internal::cpu::features();
+        for(bool const ssse3 : { false, true }) {
+            internal::cpu::features().ssse3 = ssse3 && detected.ssse3;
+            for(size_t w : { 7, 20, 32 }) {
+                auto const v = random_values(1'001, w, w + ssse3);
+
+                std::vector<uint8_t> encoded;
+                word_packing::varint::encode_group_varint(v, encoded);
+
+                PackedIntVector<> decoded(v.size(), w);
+                CHECK(word_packing::varint::decode_group_varint(encoded.data(), encoded.size(), v.size(), decoded));
+                CHECK(decoded == v);
+
+                PackedIntVector<> narrow(v.size(), w - 1);
+                CHECK(!word_packing::varint::decode_group_varint(encoded.data(), encoded.size(), v.size(), narrow)); // exceeds width
+            }
+        }
+        internal::cpu::features() = detected;
+    }
+}
+
+}
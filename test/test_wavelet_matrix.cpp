@@ -0,0 +1,125 @@
+/**
+ * test_wavelet_matrix.cpp
+ * part of pdinklag/word-packing
+ * 
+ * MIT License
+ * 
+ * Copyright (c) Patrick Dinklage
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include <algorithm>
+#include <map>
+#include <random>
+
+#include <word_packing.hpp>
+#include <word_packing/wavelet_matrix.hpp>
+
+namespace word_packing::test::wavelet_matrix {
+
+TEST_SUITE("wavelet_matrix") {
+    PackedIntVector<> random_sequence(size_t const num, size_t const width, uintmax_t const max) {
+        std::mt19937_64 gen(num * width);
+        std::uniform_int_distribution<uintmax_t> dist(0, max);
+
+        PackedIntVector<> seq(num, width);
+        for(size_t i = 0; i < num; i++) seq[i] = dist(gen);
+        return seq;
+    }
+
+    TEST_CASE("access, rank and select") {
+        auto test = [](size_t const width, uintmax_t const max){
+            size_t const num = 2'345;
+            auto const seq = random_sequence(num, width, max);
+            WaveletMatrix wm(seq);
+
+            CHECK(wm.size() == num);
+            CHECK(wm.width() == width);
+
+            std::map<uintmax_t, size_t> counts;
+            for(size_t i = 0; i < num; i++) {
+                uintmax_t const c = seq[i];
+                CHECK(wm[i] == c);
+                CHECK(wm.rank(c, i) == counts[c]);
+                CHECK(wm.select(c, counts[c]) == i);
+                ++counts[c];
+            }
+            for(auto const& [c, count] : counts) {
+                CHECK(wm.rank(c, num) == count);
+                CHECK(wm.select(c, count) == num);
+            }
+        };
+
+        test(1, 1);
+        test(5, 31);
+        test(13, 100);
+        test(64, 1'000);
+        test(64, UINTMAX_MAX);
+    }
+
+    TEST_CASE("quantile and top_k") {
+        size_t const num = 1'000;
+        auto const seq = random_sequence(num, 7, 50);
+        WaveletMatrix wm(seq);
+
+        std::mt19937_64 gen(0);
+        std::uniform_int_distribution<size_t> dist(0, num - 1);
+        for(size_t q = 0; q < 100; q++) {
+            size_t b = dist(gen), e = dist(gen);
+            if(b > e) std::swap(b, e);
+            ++e;
+
+            std::vector<uintmax_t> sorted;
+            for(size_t i = b; i < e; i++) sorted.push_back(seq[i]);
+            std::sort(sorted.begin(), sorted.end());
+            for(size_t k = 0; k < e - b; k++) {
+                CHECK(wm.quantile(b, e, k) == sorted[k]);
+            }
+
+            std::map<uintmax_t, size_t> counts;
+            for(auto x : sorted) ++counts[x];
+            std::vector<size_t> freqs;
+            for(auto const& [c, count] : counts) freqs.push_back(count);
+            std::sort(freqs.begin(), freqs.end(), std::greater<size_t>());
+
+            size_t const k = 5;
+            auto const top = wm.top_k(b, e, k);
+            CHECK(top.size() == std::min(k, counts.size()));
+            for(size_t j = 0; j < top.size(); j++) {
+                CHECK(top[j].second == freqs[j]);
+                CHECK(counts[top[j].first] == top[j].second);
+            }
+        }
+    }
+
+    TEST_CASE("parallel construction") {
+        for(size_t width : { 3, 11, 64 }) {
+            size_t const num = 10'007;
+            auto const seq = random_sequence(num, width, internal::low_mask(width));
+            WaveletMatrix wm(seq, 4);
+            for(size_t i = 0; i < num; i++) CHECK(wm[i] == seq[i]);
+        }
+    }
+}
+
+}